@@ -9,11 +9,14 @@ macro(zstd_build)
         third_party/zstd/lib/compress/zstd_compress.c
         third_party/zstd/lib/compress/huf_compress.c
         third_party/zstd/lib/compress/fse_compress.c
+        third_party/zstd/lib/dictBuilder/divsufsort.c
+        third_party/zstd/lib/dictBuilder/zdict.c
 )
     set(ZSTD_LIBRARIES zstd)
     set(ZSTD_INCLUDE_DIRS
             ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib
-            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common)
+            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/common
+            ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd/lib/dictBuilder)
     include_directories(${ZSTD_INCLUDE_DIRS})
     find_package_message(ZSTD "Using bundled ZSTD"
         "${ZSTD_LIBRARIES}:${ZSTD_INCLUDE_DIRS}")
@@ -34,6 +34,30 @@ if (CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_CLANG )
     CC_HAS_AVX_INTRINSICS)
 endif()
 
+#
+# Check compiler for AVX2 intrinsics in functions compiled with
+# __attribute__((target("avx2"))). Such functions are used only
+# if the CPU supports AVX2 at runtime, see mp_scan.c.
+#
+if (CMAKE_COMPILER_IS_GNUCC OR CMAKE_COMPILER_IS_CLANG )
+    set(CMAKE_REQUIRED_FLAGS "")
+    check_c_source_compiles("
+    #include <immintrin.h>
+
+    __attribute__((target(\"avx2\")))
+    static int f(void)
+    {
+    __m256i a = _mm256_setzero_si256();
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, a));
+    }
+
+    int main()
+    {
+    return f();
+    }"
+    HAVE_AVX2_TARGET_ATTRIBUTE)
+endif()
+
 if ((CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64") AND CC_HAS_SSE2_INTRINSICS)
     # any amd64 supports sse2 instructions
     set(ENABLE_SSE2_DEFAULT ON)
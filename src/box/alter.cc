@@ -853,6 +853,25 @@ ModifySpace::prepare(struct alter_space *alter)
 			  space_name(alter->old_space),
 			  "can not switch temporary flag on a non-empty space");
 	}
+	if (def.opts.compress_threshold > 0 &&
+	    !engine_can_compress_tuples(engine->flags)) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  space_name(alter->old_space),
+			  "space does not support tuple compression");
+	}
+	/*
+	 * Compressed tuples keep their format and thus the
+	 * old threshold, see AddIndex::prepare().
+	 */
+	if (def.opts.compress_threshold !=
+	    alter->old_space->def.opts.compress_threshold &&
+	    space_index(alter->old_space, 0) != NULL &&
+	    space_size(alter->old_space) > 0) {
+		tnt_raise(ClientError, ER_ALTER_SPACE,
+			  space_name(alter->old_space),
+			  "can not change compress_threshold "
+			  "on a non-empty space");
+	}
 }
 
 /** Amend the definition of the new space. */
@@ -1025,6 +1044,25 @@ key_def_change_require_index_rebuid(struct key_def *old_key_def,
 void
 AddIndex::prepare(struct alter_space *alter)
 {
+	/*
+	 * Only the fields covered by the old format are
+	 * stored uncompressed in compressed tuples, and
+	 * indexes can't look into the compressed ones.
+	 */
+	struct space *old_space = alter->old_space;
+	if (old_space->def.opts.compress_threshold > 0 &&
+	    space_index(old_space, 0) != NULL &&
+	    space_size(old_space) > 0) {
+		for (uint32_t i = 0; i < new_key_def->part_count; i++) {
+			if (new_key_def->parts[i].fieldno >=
+			    old_space->format->field_count) {
+				tnt_raise(ClientError, ER_ALTER_SPACE,
+					  space_name(old_space),
+					  "can not index a new field of "
+					  "a non-empty compressed space");
+			}
+		}
+	}
 	AlterSpaceOp *prev_op = rlist_prev_entry_safe(this, &alter->ops,
 						      link);
 	DropIndex *drop = dynamic_cast<DropIndex *>(prev_op);
@@ -189,6 +189,26 @@ applier_connect(struct applier *applier)
 	applier_set_state(applier, APPLIER_CONNECTED);
 }
 
+/**
+ * Apply a chunk of snapshot txs sent by the master as they
+ * are stored in its snapshot file.
+ */
+static void
+applier_apply_xlog_tx(struct applier *applier, struct xrow_header *row,
+		      ZSTD_DStream *zdctx)
+{
+	if (row->bodycnt == 0)
+		tnt_raise(ClientError, ER_INVALID_MSGPACK, "xlog tx chunk");
+	const char *data = (const char *) row->body[0].iov_base;
+	const char *end = data + row->body[0].iov_len;
+	const char *d = data;
+	if (mp_check(&d, end) != 0 || mp_typeof(*data) != MP_BIN)
+		tnt_raise(ClientError, ER_INVALID_MSGPACK, "xlog tx chunk");
+	uint32_t len = mp_decode_binl(&data);
+	xlog_tx_chunk_write_xc(data, data + len, zdctx,
+			       applier->initial_join_stream);
+}
+
 /**
  * Execute and process JOIN request (bootstrap the server).
  */
@@ -199,7 +219,7 @@ applier_join(struct applier *applier)
 	struct ev_io *coio = &applier->io;
 	struct iobuf *iobuf = applier->iobuf;
 	struct xrow_header row;
-	xrow_encode_join(&row, &SERVER_UUID);
+	xrow_encode_join(&row, &SERVER_UUID, true);
 	coio_write_xrow(coio, &row);
 
 	/**
@@ -223,11 +243,24 @@ applier_join(struct applier *applier)
 	 * Receive initial data.
 	 */
 	assert(applier->initial_join_stream != NULL);
+	ZSTD_DStream *zdctx = NULL;
+	auto zdctx_guard = make_scoped_guard([&]{
+		if (zdctx != NULL)
+			ZSTD_freeDStream(zdctx);
+	});
 	while (true) {
 		coio_read_xrow(coio, &iobuf->in, &row);
 		applier->last_row_time = ev_now(loop());
 		if (iproto_type_is_dml(row.type)) {
 			xstream_write(applier->initial_join_stream, &row);
+		} else if (row.type == IPROTO_XLOG_TX) {
+			if (zdctx == NULL)
+				zdctx = ZSTD_createDStream();
+			if (zdctx == NULL) {
+				tnt_raise(ClientError, ER_DECOMPRESSION,
+					  "failed to create context");
+			}
+			applier_apply_xlog_tx(applier, &row, zdctx);
 		} else if (row.type == IPROTO_OK) {
 			break; /* end of stream */
 		} else if (iproto_type_is_error(row.type)) {
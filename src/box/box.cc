@@ -119,6 +119,45 @@ box_check_slab_alloc_minimal(ssize_t slab_alloc_minimal)
 		  "specified value is out of bounds");
 }
 
+static enum memtx_snapshot_mode
+box_check_snapshot_mode(const char *name)
+{
+	if (name == NULL)
+		return MEMTX_SNAPSHOT_THREAD;
+	int mode = strindex(memtx_snapshot_mode_STRS, name,
+			    MEMTX_SNAPSHOT_MODE_MAX);
+	if (mode == MEMTX_SNAPSHOT_MODE_MAX) {
+		tnt_raise(ClientError, ER_CFG, "snapshot_mode",
+			  "expected 'thread' or 'fork'");
+	}
+	return (enum memtx_snapshot_mode) mode;
+}
+
+static enum memtx_huge_pages
+box_check_slab_alloc_huge_pages(const char *name)
+{
+	if (name == NULL)
+		return MEMTX_HUGE_PAGES_NONE;
+	int huge_pages = strindex(memtx_huge_pages_STRS, name,
+				  MEMTX_HUGE_PAGES_MAX);
+	if (huge_pages == MEMTX_HUGE_PAGES_MAX) {
+		tnt_raise(ClientError, ER_CFG, "slab_alloc_huge_pages",
+			  "expected 'none', 'transparent' or 'explicit'");
+	}
+	return (enum memtx_huge_pages) huge_pages;
+}
+
+static uint64_t
+box_check_slab_alloc_numa_nodes(const char *nodes)
+{
+	uint64_t mask = 0;
+	if (nodes != NULL && memtx_numa_nodes_parse(nodes, &mask) != 0) {
+		tnt_raise(ClientError, ER_CFG, "slab_alloc_numa_nodes",
+			  "expected a comma-separated list of node ids");
+	}
+	return mask;
+}
+
 static void
 process_rw(struct request *request, struct space *space, struct tuple **result)
 {
@@ -344,6 +383,25 @@ box_check_rows_per_wal(int64_t rows_per_wal)
 	return rows_per_wal;
 }
 
+static int
+box_check_snapshot_delta_count(int count)
+{
+	if (count < 0) {
+		tnt_raise(ClientError, ER_CFG, "snapshot_delta_count",
+			  "the value must not be negative");
+	}
+	return count;
+}
+
+static void
+box_check_vinyl_read_ahead(int read_ahead)
+{
+	if (read_ahead < 0) {
+		tnt_raise(ClientError, ER_CFG, "vinyl.read_ahead",
+			  "the value must not be negative");
+	}
+}
+
 void
 box_check_config()
 {
@@ -354,6 +412,11 @@ box_check_config()
 	box_check_rows_per_wal(cfg_geti64("rows_per_wal"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
 	box_check_slab_alloc_minimal(cfg_geti64("slab_alloc_minimal"));
+	box_check_slab_alloc_huge_pages(cfg_gets("slab_alloc_huge_pages"));
+	box_check_slab_alloc_numa_nodes(cfg_gets("slab_alloc_numa_nodes"));
+	box_check_snapshot_mode(cfg_gets("snapshot_mode"));
+	box_check_snapshot_delta_count(cfg_geti("snapshot_delta_count"));
+	box_check_vinyl_read_ahead(cfg_geti("vinyl.read_ahead"));
 }
 
 /*
@@ -470,6 +533,26 @@ box_set_snap_io_rate_limit(void)
 		memtx->setSnapIoRateLimit(cfg_getd("snap_io_rate_limit"));
 }
 
+void
+box_set_snapshot_mode(void)
+{
+	enum memtx_snapshot_mode mode =
+		box_check_snapshot_mode(cfg_gets("snapshot_mode"));
+	MemtxEngine *memtx = (MemtxEngine *) engine_find("memtx");
+	if (memtx)
+		memtx->setSnapshotMode(mode);
+}
+
+void
+box_set_snapshot_delta_count(void)
+{
+	int count = box_check_snapshot_delta_count(
+		cfg_geti("snapshot_delta_count"));
+	MemtxEngine *memtx = (MemtxEngine *) engine_find("memtx");
+	if (memtx)
+		memtx->setSnapshotDeltaCount(count);
+}
+
 void
 box_set_too_long_threshold(void)
 {
@@ -624,6 +707,50 @@ box_process1(struct request *request, box_tuple_t **result)
 	}
 }
 
+int
+box_process_batch(struct request *request, uint32_t *count)
+{
+	assert(iproto_type_is_batch(request->type));
+	uint32_t type = request->type == IPROTO_INSERT_BATCH ?
+			IPROTO_INSERT : IPROTO_REPLACE;
+	rmean_collect(rmean_box, request->type, 1);
+	if (in_txn()) {
+		diag_set(ClientError, ER_ACTIVE_TRANSACTION);
+		return -1;
+	}
+	try {
+		struct space *space = space_cache_find(request->space_id);
+		if (!space->def.opts.temporary)
+			box_check_writable();
+		const char *data = request->tuple;
+		uint32_t n = mp_decode_array(&data);
+		/*
+		 * Every tuple is executed as a separate INSERT or
+		 * REPLACE statement, so it gets its own redo row,
+		 * but all rows go to WAL in a single write.
+		 */
+		txn_begin(false);
+		for (uint32_t i = 0; i < n; i++) {
+			if (mp_typeof(*data) != MP_ARRAY)
+				tnt_raise(ClientError, ER_TUPLE_NOT_ARRAY);
+			struct request *stmt = region_alloc_object_xc(
+				&fiber()->gc, struct request);
+			request_create(stmt, type);
+			stmt->space_id = request->space_id;
+			stmt->tuple = data;
+			mp_next(&data);
+			stmt->tuple_end = data;
+			process_rw(stmt, space, NULL);
+		}
+		txn_commit(in_txn());
+		*count = n;
+		return 0;
+	} catch (Exception *e) {
+		txn_rollback();
+		return -1;
+	}
+}
+
 int
 box_select(struct port *port, uint32_t space_id, uint32_t index_id,
 	   int iterator, uint32_t offset, uint32_t limit,
@@ -1079,7 +1206,8 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 
 	/* Decode JOIN request */
 	struct tt_uuid server_uuid = uuid_nil;
-	xrow_decode_join(header, &server_uuid);
+	bool xlog_tx_chunks;
+	xrow_decode_join(header, &server_uuid, &xlog_tx_chunks);
 
 	/* Check that bootstrap has been finished */
 	if (!box_init_done)
@@ -1102,6 +1230,17 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 			  "wal_mode = 'none'");
 	}
 
+	/*
+	 * A replica is bootstrapped from a full snapshot: make
+	 * one if the last snapshot is incremental.
+	 */
+	MemtxEngine *memtx = (MemtxEngine *) engine_find("memtx");
+	if (memtx->lastCheckpointIsDelta()) {
+		memtx->forceFullCheckpoint();
+		if (box_snapshot() != 0)
+			diag_raise();
+	}
+
 	/* Remember start vclock. */
 	struct vclock start_vclock;
 	recovery_last_checkpoint(&start_vclock);
@@ -1115,7 +1254,7 @@ box_process_join(struct ev_io *io, struct xrow_header *header)
 	/*
 	 * Initial stream: feed replica with dirty data from engines.
 	 */
-	relay_initial_join(io->fd, header->sync);
+	relay_initial_join(io->fd, header->sync, xlog_tx_chunks);
 	say_info("initial data sent.");
 
 	/**
@@ -1281,6 +1420,8 @@ engine_init()
 	MemtxEngine *memtx = new MemtxEngine(cfg_gets("snap_dir"),
 					     cfg_geti("panic_on_snap_error"),
 					     cfg_geti("panic_on_wal_error"));
+	/* Log the changes replayed from WAL at recovery. */
+	memtx->setSnapshotDeltaCount(cfg_geti("snapshot_delta_count"));
 	engine_register(memtx);
 
 	SysviewEngine *sysview = new SysviewEngine();
@@ -1405,10 +1546,17 @@ bootstrap(struct vclock *start_vclock)
 static inline void
 box_init(void)
 {
+	enum memtx_huge_pages huge_pages =
+		box_check_slab_alloc_huge_pages(
+			cfg_gets("slab_alloc_huge_pages"));
+	uint64_t numa_nodes =
+		box_check_slab_alloc_numa_nodes(
+			cfg_gets("slab_alloc_numa_nodes"));
 	tuple_init(cfg_getd("slab_alloc_arena"),
 		   cfg_geti("slab_alloc_minimal"),
 		   cfg_geti("slab_alloc_maximal"),
-		   cfg_getd("slab_alloc_factor"));
+		   cfg_getd("slab_alloc_factor"),
+		   huge_pages, numa_nodes);
 
 	rmean_box = rmean_new(iproto_type_strs, IPROTO_TYPE_STAT_MAX);
 	rmean_error = rmean_new(rmean_error_strings, RMEAN_ERROR_LAST);
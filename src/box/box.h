@@ -113,6 +113,8 @@ void box_set_replication_source(void);
 void box_set_log_level(void);
 void box_set_io_collect_interval(void);
 void box_set_snap_io_rate_limit(void);
+void box_set_snapshot_mode(void);
+void box_set_snapshot_delta_count(void);
 void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_panic_on_wal_error(void);
@@ -293,6 +295,16 @@ box_truncate(uint32_t space_id);
 int
 box_process1(struct request *request, box_tuple_t **result);
 
+/**
+ * Execute IPROTO_INSERT_BATCH or IPROTO_REPLACE_BATCH: insert
+ * or replace every tuple of request->tuple in one transaction.
+ * @param[out] count the number of processed tuples
+ * @retval 0 on success
+ * @retval -1 on error, nothing is applied, see diag
+ */
+int
+box_process_batch(struct request *request, uint32_t *count);
+
 int
 boxk(int type, uint32_t space_id, const char *format, ...);
 
@@ -39,6 +39,7 @@ struct relay;
 
 enum engine_flags {
 	ENGINE_CAN_BE_TEMPORARY = 1,
+	ENGINE_CAN_COMPRESS_TUPLES = 2,
 };
 
 extern struct rlist engines;
@@ -245,6 +246,12 @@ engine_can_be_temporary(uint32_t flags)
 	return flags & ENGINE_CAN_BE_TEMPORARY;
 }
 
+static inline bool
+engine_can_compress_tuples(uint32_t flags)
+{
+	return flags & ENGINE_CAN_COMPRESS_TUPLES;
+}
+
 static inline uint32_t
 engine_id(Handler *space)
 {
@@ -179,7 +179,8 @@ struct errcode_record {
 	/*124 */_(ER_DECOMPRESSION,		"Decompression error: %s") \
 	/*125 */_(ER_INVALID_XLOG_TYPE,		"Invalid xlog type: expected %s, got %s") \
 	/*126 */_(ER_INVALID_RUN_ID,		"Invalid run id: expected %lld, got %lld") \
-	/*127 */_(ER_ALREADY_RUNNING,		"Failed to lock WAL directory %s and hot_standby mode is off")
+	/*127 */_(ER_ALREADY_RUNNING,		"Failed to lock WAL directory %s and hot_standby mode is off") \
+	/*128 */_(ER_READ_VIEW_SPACE_CHANGED,	"Space '%s' was altered or dropped after the read view was opened")
 
 /*
  * !IMPORTANT! Please follow instructions at start of the file
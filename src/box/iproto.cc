@@ -302,6 +302,8 @@ tx_process1(struct cmsg *msg);
 static void
 tx_process_select(struct cmsg *msg);
 static void
+tx_process_batch(struct cmsg *msg);
+static void
 net_send_msg(struct cmsg *msg);
 
 static void
@@ -366,6 +368,11 @@ static const struct cmsg_hop process1_route[] = {
 	{ net_send_msg, NULL },
 };
 
+static const struct cmsg_hop batch_route[] = {
+	{ tx_process_batch, &net_pipe },
+	{ net_send_msg, NULL },
+};
+
 static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
 	NULL,                                   /* IPROTO_OK */
 	select_route,                           /* IPROTO_SELECT */
@@ -377,7 +384,9 @@ static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
 	misc_route,                             /* IPROTO_AUTH */
 	misc_route,                             /* IPROTO_EVAL */
 	process1_route,                         /* IPROTO_UPSERT */
-	misc_route                              /* IPROTO_CALL */
+	misc_route,                             /* IPROTO_CALL */
+	batch_route,                            /* IPROTO_INSERT_BATCH */
+	batch_route                             /* IPROTO_REPLACE_BATCH */
 };
 
 static const struct cmsg_hop sync_route[] = {
@@ -565,6 +574,8 @@ iproto_decode_msg(struct iproto_msg *msg, const char **pos, const char *reqend,
 	case IPROTO_AUTH:
 	case IPROTO_EVAL:
 	case IPROTO_UPSERT:
+	case IPROTO_INSERT_BATCH:
+	case IPROTO_REPLACE_BATCH:
 		/*
 		 * This is a common request which can be parsed with
 		 * request_decode(). Parse it before putting it into
@@ -924,6 +935,41 @@ error:
 	msg->write_end = obuf_create_svp(out);
 }
 
+/**
+ * A batch is answered with the number of processed tuples
+ * rather than the tuples themselves: {DATA: [count]}.
+ */
+static void
+tx_process_batch(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct obuf *out = &msg->iobuf->out;
+
+	tx_fiber_init(msg->connection->session, msg->header.sync);
+	if (tx_check_schema(msg->header.schema_id))
+		goto error;
+
+	uint32_t count;
+	struct obuf_svp svp;
+	char buf[9];
+	char *end;
+	if (box_process_batch(&msg->request, &count) ||
+	    iproto_prepare_select(out, &svp))
+		goto error;
+	end = mp_encode_uint(buf, count);
+	if (obuf_dup(out, buf, end - buf) != (size_t) (end - buf)) {
+		diag_set(OutOfMemory, end - buf, "obuf", "batch reply");
+		goto error;
+	}
+	iproto_reply_select(out, &svp, msg->header.sync, 1);
+	msg->write_end = obuf_create_svp(out);
+	return;
+error:
+	iproto_reply_error(out, diag_last_error(&fiber()->diag),
+			   msg->header.sync);
+	msg->write_end = obuf_create_svp(out);
+}
+
 static void
 tx_process_misc(struct cmsg *m)
 {
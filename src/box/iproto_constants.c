@@ -86,6 +86,7 @@ const unsigned char iproto_key_type[IPROTO_KEY_MAX] =
 	/* 0x26 */	MP_MAP, /* IPROTO_VCLOCK */
 	/* 0x27 */	MP_STR, /* IPROTO_EXPR */
 	/* 0x28 */	MP_ARRAY, /* IPROTO_OPS */
+	/* 0x29 */	MP_BOOL, /* IPROTO_XLOG_TX_CHUNKS */
 	/* }}} */
 };
 
@@ -101,11 +102,13 @@ const char *iproto_type_strs[] =
 	"AUTH",
 	"EVAL",
 	"UPSERT",
-	"CALL"
+	"CALL",
+	"INSERT_BATCH",
+	"REPLACE_BATCH",
 };
 
 #define bit(c) (1ULL<<IPROTO_##c)
-const uint64_t iproto_body_key_map[IPROTO_CALL + 1] = {
+const uint64_t iproto_body_key_map[IPROTO_TYPE_STAT_MAX] = {
 	0,                                                     /* unused */
 	bit(SPACE_ID) | bit(LIMIT) | bit(KEY),                 /* SELECT */
 	bit(SPACE_ID) | bit(TUPLE),                            /* INSERT */
@@ -117,6 +120,8 @@ const uint64_t iproto_body_key_map[IPROTO_CALL + 1] = {
 	bit(EXPR)     | bit(TUPLE),                            /* EVAL */
 	bit(SPACE_ID) | bit(OPS) | bit(TUPLE),                 /* UPSERT */
 	bit(FUNCTION_NAME) | bit(TUPLE),                       /* CALL */
+	bit(SPACE_ID) | bit(TUPLE),                            /* INSERT_BATCH */
+	bit(SPACE_ID) | bit(TUPLE),                            /* REPLACE_BATCH */
 };
 #undef bit
 
@@ -162,5 +167,6 @@ const char *iproto_key_strs[IPROTO_KEY_MAX] = {
 	"vector clock",     /* 0x26 */
 	"expression",       /* 0x27 */
 	"operations",       /* 0x28 */
+	"xlog tx chunks",   /* 0x29 */
 };
 
@@ -75,6 +75,7 @@ enum iproto_key {
 	IPROTO_VCLOCK = 0x26,
 	IPROTO_EXPR = 0x27, /* EVAL */
 	IPROTO_OPS = 0x28, /* UPSERT but not UPDATE ops, because of legacy */
+	IPROTO_XLOG_TX_CHUNKS = 0x29, /* JOIN: accept IPROTO_XLOG_TX */
 	/* Leave a gap between request keys and response keys */
 	IPROTO_DATA = 0x30,
 	IPROTO_ERROR = 0x31,
@@ -131,12 +132,20 @@ enum iproto_type {
 	IPROTO_EVAL = 8,
 	IPROTO_UPSERT = 9,
 	IPROTO_CALL = 10,
-	IPROTO_TYPE_STAT_MAX = IPROTO_CALL + 1,
+	/* batched dml: many tuples of one space in one transaction */
+	IPROTO_INSERT_BATCH = 11,
+	IPROTO_REPLACE_BATCH = 12,
+	IPROTO_TYPE_STAT_MAX = IPROTO_REPLACE_BATCH + 1,
 	/* admin command codes */
 	IPROTO_PING = 64,
 	IPROTO_JOIN = 65,
 	IPROTO_SUBSCRIBE = 66,
 	IPROTO_TYPE_ADMIN_MAX = IPROTO_SUBSCRIBE + 1,
+	/*
+	 * Initial JOIN data: a chunk of xlog transactions sent
+	 * as they are stored in the snapshot file.
+	 */
+	IPROTO_XLOG_TX = 67,
 	/* command failed = (IPROTO_TYPE_ERROR | ER_XXX from errcode.h) */
 	IPROTO_TYPE_ERROR = 1 << 15
 };
@@ -192,6 +201,16 @@ iproto_type_is_dml(uint32_t type)
 		type == IPROTO_UPSERT;
 }
 
+/**
+ * A batch of inserts or replaces: IPROTO_TUPLE is an array
+ * of tuples, all executed in one transaction.
+ */
+static inline bool
+iproto_type_is_batch(uint32_t type)
+{
+	return type == IPROTO_INSERT_BATCH || type == IPROTO_REPLACE_BATCH;
+}
+
 /** This is an error. */
 static inline bool
 iproto_type_is_error(uint32_t type)
@@ -454,10 +454,13 @@ key_validate_parts(struct key_def *key_def, const char *key,
 
 const struct space_opts space_opts_default = {
 	/* .temporary = */ false,
+	/* .compress_threshold = */ 0,
 };
 
 const struct opt_def space_opts_reg[] = {
 	OPT_DEF("temporary", MP_BOOL, struct space_opts, temporary),
+	OPT_DEF("compress_threshold", MP_UINT, struct space_opts,
+		compress_threshold),
 	{ NULL, MP_NIL, 0, 0 }
 };
 
@@ -490,6 +493,13 @@ space_def_check(struct space_def *def, uint32_t namelen, uint32_t engine_namelen
 				  def->name,
 			         "space does not support temporary flag");
 	}
+	if (def->opts.compress_threshold > 0) {
+		Engine *engine = engine_find(def->engine_name);
+		if (! engine_can_compress_tuples(engine->flags))
+			tnt_raise(ClientError, ER_ALTER_SPACE,
+				  def->name,
+				  "space does not support tuple compression");
+	}
 }
 
 bool
@@ -325,6 +325,11 @@ struct space_opts {
 	 * - changes are not part of a snapshot
 	 */
 	bool temporary;
+	/**
+	 * Tuples of this size or larger are stored
+	 * compressed, 0 means never.
+	 */
+	uint32_t compress_threshold;
 };
 
 extern const struct space_opts space_opts_default;
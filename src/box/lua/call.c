@@ -372,15 +372,54 @@ execute_lua_eval(lua_State *L)
 	return 0;
 }
 
+/** A Lua coroutine to execute CALL and EVAL requests in. */
+struct lua_call_coro {
+	struct lua_State *L;
+	/** Reference anchoring the coroutine in the registry. */
+	int ref;
+};
+
+enum { LUA_CALL_CORO_CACHE_SIZE = 64 };
+
+/**
+ * Coroutines left from finished requests. Creating a new
+ * coroutine for every request costs about as much as
+ * executing a simple stored procedure.
+ */
+static struct lua_call_coro lua_call_coro_cache[LUA_CALL_CORO_CACHE_SIZE];
+static int lua_call_coro_cache_size;
+
+static inline struct lua_call_coro
+lua_call_coro_get(void)
+{
+	if (lua_call_coro_cache_size > 0)
+		return lua_call_coro_cache[--lua_call_coro_cache_size];
+	struct lua_call_coro coro;
+	coro.L = lua_newthread(tarantool_L);
+	coro.ref = luaL_ref(tarantool_L, LUA_REGISTRYINDEX);
+	return coro;
+}
+
+static inline void
+lua_call_coro_put(struct lua_call_coro coro)
+{
+	if (lua_call_coro_cache_size == LUA_CALL_CORO_CACHE_SIZE) {
+		luaL_unref(tarantool_L, LUA_REGISTRYINDEX, coro.ref);
+		return;
+	}
+	/* lua_cpcall() leaves the coroutine reusable, even on error. */
+	lua_settop(coro.L, 0);
+	lua_call_coro_cache[lua_call_coro_cache_size++] = coro;
+}
+
 static inline int
 box_process_lua(struct request *request, struct obuf *out, lua_CFunction handler)
 {
 	struct lua_function_ctx ctx = { request, out, {0, 0, 0}, false };
 
-	lua_State *L = lua_newthread(tarantool_L);
-	int coro_ref = luaL_ref(tarantool_L, LUA_REGISTRYINDEX);
-	int rc = lbox_cpcall(L, handler, &ctx);
-	luaL_unref(tarantool_L, LUA_REGISTRYINDEX, coro_ref);
+	struct lua_call_coro coro = lua_call_coro_get();
+	int rc = lbox_cpcall(coro.L, handler, &ctx);
+	lua_call_coro_put(coro);
 	if (rc != 0) {
 		if (ctx.out_is_dirty) {
 			/*
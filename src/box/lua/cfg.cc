@@ -142,6 +142,28 @@ lbox_cfg_set_snap_io_rate_limit(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_snapshot_mode(struct lua_State *L)
+{
+	try {
+		box_set_snapshot_mode();
+	} catch (Exception *) {
+		lbox_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_snapshot_delta_count(struct lua_State *L)
+{
+	try {
+		box_set_snapshot_delta_count();
+	} catch (Exception *) {
+		lbox_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_read_only(struct lua_State *L)
 {
@@ -166,6 +188,8 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_io_collect_interval", lbox_cfg_set_io_collect_interval},
 		{"cfg_set_too_long_threshold", lbox_cfg_set_too_long_threshold},
 		{"cfg_set_snap_io_rate_limit", lbox_cfg_set_snap_io_rate_limit},
+		{"cfg_set_snapshot_mode", lbox_cfg_set_snapshot_mode},
+		{"cfg_set_snapshot_delta_count", lbox_cfg_set_snapshot_delta_count},
 		{"cfg_set_read_only", lbox_cfg_set_read_only},
 		{NULL, NULL}
 	};
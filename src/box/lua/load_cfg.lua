@@ -11,6 +11,7 @@ local default_vinyl_cfg = {
     compact_wm        = 2, -- try to maintain less than 2 runs in a range
     range_size        = 1024 * 1024 * 1024,
     page_size        = 8 * 1024,
+    read_ahead        = 4, -- pages to prefetch on sequential scans
 }
 
 -- all available options
@@ -20,6 +21,8 @@ local default_cfg = {
     slab_alloc_minimal  = 16,
     slab_alloc_maximal  = 1024 * 1024,
     slab_alloc_factor   = 1.1,
+    slab_alloc_huge_pages = nil, -- 'transparent' or 'explicit'
+    slab_alloc_numa_nodes = nil, -- e.g. '0,1'
     work_dir            = nil,
     snap_dir            = ".",
     wal_dir             = ".",
@@ -31,6 +34,8 @@ local default_cfg = {
     io_collect_interval = nil,
     readahead           = 16320,
     snap_io_rate_limit  = nil, -- no limit
+    snapshot_mode       = nil, -- 'thread' or 'fork'
+    snapshot_delta_count = nil, -- full snapshots only
     too_long_threshold  = 0.5,
     wal_mode            = "write",
     rows_per_wal        = 500000,
@@ -38,6 +43,7 @@ local default_cfg = {
     panic_on_snap_error = true,
     panic_on_wal_error  = true,
     replication_source  = nil,
+    replication_join_rate_limit = nil, -- no limit
     custom_proc_title   = nil,
     pid_file            = nil,
     background          = false,
@@ -62,6 +68,7 @@ local vinyl_template_cfg = {
     run_age_wm        = 'number',
     range_size        = 'number',
     page_size        = 'number',
+    read_ahead        = 'number',
 }
 
 -- types of available options
@@ -72,6 +79,8 @@ local template_cfg = {
     slab_alloc_minimal  = 'number',
     slab_alloc_maximal  = 'number',
     slab_alloc_factor   = 'number',
+    slab_alloc_huge_pages = 'string',
+    slab_alloc_numa_nodes = 'string',
     work_dir            = 'string',
     snap_dir            = 'string',
     wal_dir             = 'string',
@@ -83,6 +92,8 @@ local template_cfg = {
     io_collect_interval = 'number',
     readahead           = 'number',
     snap_io_rate_limit  = 'number',
+    snapshot_mode       = 'string',
+    snapshot_delta_count = 'number',
     too_long_threshold  = 'number',
     wal_mode            = 'string',
     rows_per_wal        = 'number',
@@ -90,6 +101,7 @@ local template_cfg = {
     panic_on_snap_error = 'boolean',
     panic_on_wal_error  = 'boolean',
     replication_source  = 'string, number, table',
+    replication_join_rate_limit = 'number',
     custom_proc_title   = 'string',
     pid_file            = 'string',
     background          = 'boolean',
@@ -123,6 +135,8 @@ local dynamic_cfg = {
     readahead               = private.cfg_set_readahead,
     too_long_threshold      = private.cfg_set_too_long_threshold,
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
+    snapshot_mode           = private.cfg_set_snapshot_mode,
+    snapshot_delta_count    = private.cfg_set_snapshot_delta_count,
     panic_on_wal_error      = function() end,
     read_only               = private.cfg_set_read_only,
     -- snapshot_daemon
@@ -130,6 +144,8 @@ local dynamic_cfg = {
     snapshot_count          = box.internal.snapshot_daemon.set_snapshot_count,
     -- do nothing, affects new replicas, which query this value on start
     wal_dir_rescan_delay    = function() end,
+    -- do nothing, affects replicas which join after the change
+    replication_join_rate_limit = function() end,
     custom_proc_title       = function()
         require('title').update(box.cfg.custom_proc_title)
     end
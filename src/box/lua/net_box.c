@@ -37,9 +37,11 @@
 
 #include "box/iproto_constants.h"
 #include "box/lua/tuple.h" /* luamp_convert_tuple() / luamp_convert_key() */
+#include "box/tuple.h" /* box_tuple_new() */
 #include "box/xrow.h"
 
 #include "lua/msgpack.h"
+#include "lua/utils.h" /* lbox_error() */
 #include "third_party/base64.h"
 
 #include "coio.h"
@@ -306,6 +308,18 @@ netbox_encode_replace(lua_State *L)
 	return netbox_encode_insert_or_replace(L, IPROTO_REPLACE);
 }
 
+static int
+netbox_encode_insert_batch(lua_State *L)
+{
+	return netbox_encode_insert_or_replace(L, IPROTO_INSERT_BATCH);
+}
+
+static int
+netbox_encode_replace_batch(lua_State *L)
+{
+	return netbox_encode_insert_or_replace(L, IPROTO_REPLACE_BATCH);
+}
+
 static int
 netbox_encode_delete(lua_State *L)
 {
@@ -450,6 +464,60 @@ netbox_decode_greeting(lua_State *L)
 	return 1;
 }
 
+/**
+ * decode_body_tuples(rpos) -> rpos, body
+ *
+ * Decode the body of a response which carries tuples in
+ * IPROTO_DATA, e.g. a response to SELECT or REPLACE. Unlike
+ * msgpack.ibuf_decode(), tuples are created straight from
+ * the msgpack in the receive buffer, without building an
+ * intermediate Lua table per tuple only to encode it back.
+ * Other body keys are decoded as usual. Like ibuf_decode(),
+ * advances rpos past the decoded body.
+ */
+static int
+netbox_decode_body_tuples(lua_State *L)
+{
+	lua_settop(L, 1);
+	const char **data = (const char **) lua_topointer(L, 1);
+	const char *pos = *data;
+	if (mp_typeof(*pos) != MP_MAP)
+		return luaL_error(L, "Invalid response body");
+	box_tuple_format_t *format = box_tuple_format_default();
+	uint32_t map_size = mp_decode_map(&pos);
+	lua_createtable(L, 0, map_size);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*pos) != MP_UINT)
+			return luaL_error(L, "Invalid response body");
+		uint64_t key = mp_decode_uint(&pos);
+		if (key != IPROTO_DATA || mp_typeof(*pos) != MP_ARRAY) {
+			luamp_decode(L, cfg, &pos);
+			lua_rawseti(L, -2, key);
+			continue;
+		}
+		uint32_t count = mp_decode_array(&pos);
+		lua_createtable(L, count, 0);
+		for (uint32_t j = 0; j < count; j++) {
+			if (mp_typeof(*pos) != MP_ARRAY) {
+				luamp_decode(L, cfg, &pos);
+				lua_rawseti(L, -2, j + 1);
+				continue;
+			}
+			const char *end = pos;
+			mp_next(&end);
+			struct tuple *tuple = box_tuple_new(format, pos, end);
+			if (tuple == NULL)
+				return lbox_error(L);
+			lbox_pushtuple(L, tuple);
+			lua_rawseti(L, -2, j + 1);
+			pos = end;
+		}
+		lua_rawseti(L, -2, key);
+	}
+	*data = pos;
+	return 2;
+}
+
 /**
  * communicate(fd, send_buf, recv_buf, limit_or_boundary, timeout)
  *  -> errno, error
@@ -568,11 +636,14 @@ luaopen_net_box(struct lua_State *L)
 		{ "encode_select",  netbox_encode_select },
 		{ "encode_insert",  netbox_encode_insert },
 		{ "encode_replace", netbox_encode_replace },
+		{ "encode_insert_batch", netbox_encode_insert_batch },
+		{ "encode_replace_batch", netbox_encode_replace_batch },
 		{ "encode_delete",  netbox_encode_delete },
 		{ "encode_update",  netbox_encode_update },
 		{ "encode_upsert",  netbox_encode_upsert },
 		{ "encode_auth",    netbox_encode_auth },
 		{ "decode_greeting",netbox_decode_greeting },
+		{ "decode_body_tuples", netbox_decode_body_tuples },
 		{ "communicate",    netbox_communicate },
 		{ NULL, NULL}
 	};
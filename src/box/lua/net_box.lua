@@ -22,6 +22,7 @@ local communicate     = internal.communicate
 local encode_auth     = internal.encode_auth
 local encode_select   = internal.encode_select
 local decode_greeting = internal.decode_greeting
+local decode_body_tuples = internal.decode_body_tuples
 
 local sequence_mt      = { __serialize = 'sequence' }
 local TIMEOUT_INFINITY = 500 * 365 * 86400
@@ -45,6 +46,11 @@ local E_PROC_LUA             = box.error.PROC_LUA
 
 -- utility tables
 local is_final_state         = {closed = 1, error = 1}
+-- responses to these requests carry tuples in IPROTO_DATA
+local is_tuple_method        = {
+    call_16 = 1, insert = 1, replace = 1, delete = 1,
+    update = 1, upsert = 1, select = 1
+}
 local method_codec           = {
     ping    = internal.encode_ping,
     call_16 = internal.encode_call_16,
@@ -52,6 +58,8 @@ local method_codec           = {
     eval    = internal.encode_eval,
     insert  = internal.encode_insert,
     replace = internal.encode_replace,
+    insert_batch  = internal.encode_insert_batch,
+    replace_batch = internal.encode_replace_batch,
     delete  = internal.encode_delete,
     update  = internal.encode_update,
     upsert  = internal.encode_upsert,
@@ -85,7 +93,8 @@ local function next_id(id) return band(id + 1, 0x7FFFFFFF) end
 
 -- function create_transport(host, port, user, password, callback)
 --
--- Transport methods: connect(), close(), perfrom_request(), wait_state()
+-- Transport methods: connect(), close(), perfrom_request(), wait_state(),
+-- perform_async_request(), is_request_ready(), wait_request()
 --
 -- Basically, *transport* is a TCP connection speaking one of
 -- Tarantool network protocols. This is a low-level interface.
@@ -232,11 +241,7 @@ local function create_transport(host, port, user, password, callback)
     end
 
     -- REQUEST/RESPONSE --
-    local function perform_request(timeout, method, schema_id, ...)
-        if state ~= 'active' then
-            return last_errno or E_NO_CONNECTION, last_error
-        end
-        local deadline = fiber_time() + (timeout or TIMEOUT_INFINITY)
+    local function send_request(method, schema_id, ...)
         -- alert worker to notify it of the queued outgoing data;
         -- if the buffer wasn't empty, assume the worker was already alerted
         if send_buf:size() == 0 then
@@ -245,28 +250,64 @@ local function create_transport(host, port, user, password, callback)
         local id = next_request_id
         method_codec[method](send_buf, id, schema_id, ...)
         next_request_id = next_id(id)
-        local request = table_new(0, 5) -- reserve space for 5 keys
-        request.client = fiber_self()
+        local request = table_new(0, 6) -- reserve space for 6 keys
+        request.id = id
         request.method = method
         request.schema_id = schema_id
         requests[id] = request
-        repeat
-            local timeout = max(0, deadline - fiber_time())
-            if not state_cond:wait(timeout) then
-                requests[id] = nil
-                return E_TIMEOUT, 'Timeout exceeded'
+        return request
+    end
+
+    local function is_request_ready(request)
+        return requests[request.id] ~= request
+    end
+
+    -- Wait until the request is completed; false on timeout.
+    -- The request stays in flight if the wait times out.
+    local function wait_request(request, timeout)
+        local deadline = fiber_time() + (timeout or TIMEOUT_INFINITY)
+        request.client = fiber_self()
+        -- i.e. not completed yet (beware spurious wakeups)
+        while not is_request_ready(request) do
+            if not state_cond:wait(max(0, deadline - fiber_time())) then
+                break
             end
-        until requests[id] == nil -- i.e. completed (beware spurious wakeups)
+        end
+        request.client = nil
+        return is_request_ready(request)
+    end
+
+    local function perform_request(timeout, method, schema_id, ...)
+        if state ~= 'active' then
+            return last_errno or E_NO_CONNECTION, last_error
+        end
+        local request = send_request(method, schema_id, ...)
+        if not wait_request(request, timeout) then
+            requests[request.id] = nil
+            return E_TIMEOUT, 'Timeout exceeded'
+        end
         return request.errno, request.response
     end
 
+    -- Same as perform_request(), but doesn't wait for the response.
+    -- Returns the request in flight, which the caller polls with
+    -- is_request_ready() and waits for with wait_request().
+    -- If the caller drops the request, it is garbage collected and
+    -- the response is discarded on arrival.
+    local function perform_async_request(method, schema_id, ...)
+        if state ~= 'active' then
+            return last_errno or E_NO_CONNECTION, last_error
+        end
+        return nil, send_request(method, schema_id, ...)
+    end
+
     local function dispatch_response(id, errno, response)
         local request = requests[id]
         if request then -- someone is waiting for the response
             requests[id] = nil
             request.errno, request.response = errno, response
             local client = request.client
-            if client:status() ~= 'dead' then client:wakeup() end
+            if client and client:status() ~= 'dead' then client:wakeup() end
         end
     end
 
@@ -307,7 +348,17 @@ local function create_transport(host, port, user, password, callback)
                 rpos, hdr = ibuf_decode(rpos)
                 local body = {}
                 if rpos - recv_buf.rpos < required then
-                    rpos, body = ibuf_decode(rpos)
+                    -- decode tuples straight from recv_buf unless
+                    -- box.tuple isn't available yet (box.cfg{} wasn't
+                    -- called)
+                    local request = requests[hdr[IPROTO_SYNC_KEY]]
+                    if hdr[IPROTO_STATUS_KEY] == 0 and request ~= nil and
+                       is_tuple_method[request.method] and
+                       rawget(box, 'tuple') then
+                        rpos, body = decode_body_tuples(rpos)
+                    else
+                        rpos, body = ibuf_decode(rpos)
+                    end
                 end
                 recv_buf.rpos = rpos
                 return nil, hdr, body
@@ -484,7 +535,10 @@ local function create_transport(host, port, user, password, callback)
         close           = close,
         connect         = connect,
         wait_state      = wait_state,
-        perform_request = perform_request
+        perform_request = perform_request,
+        perform_async_request = perform_async_request,
+        is_request_ready = is_request_ready,
+        wait_request    = wait_request
     }
 end
 
@@ -637,6 +691,12 @@ function remote_methods:wait_connected(timeout)
     return self._transport.wait_state('active', timeout)
 end
 
+-- Tuples are already created by the transport, see
+-- decode_body_tuples().
+local function decode_result(res)
+    return setmetatable(res, sequence_mt)
+end
+
 function remote_methods:_request(method, ...)
     local this_fiber = fiber_self()
     local transport = self._transport
@@ -654,15 +714,7 @@ function remote_methods:_request(method, ...)
         err, res = perform_request(timeout, method,
                                    self._schema_id, ...)
         if not err then
-            setmetatable(res, sequence_mt)
-            local postproc = method ~= 'eval' and method ~= 'call_17'
-            if postproc and rawget(box, 'tuple') then
-                local tnew = box.tuple.new
-                for i, v in pairs(res) do
-                    res[i] = tnew(v)
-                end
-            end
-            return res
+            return decode_result(res)
         elseif err == E_WRONG_SCHEMA_VERSION then
             err = nil
         end
@@ -670,6 +722,100 @@ function remote_methods:_request(method, ...)
     box.error({code = err, reason = res})
 end
 
+-- FUTURES --
+--
+-- A future is returned instead of the result by requests issued
+-- with {is_async = true}. The request is queued for sending and
+-- the calling fiber proceeds without waiting for the response,
+-- so a single fiber can pipeline many requests over one connection.
+--
+-- future:is_ready() - true if the response (or an error) has
+--                     arrived and wait_result() will not block
+--                     on the network.
+-- future:wait_result(timeout) - wait for the response and return
+--                     whatever the synchronous request would have
+--                     returned, or raise its error.
+--
+-- A request failed due to a schema version mismatch is resent
+-- with the new schema id by wait_result(), as _request() does.
+local future_methods = {}
+local future_mt = { __index = future_methods, __metatable = false }
+
+-- Wait for the connection to become active, as _request() does,
+-- and queue the request for sending.
+local function future_send(future, timeout)
+    local remote = future.remote
+    local args = future.args
+    if remote.state ~= 'active' then
+        remote._transport.wait_state('active', timeout)
+    end
+    local err, res = remote._transport.perform_async_request(
+        future.method, remote._schema_id, unpack(args, 1, args.n))
+    if err then
+        future.errno, future.response = err, res
+    else
+        future.errno, future.response = nil, nil
+        future.request = res
+    end
+end
+
+function future_methods:is_ready()
+    local request = self.request
+    return request == nil or
+           self.remote._transport.is_request_ready(request)
+end
+
+function future_methods:wait_result(timeout)
+    local transport = self.remote._transport
+    -- The deadline set by remote:timeout() applies unless
+    -- an explicit timeout is given.
+    local deadline = self.deadline
+    if timeout ~= nil or deadline == nil then
+        deadline = fiber_time() + (timeout or TIMEOUT_INFINITY)
+    end
+    while self.result == nil do
+        local request = self.request
+        if request ~= nil then
+            if not transport.wait_request(request,
+                                          max(0, deadline - fiber_time())) then
+                box.error({code = E_TIMEOUT, reason = 'Timeout exceeded'})
+            end
+            self.request = nil
+            self.errno, self.response = request.errno, request.response
+        end
+        local err, res = self.errno, self.response
+        if not err then
+            self.result = decode_result(res)
+        elseif err == E_WRONG_SCHEMA_VERSION then
+            future_send(self, max(0, deadline - fiber_time()))
+            if self.errno == E_WRONG_SCHEMA_VERSION then
+                -- still fetching schema when the deadline expired
+                box.error({code = E_TIMEOUT, reason = 'Timeout exceeded'})
+            end
+        else
+            box.error({code = err, reason = res})
+        end
+    end
+    local postproc = self.postproc
+    if postproc ~= nil then
+        return postproc(self.result)
+    end
+    return self.result
+end
+
+-- Issue a request without waiting for the response, see FUTURES.
+-- The optional postproc function is applied to the decoded result
+-- in wait_result(), to match the synchronous method's return value.
+function remote_methods:_request_async(postproc, method, ...)
+    local deadline = self._deadlines[fiber_self()]
+    local future = setmetatable({
+        remote = self, method = method, postproc = postproc,
+        args = {n = select('#', ...), ...}, deadline = deadline
+    }, future_mt)
+    future_send(future, deadline and max(0, deadline - fiber_time()))
+    return future
+end
+
 function remote_methods:ping()
     remote_check(self, 'ping')
     local deadline = self._deadlines[fiber_self()]
@@ -699,6 +845,21 @@ function remote_methods:eval(code, ...)
     return unpack(self:_request('eval', code, {...}))
 end
 
+-- call() and eval() take a variable argument list and have no
+-- room for options, hence dedicated methods returning a future.
+function remote_methods:call_async(func_name, ...)
+    remote_check(self, 'call_async')
+    if self.opts.call_16 then
+        return self:_request_async(nil, 'call_16', tostring(func_name), {...})
+    end
+    return self:_request_async(unpack, 'call_17', tostring(func_name), {...})
+end
+
+function remote_methods:eval_async(code, ...)
+    remote_check(self, 'eval_async')
+    return self:_request_async(unpack, 'eval', code, {...})
+end
+
 function remote_methods:wait_state(state, timeout)
     remote_check(self, 'wait_state')
     if timeout == nil then
@@ -837,45 +998,82 @@ local function one_tuple(tab)
     if tab[1] ~= nil then return tab[1] end
 end
 
+local function one_unique_tuple(tab)
+    if tab[2] ~= nil then box.error(box.error.MORE_THAN_ONE_TUPLE) end
+    if tab[1] ~= nil then return tab[1] end
+end
+
+-- Perform a request on behalf of a space or index method:
+-- return a future if {is_async = true} is given in opts,
+-- otherwise wait for the response and apply postproc to it.
+local function space_request(remote, opts, postproc, method, ...)
+    if opts ~= nil and opts.is_async then
+        return remote:_request_async(postproc, method, ...)
+    end
+    local res = remote:_request(method, ...)
+    if postproc ~= nil then
+        return postproc(res)
+    end
+    return res
+end
+
 space_metatable = function(remote)
     local methods = {}
 
-    function methods:insert(tuple)
+    function methods:insert(tuple, opts)
         space_check(self, 'insert')
-        return one_tuple(remote:_request('insert', self.id, tuple))
+        return space_request(remote, opts, one_tuple, 'insert',
+                             self.id, tuple)
     end
 
-    function methods:replace(tuple)
+    function methods:replace(tuple, opts)
         space_check(self, 'replace')
-        return one_tuple(remote:_request('replace', self.id, tuple))
+        return space_request(remote, opts, one_tuple, 'replace',
+                             self.id, tuple)
+    end
+
+    -- Insert or replace all tuples in one transaction on the
+    -- server side, return the number of processed tuples.
+    function methods:insert_batch(tuples, opts)
+        space_check(self, 'insert_batch')
+        return space_request(remote, opts, one_tuple, 'insert_batch',
+                             self.id, tuples)
+    end
+
+    function methods:replace_batch(tuples, opts)
+        space_check(self, 'replace_batch')
+        return space_request(remote, opts, one_tuple, 'replace_batch',
+                             self.id, tuples)
     end
 
     function methods:select(key, opts)
         space_check(self, 'select')
-        return remote:_request('select', self.id, 0, key, opts)
+        return space_request(remote, opts, nil, 'select',
+                             self.id, 0, key, opts)
     end
 
-    function methods:delete(key)
+    function methods:delete(key, opts)
         space_check(self, 'delete')
-        return one_tuple(remote:_request('delete', self.id, 0, key))
+        return space_request(remote, opts, one_tuple, 'delete',
+                             self.id, 0, key)
     end
 
-    function methods:update(key, oplist)
+    function methods:update(key, oplist, opts)
         space_check(self, 'update')
-        return one_tuple(remote:_request('update', self.id, 0, key, oplist))
+        return space_request(remote, opts, one_tuple, 'update',
+                             self.id, 0, key, oplist)
     end
 
-    function methods:upsert(key, oplist)
+    function methods:upsert(key, oplist, opts)
         space_check(self, 'upsert')
-        return one_tuple(remote:_request('upsert', self.id, 0, key, oplist))
+        return space_request(remote, opts, one_tuple, 'upsert',
+                             self.id, 0, key, oplist)
     end
 
-    function methods:get(key)
+    function methods:get(key, opts)
         space_check(self, 'get')
-        local res = remote:_request('select', self.id, 0, key,
-                                    { limit = 2, iterator = 'EQ' })
-        if res[2] ~= nil then box.error(box.error.MORE_THAN_ONE_TUPLE) end
-        if res[1] ~= nil then return res[1] end
+        return space_request(remote, opts, one_unique_tuple, 'select',
+                             self.id, 0, key, { limit = 2, iterator = 'EQ' })
     end
 
     return { __index = methods, __metatable = false }
@@ -888,61 +1086,64 @@ local function index_check(index, method)
     end
 end
 
+local function count_result(tab)
+    return tab[1][1]
+end
+
 index_metatable = function(remote)
     local methods = {}
 
     function methods:select(key, opts)
         index_check(self, 'select')
-        return remote:_request('select', self.space.id, self.id, key, opts)
+        return space_request(remote, opts, nil, 'select',
+                             self.space.id, self.id, key, opts)
     end
 
-    function methods:get(key)
+    function methods:get(key, opts)
         index_check(self, 'get')
-        local res = remote:_request('select', self.space.id, self.id, key,
-                                    { limit = 2, iterator = 'EQ' })
-        if res[2] ~= nil then box.error(box.error.MORE_THAN_ONE_TUPLE) end
-        if res[1] ~= nil then return res[1] end
+        return space_request(remote, opts, one_unique_tuple, 'select',
+                             self.space.id, self.id, key,
+                             { limit = 2, iterator = 'EQ' })
     end
 
-    function methods:min(key)
+    function methods:min(key, opts)
         index_check(self, 'min')
-        local res = remote:_request('select', self.space.id, self.id, key,
-                                    { limit = 1, iterator = 'GE' })
-        return one_tuple(res)
+        return space_request(remote, opts, one_tuple, 'select',
+                             self.space.id, self.id, key,
+                             { limit = 1, iterator = 'GE' })
     end
 
-    function methods:max(key)
+    function methods:max(key, opts)
         index_check(self, 'max')
-        local res = remote:_request('select', self.space.id, self.id, key,
-                                    { limit = 1, iterator = 'LE' })
-        return one_tuple(res)
+        return space_request(remote, opts, one_tuple, 'select',
+                             self.space.id, self.id, key,
+                             { limit = 1, iterator = 'LE' })
     end
 
-    function methods:count(key)
+    function methods:count(key, opts)
         index_check(self, 'count')
         local code = string.format('box.space.%s.index.%s:count',
                                    self.space.name, self.name)
-        return remote:_request('call_16', code, { key })[1][1]
+        return space_request(remote, opts, count_result, 'call_16',
+                             code, { key })
     end
 
-    function methods:delete(key)
+    function methods:delete(key, opts)
         index_check(self, 'delete')
-        local res = remote:_request('delete', self.space.id, self.id, key)
-        return one_tuple(res)
+        return space_request(remote, opts, one_tuple, 'delete',
+                             self.space.id, self.id, key)
     end
 
-    function methods:update(key, oplist)
+    function methods:update(key, oplist, opts)
         index_check(self, 'update')
-        local res = remote:_request('update', self.space.id, self.id,
-                                    key, oplist)
-        return one_tuple(res)
+        return space_request(remote, opts, one_tuple, 'update',
+                             self.space.id, self.id, key, oplist)
     end
 
-    function methods:upsert(key, oplist)
+    function methods:upsert(key, oplist, opts)
         index_check(self, 'upsert')
-        local res = remote:_request('upsert', self.space.id, self.id,
-                                    key, oplist)
-        return one_tuple(res)
+        return space_request(remote, opts, one_tuple, 'upsert',
+                             self.space.id, self.id, key, oplist)
     end
 
     return { __index = methods, __metatable = false }
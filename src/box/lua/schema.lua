@@ -82,6 +82,15 @@ ffi.cdef[[
                const char *key, const char *key_end);
     void password_prepare(const char *password, int len,
                           char *out, int out_len);
+
+    struct memtx_read_view;
+    struct memtx_read_view *
+    memtx_read_view_new(const uint32_t *space_ids, uint32_t space_count);
+    int
+    memtx_read_view_next(struct memtx_read_view *view, uint32_t space_id,
+                         const char **data, const char **data_end);
+    void
+    memtx_read_view_delete(struct memtx_read_view *view);
 ]]
 
 local function user_or_role_resolve(user)
@@ -240,6 +249,7 @@ box.schema.space.create = function(name, options)
         user = 'string, number',
         format = 'table',
         temporary = 'boolean',
+        compress_threshold = 'number',
     }
     local options_defaults = {
         engine = 'memtx',
@@ -281,6 +291,7 @@ box.schema.space.create = function(name, options)
     -- filter out global parameters from the options array
     local space_options = setmetatable({
         temporary = options.temporary and true or nil,
+        compress_threshold = options.compress_threshold,
     }, { __serialize = 'map' })
     _space:insert{id, uid, name, options.engine, options.field_count,
         space_options, format}
@@ -1487,6 +1498,101 @@ box.once = function(key, func, ...)
     return func(...)
 end
 
+--
+-- read_view
+--
+-- A consistent snapshot of memtx spaces. Writers are not
+-- blocked while the view is open, but tuple memory deleted
+-- after the view was opened is not reused until it is closed,
+-- so a read view must not be kept open for longer than needed.
+--
+local read_view_mt = {}
+read_view_mt.__index = read_view_mt
+
+-- a static buffer for the data range of a frozen tuple
+local ptuple_data = ffi.new('const char *[2]')
+
+local function read_view_check(view, method)
+    if type(view) ~= 'table' or getmetatable(view) ~= read_view_mt then
+        error(string.format('usage: read_view:%s(...)', method))
+    end
+    if view.cdata == nil then
+        box.error(box.error.ILLEGAL_PARAMS, "read view is closed")
+    end
+end
+
+local read_view_gen = function(param, state)
+    local view = param.view
+    if view.cdata == nil then
+        box.error(box.error.ILLEGAL_PARAMS, "read view is closed")
+    end
+    if builtin.memtx_read_view_next(view.cdata, param.space_id,
+                                    ptuple_data, ptuple_data + 1) ~= 0 then
+        return box.error() -- error
+    end
+    if ptuple_data[0] == nil then
+        return nil
+    end
+    -- Frozen tuples must not be referenced, return a copy.
+    local tuple = builtin.box_tuple_new(builtin.box_tuple_format_default(),
+                                        ptuple_data[0], ptuple_data[1])
+    if tuple == nil then
+        return box.error()
+    end
+    return state + 1, tuple_bless(tuple)
+end
+
+function read_view_mt.pairs(view, space)
+    read_view_check(view, 'pairs')
+    local space_id = type(space) == 'table' and space.id or space
+    if type(space_id) == 'string' then
+        if box.space[space_id] == nil then
+            box.error(box.error.NO_SUCH_SPACE, space_id)
+        end
+        space_id = box.space[space_id].id
+    end
+    -- The frozen iterator can't be rewound: each space of a view
+    -- can be scanned once.
+    if view.scanned[space_id] then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "space has already been scanned in this read view")
+    end
+    view.scanned[space_id] = true
+    return fun.wrap(read_view_gen, { view = view, space_id = space_id }, 0)
+end
+
+function read_view_mt.close(view)
+    read_view_check(view, 'close')
+    local cdata = view.cdata
+    view.cdata = nil
+    builtin.memtx_read_view_delete(ffi.gc(cdata, nil))
+end
+
+box.read_view = function(spaces)
+    if type(spaces) ~= 'table' then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "Usage: box.read_view({space, ...})")
+    end
+    local space_ids = ffi.new('uint32_t[?]', #spaces)
+    for i, space in ipairs(spaces) do
+        if type(space) ~= 'table' then
+            if box.space[space] == nil then
+                box.error(box.error.NO_SUCH_SPACE, tostring(space))
+            end
+            space = box.space[space]
+        end
+        space_ids[i - 1] = space.id
+    end
+    local cdata = builtin.memtx_read_view_new(space_ids, #spaces)
+    if cdata == nil then
+        return box.error()
+    end
+    return setmetatable({
+        cdata = ffi.gc(cdata, builtin.memtx_read_view_delete),
+        scanned = {}
+    }, read_view_mt)
+end
+
 --
 -- nice output when typing box.space in admin console
 --
@@ -41,6 +41,7 @@
 #include "small/small.h"
 #include "small/quota.h"
 #include "memory.h"
+#include "box/memtx_arena.h"
 
 extern struct small_alloc memtx_alloc;
 extern struct mempool memtx_index_extent_pool;
@@ -241,6 +242,51 @@ lbox_runtime_info(struct lua_State *L)
 	return 1;
 }
 
+/**
+ * The page size and NUMA policy of the tuple and index arena
+ * and the pages the kernel has actually provided.
+ */
+static int
+lbox_slab_pages(struct lua_State *L)
+{
+	struct slab_arena *arena = memtx_alloc.cache->arena;
+
+	lua_newtable(L);
+	lua_pushstring(L, "huge_pages");
+	lua_pushstring(L, memtx_huge_pages_STRS[memtx_huge_pages]);
+	lua_settable(L, -3);
+
+	if (memtx_numa_nodes != 0) {
+		lua_pushstring(L, "numa_nodes");
+		lua_newtable(L);
+		for (int node = 0; node < 64; node++) {
+			if ((memtx_numa_nodes & (1ULL << node)) == 0)
+				continue;
+			lua_pushnumber(L, lua_objlen(L, -1) + 1);
+			lua_pushinteger(L, node);
+			lua_settable(L, -3);
+		}
+		lua_settable(L, -3);
+	}
+
+	struct memtx_arena_stats stats;
+	if (memtx_arena_stats(arena->arena, arena->prealloc, &stats) != 0)
+		return 1;
+	/** 4096 unless the arena is on hugetlbfs */
+	lua_pushstring(L, "page_size");
+	luaL_pushuint64(L, stats.page_size);
+	lua_settable(L, -3);
+	/** How much of the arena is in RAM */
+	lua_pushstring(L, "resident");
+	luaL_pushuint64(L, stats.resident);
+	lua_settable(L, -3);
+	/** How much of it is backed by huge pages */
+	lua_pushstring(L, "huge");
+	luaL_pushuint64(L, stats.huge);
+	lua_settable(L, -3);
+	return 1;
+}
+
 static int
 lbox_slab_check(MAYBE_UNUSED struct lua_State *L)
 {
@@ -264,6 +310,10 @@ box_lua_slab_init(struct lua_State *L)
 	lua_pushcfunction(L, lbox_slab_stats);
 	lua_settable(L, -3);
 
+	lua_pushstring(L, "pages");
+	lua_pushcfunction(L, lbox_slab_pages);
+	lua_settable(L, -3);
+
 	lua_pushstring(L, "check");
 	lua_pushcfunction(L, lbox_slab_check);
 	lua_settable(L, -3);
@@ -124,6 +124,23 @@ local function process(self)
 
     local snapno = fio.basename(snaps[1], '.snap')
 
+    -- incremental snapshots are applied on top of the last full one
+    local deltas = fio.glob(fio.pathjoin(box.cfg.snap_dir, '*.delta'))
+    if deltas == nil then
+        deltas = {}
+    end
+    for _, rm in ipairs(deltas) do
+        if fio.basename(rm, '.delta') > snapno then
+            break
+        end
+        log.info("removing old snapshot %s", rm)
+        if not fio.unlink(rm) then
+            log.error("error while removing %s: %s",
+                      rm, errno.strerror())
+            return
+        end
+    end
+
     while #xlogs > 0 do
         if #xlogs < 2 then
             break
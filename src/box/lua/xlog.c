@@ -242,7 +242,8 @@ lbox_xlog_parser_open_pairs(struct lua_State *L)
 		return lbox_error(L);
 	}
 	if (strncmp(cur->meta.filetype, "SNAP", 4) != 0 &&
-	    strncmp(cur->meta.filetype, "XLOG", 4) != 0) {
+	    strncmp(cur->meta.filetype, "XLOG", 4) != 0 &&
+	    strncmp(cur->meta.filetype, "DELTA", 5) != 0) {
 		char buf[1024];
 		snprintf(buf, sizeof(buf), "'%.*s' file type",
 			 (int) strlen(cur->meta.filetype),
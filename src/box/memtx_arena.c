@@ -0,0 +1,261 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "memtx_arena.h"
+#include "trivia/config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <sys/mman.h>
+#if defined(HAVE_SYS_MBIND)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "say.h"
+
+#if defined(HAVE_SYS_MBIND)
+/* From <linux/mempolicy.h>, to not depend on kernel headers. */
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+#endif /* defined(HAVE_SYS_MBIND) */
+
+const char *memtx_huge_pages_STRS[] = {
+	"none", "transparent", "explicit", NULL
+};
+
+enum memtx_huge_pages memtx_huge_pages = MEMTX_HUGE_PAGES_NONE;
+uint64_t memtx_numa_nodes = 0;
+
+int
+memtx_numa_nodes_parse(const char *str, uint64_t *mask)
+{
+	*mask = 0;
+	const char *pos = str;
+	while (*pos != '\0') {
+		char *end;
+		errno = 0;
+		unsigned long node = strtoul(pos, &end, 10);
+		if (end == pos || errno != 0 || node >= 64)
+			return -1;
+		*mask |= 1ULL << node;
+		pos = end;
+		if (*pos == ',' && pos[1] != '\0')
+			pos++;
+		else if (*pos != '\0')
+			return -1;
+	}
+	return *mask != 0 ? 0 : -1;
+}
+
+size_t
+memtx_huge_page_size(void)
+{
+	FILE *f = fopen("/proc/meminfo", "r");
+	if (f == NULL)
+		return 0;
+	char line[128];
+	size_t size_kb = 0;
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (sscanf(line, "Hugepagesize: %zu kB", &size_kb) == 1)
+			break;
+	}
+	fclose(f);
+	return size_kb * 1024;
+}
+
+/** The number of free pages in the hugetlbfs pool. */
+static size_t
+memtx_huge_pages_free(void)
+{
+	FILE *f = fopen("/proc/meminfo", "r");
+	if (f == NULL)
+		return 0;
+	char line[128];
+	size_t count = 0;
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (sscanf(line, "HugePages_Free: %zu", &count) == 1)
+			break;
+	}
+	fclose(f);
+	return count;
+}
+
+int
+memtx_arena_mmap_flags(enum memtx_huge_pages huge_pages)
+{
+	int flags = MAP_PRIVATE;
+#if defined(HAVE_MAP_HUGETLB)
+	if (huge_pages == MEMTX_HUGE_PAGES_EXPLICIT)
+		flags |= MAP_HUGETLB;
+#else
+	(void) huge_pages;
+#endif
+	return flags;
+}
+
+void
+memtx_arena_set_policy(void *addr, size_t size,
+		       enum memtx_huge_pages huge_pages,
+		       uint64_t numa_nodes)
+{
+	if (huge_pages == MEMTX_HUGE_PAGES_TRANSPARENT) {
+#if defined(HAVE_MADV_HUGEPAGE)
+		if (madvise(addr, size, MADV_HUGEPAGE) != 0) {
+			say_syserror("madvise(MADV_HUGEPAGE) of memtx arena");
+			huge_pages = MEMTX_HUGE_PAGES_NONE;
+		}
+#else
+		say_warn("transparent huge pages are not supported");
+		huge_pages = MEMTX_HUGE_PAGES_NONE;
+#endif
+	}
+	memtx_huge_pages = huge_pages;
+
+	if (numa_nodes == 0)
+		return;
+#if defined(HAVE_SYS_MBIND)
+	/*
+	 * Spread the arena over several nodes to balance
+	 * the memory bandwidth, or keep it on a single one.
+	 */
+	int mode = (numa_nodes & (numa_nodes - 1)) != 0 ?
+		   MPOL_INTERLEAVE : MPOL_BIND;
+	unsigned long mask = numa_nodes;
+	if (syscall(SYS_mbind, addr, size, mode, &mask,
+		    sizeof(mask) * CHAR_BIT + 1, 0) != 0) {
+		say_syserror("mbind() of memtx arena");
+		return;
+	}
+	memtx_numa_nodes = numa_nodes;
+#else
+	(void) addr;
+	(void) size;
+	say_warn("NUMA policy is not supported");
+#endif
+}
+
+int
+memtx_arena_fork_begin(void *addr, size_t size)
+{
+	switch (memtx_huge_pages) {
+	case MEMTX_HUGE_PAGES_TRANSPARENT:
+#if defined(HAVE_MADV_HUGEPAGE)
+		/*
+		 * A write to a transparent huge page shared with
+		 * the process copies the whole page. With
+		 * MADV_NOHUGEPAGE the kernel splits it instead and
+		 * copies only the small page written to.
+		 */
+		if (madvise(addr, size, MADV_NOHUGEPAGE) != 0)
+			say_syserror("madvise(MADV_NOHUGEPAGE) of memtx arena");
+#endif
+		break;
+	case MEMTX_HUGE_PAGES_EXPLICIT:
+		/*
+		 * hugetlbfs pages are always copied as a whole,
+		 * from the reserved pool. When it's exhausted, the
+		 * process loses the page and is killed on access.
+		 */
+		if (memtx_huge_pages_free() == 0) {
+			say_warn("no free huge pages to copy memtx arena "
+				 "pages on write");
+			return -1;
+		}
+		break;
+	default:
+		break;
+	}
+	(void) addr;
+	(void) size;
+	return 0;
+}
+
+void
+memtx_arena_fork_end(void *addr, size_t size)
+{
+#if defined(HAVE_MADV_HUGEPAGE)
+	if (memtx_huge_pages == MEMTX_HUGE_PAGES_TRANSPARENT &&
+	    madvise(addr, size, MADV_HUGEPAGE) != 0)
+		say_syserror("madvise(MADV_HUGEPAGE) of memtx arena");
+#endif
+	(void) addr;
+	(void) size;
+}
+
+int
+memtx_arena_stats(const void *addr, size_t size,
+		  struct memtx_arena_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if (f == NULL)
+		return -1;
+	uintptr_t begin = (uintptr_t) addr;
+	uintptr_t end = begin + size;
+	bool in_arena = false;
+	char line[256];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		uintptr_t vma_begin, vma_end;
+		if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " ",
+			   &vma_begin, &vma_end) == 2) {
+			/* A new mapping */
+			in_arena = vma_begin < end && vma_end > begin;
+			continue;
+		}
+		if (!in_arena)
+			continue;
+		size_t kb;
+		if (sscanf(line, "KernelPageSize: %zu kB", &kb) == 1) {
+			if (kb * 1024 > stats->page_size)
+				stats->page_size = kb * 1024;
+		} else if (sscanf(line, "Rss: %zu kB", &kb) == 1) {
+			stats->resident += kb * 1024;
+		} else if (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+			stats->huge += kb * 1024;
+		} else if (sscanf(line, "Private_Hugetlb: %zu kB", &kb) == 1 ||
+			   sscanf(line, "Shared_Hugetlb: %zu kB", &kb) == 1) {
+			/* hugetlbfs pages are not accounted in Rss */
+			stats->resident += kb * 1024;
+			stats->huge += kb * 1024;
+		}
+	}
+	fclose(f);
+	return 0;
+}
@@ -0,0 +1,135 @@
+#ifndef TARANTOOL_BOX_MEMTX_ARENA_H_INCLUDED
+#define TARANTOOL_BOX_MEMTX_ARENA_H_INCLUDED
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Page size policy of the memtx arena, which holds both
+ * tuples and index extents (box.cfg.slab_alloc_huge_pages).
+ */
+enum memtx_huge_pages {
+	/** Regular pages. */
+	MEMTX_HUGE_PAGES_NONE,
+	/** Ask the kernel for transparent huge pages. */
+	MEMTX_HUGE_PAGES_TRANSPARENT,
+	/**
+	 * Map the arena from the hugetlbfs pool, which must
+	 * be reserved in advance (vm.nr_hugepages). Note that
+	 * checkpoint fork() needs spare huge pages for pages
+	 * modified while the snapshot is being written, the
+	 * snapshot is written by a thread if there are none.
+	 */
+	MEMTX_HUGE_PAGES_EXPLICIT,
+	MEMTX_HUGE_PAGES_MAX
+};
+
+extern const char *memtx_huge_pages_STRS[];
+
+/** The page size policy actually in effect. */
+extern enum memtx_huge_pages memtx_huge_pages;
+/** A mask of NUMA nodes the arena is bound to, 0 if none. */
+extern uint64_t memtx_numa_nodes;
+
+/** Statistics of the arena memory, from /proc/self/smaps. */
+struct memtx_arena_stats {
+	/** Kernel page size of the arena mapping. */
+	size_t page_size;
+	/** Resident memory. */
+	size_t resident;
+	/** Resident memory backed by huge pages. */
+	size_t huge;
+};
+
+/**
+ * Parse a comma-separated list of NUMA node ids,
+ * e.g. "0,1", into a mask.
+ * @retval 0 success
+ * @retval -1 the list is malformed or a node id is >= 64
+ */
+int
+memtx_numa_nodes_parse(const char *str, uint64_t *mask);
+
+/**
+ * Size of a huge page as reported by /proc/meminfo,
+ * 0 if it's unknown.
+ */
+size_t
+memtx_huge_page_size(void);
+
+/** Flags to pass to slab_arena_create() for the policy. */
+int
+memtx_arena_mmap_flags(enum memtx_huge_pages huge_pages);
+
+/**
+ * Apply the page size and NUMA policy to the freshly
+ * mapped, not yet touched arena. Failures are logged,
+ * the arena stays usable in any case.
+ */
+void
+memtx_arena_set_policy(void *addr, size_t size,
+		       enum memtx_huge_pages huge_pages,
+		       uint64_t numa_nodes);
+
+/**
+ * Prepare the arena to be shared copy-on-write with a forked
+ * snapshot process: make the instance copy small pages rather
+ * than huge ones where the kernel allows it.
+ * @retval 0 success
+ * @retval -1 pages modified while the process runs can't be
+ *         copied, the snapshot must not be written by fork
+ */
+int
+memtx_arena_fork_begin(void *addr, size_t size);
+
+/** Restore the arena policy after the snapshot process exits. */
+void
+memtx_arena_fork_end(void *addr, size_t size);
+
+/**
+ * Collect memory statistics of the arena.
+ * @retval 0 success
+ * @retval -1 statistics are not available on this system
+ */
+int
+memtx_arena_stats(const void *addr, size_t size,
+		  struct memtx_arena_stats *stats);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_MEMTX_ARENA_H_INCLUDED */
@@ -33,6 +33,7 @@
 
 #include "coeio_file.h"
 #include "scoped_guard.h"
+#include <msgpuck.h>
 
 #include "tuple.h"
 #include "txn.h"
@@ -43,6 +44,17 @@
 #include "bootstrap.h"
 #include "cluster.h"
 #include "schema.h"
+#include "user_def.h"
+#include "box.h"
+#include "coio.h"
+#include "title.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#if defined(HAVE_PRCTL_H)
+#include <sys/prctl.h>
+#endif
 
 /** For all memory used by all indexes.
  * If you decide to use memtx_index_arena or
@@ -83,6 +95,163 @@ txn_on_yield_or_stop(struct trigger * /* trigger */, void * /* event */)
 	txn_rollback(); /* doesn't throw */
 }
 
+/* {{{ Delta log */
+
+/**
+ * Changes made since the last checkpoint, to write an
+ * incremental one.
+ *
+ * Memtx tuples are never modified in place, so the tuples
+ * inserted since the last checkpoint are those which have
+ * tuple->version >= delta_log.version. Deletions are not
+ * visible in the indexes and are logged here instead, in
+ * order: the key of each tuple which was present at the last
+ * checkpoint and has been removed from the primary key, and
+ * the data of each such tuple put back by a rollback.
+ *
+ * A change of a system space (DDL) makes the log incomplete,
+ * as well as failure to append to it: the next checkpoint is
+ * a full one then.
+ */
+struct delta_log {
+	/** True if incremental checkpoints are enabled. */
+	bool is_enabled;
+	/** True if the log has all changes since the last checkpoint. */
+	bool is_complete;
+	/** Tuples of this version and newer are new. */
+	uint32_t version;
+	/** A sequence of struct delta_log_entry followed by data. */
+	struct ibuf buf;
+};
+
+struct PACKED delta_log_entry {
+	/** IPROTO_DELETE for a key or IPROTO_REPLACE for a tuple. */
+	uint8_t type;
+	uint32_t space_id;
+	uint32_t size;
+};
+
+static struct delta_log delta_log;
+
+/** Start a new log, e.g. for the changes after a checkpoint. */
+static void
+delta_log_create(struct delta_log *log, bool is_enabled)
+{
+	log->is_enabled = is_enabled;
+	log->is_complete = is_enabled;
+	log->version = ++snapshot_version;
+	ibuf_create(&log->buf, &cord()->slabc, 16 * 1024);
+}
+
+static void
+delta_log_destroy(struct delta_log *log)
+{
+	ibuf_destroy(&log->buf);
+}
+
+static void
+delta_log_append(struct delta_log *log, uint8_t type, uint32_t space_id,
+		 const char *data, uint32_t size)
+{
+	struct delta_log_entry *entry = (struct delta_log_entry *)
+		ibuf_alloc(&log->buf, sizeof(*entry) + size);
+	if (entry == NULL) {
+		say_warn("failed to log a change, the next snapshot "
+			 "will be a full one");
+		log->is_complete = false;
+		return;
+	}
+	entry->type = type;
+	entry->space_id = space_id;
+	entry->size = size;
+	memcpy(entry + 1, data, size);
+}
+
+/**
+ * Put the changes of an aborted checkpoint back to the
+ * head of the log. The previous log is left empty.
+ */
+static void
+delta_log_merge(struct delta_log *log, struct delta_log *prev)
+{
+	log->is_complete = log->is_complete && prev->is_complete;
+	log->version = prev->version;
+	if (!log->is_complete)
+		return;
+	size_t size = ibuf_used(&log->buf);
+	void *data = ibuf_alloc(&prev->buf, size);
+	if (data == NULL) {
+		log->is_complete = false;
+		return;
+	}
+	memcpy(data, log->buf.rpos, size);
+	struct ibuf tmp = log->buf;
+	log->buf = prev->buf;
+	prev->buf = tmp;
+	ibuf_reset(&prev->buf);
+}
+
+/**
+ * Log a replace in the primary key of a space: called after
+ * the index is changed, so it must not fail.
+ */
+static inline void
+delta_log_track(struct space *space, struct tuple *old_tuple)
+{
+	if (!delta_log.is_complete || space_is_temporary(space))
+		return;
+	if (space_is_system(space)) {
+		delta_log.is_complete = false;
+		return;
+	}
+	if (old_tuple == NULL || old_tuple->version >= delta_log.version)
+		return;
+	uint32_t size;
+	const char *key = tuple_extract_key(old_tuple,
+					    space->index[0]->key_def, &size);
+	if (key == NULL) {
+		diag_clear(diag_get());
+		delta_log.is_complete = false;
+		return;
+	}
+	delta_log_append(&delta_log, IPROTO_DELETE, space_id(space),
+			 key, size);
+}
+
+/**
+ * Log a rollback of a replace in the primary key. A tuple put
+ * back is logged as is. A tuple removed by rollback of an
+ * INSERT is older than the log if a checkpoint started while
+ * the INSERT was waiting for WAL: the checkpoint has the tuple,
+ * so its key is logged.
+ */
+static inline void
+delta_log_track_rollback(struct space *space, struct tuple *old_tuple,
+			 struct tuple *new_tuple)
+{
+	if (old_tuple == NULL) {
+		delta_log_track(space, new_tuple);
+		return;
+	}
+	if (!delta_log.is_complete || space_is_temporary(space) ||
+	    old_tuple->version >= delta_log.version)
+		return;
+	/* Rollback can't fail, so don't let tuple_data() throw. */
+	const char *data = old_tuple->raw;
+	if (old_tuple->is_compressed) {
+		data = tuple_unpack_cached(old_tuple);
+		if (data == NULL) {
+			diag_clear(diag_get());
+			delta_log.is_complete = false;
+			return;
+		}
+	}
+	delta_log_append(&delta_log, IPROTO_REPLACE, space_id(space),
+			 data, tuple_bsize(old_tuple));
+}
+
+/* }}} */
+
 /**
  * A short-cut version of replace() used during bulk load
  * from snapshot.
@@ -118,6 +287,7 @@ memtx_replace_primary_key(struct txn_stmt *stmt, struct space *space,
 	stmt->old_tuple = space->index[0]->replace(stmt->old_tuple,
 						   stmt->new_tuple, mode);
 	stmt->engine_savepoint = stmt;
+	delta_log_track(space, stmt->old_tuple);
 }
 
 static void
@@ -161,6 +331,7 @@ memtx_replace_all_keys(struct txn_stmt *stmt, struct space *space,
 	}
 	stmt->old_tuple = old_tuple;
 	stmt->engine_savepoint = stmt;
+	delta_log_track(space, old_tuple);
 }
 
 static void
@@ -214,27 +385,69 @@ MemtxEngine::MemtxEngine(const char *snap_dirname, bool panic_on_snap_error,
 	m_checkpoint(0),
 	m_state(MEMTX_INITIALIZED),
 	m_snap_io_rate_limit(UINT64_MAX),
+	m_snapshot_mode(MEMTX_SNAPSHOT_THREAD),
+	m_snapshot_delta_count(0),
+	m_delta_count(0),
 	m_panic_on_wal_error(panic_on_wal_error)
 {
-	flags = ENGINE_CAN_BE_TEMPORARY;
+	flags = ENGINE_CAN_BE_TEMPORARY | ENGINE_CAN_COMPRESS_TUPLES;
 	xdir_create(&m_snap_dir, snap_dirname, SNAP, &SERVER_UUID);
 	m_snap_dir.panic_if_error = panic_on_snap_error;
 	xdir_scan_xc(&m_snap_dir);
+	xdir_create(&m_delta_dir, snap_dirname, DELTA, &SERVER_UUID);
+	m_delta_dir.panic_if_error = panic_on_snap_error;
+	xdir_scan_xc(&m_delta_dir);
 	struct vclock *vclock = vclockset_last(&m_snap_dir.index);
 	if (vclock) {
 		vclock_copy(&m_last_checkpoint, vclock);
 		m_has_checkpoint = true;
+		/*
+		 * Incremental snapshots taken after the last
+		 * full one are recovered on top of it.
+		 */
+		struct vclock *delta = vclockset_first(&m_delta_dir.index);
+		for (; delta != NULL;
+		     delta = vclockset_next(&m_delta_dir.index, delta)) {
+			if (vclock_sum(delta) <= vclock_sum(vclock))
+				continue;
+			vclock_copy(&m_last_checkpoint, delta);
+			m_delta_count++;
+		}
 	} else {
 		vclock_create(&m_last_checkpoint);
 		m_has_checkpoint = false;
 	}
+	delta_log_create(&delta_log, false);
 }
 
 MemtxEngine::~MemtxEngine()
 {
+	delta_log_destroy(&delta_log);
+	xdir_destroy(&m_delta_dir);
 	xdir_destroy(&m_snap_dir);
 }
 
+void
+MemtxEngine::setSnapshotDeltaCount(int count)
+{
+	m_snapshot_delta_count = count;
+	if ((count > 0) == delta_log.is_enabled)
+		return;
+	/*
+	 * The changes made while incremental snapshots are off
+	 * are not logged, so the next snapshot is a full one.
+	 */
+	delta_log.is_enabled = count > 0;
+	delta_log.is_complete = false;
+	ibuf_reset(&delta_log.buf);
+}
+
+void
+MemtxEngine::forceFullCheckpoint()
+{
+	delta_log.is_complete = false;
+}
+
 
 int64_t
 MemtxEngine::lastCheckpoint(struct vclock *vclock)
@@ -256,7 +469,8 @@ MemtxEngine::recoverSnapshot()
 	/* Process existing snapshot */
 	say_info("recovery start");
 	assert(m_has_checkpoint);
-	int64_t signature = m_last_checkpoint.signature;
+	struct vclock *vclock = vclockset_last(&m_snap_dir.index);
+	int64_t signature = vclock_sum(vclock);
 	const char *filename = xdir_format_filename(&m_snap_dir, signature,
 						    NONE);
 
@@ -294,6 +508,79 @@ MemtxEngine::recoverSnapshot()
 	if (!cursor.eof_read)
 		panic("snapshot `%s' has no EOF marker", filename);
 
+	if (m_delta_count > 0) {
+		/*
+		 * Build the primary keys now: incremental
+		 * snapshots contain deletes and replaces.
+		 */
+		beginFinalRecovery();
+		struct vclock *delta = vclockset_first(&m_delta_dir.index);
+		for (; delta != NULL;
+		     delta = vclockset_next(&m_delta_dir.index, delta)) {
+			if (vclock_sum(delta) > signature)
+				recoverDelta(vclock_sum(delta));
+		}
+	}
+	/* Log the changes replayed from WAL from now on. */
+	delta_log_destroy(&delta_log);
+	delta_log_create(&delta_log, delta_log.is_enabled);
+}
+
+void
+MemtxEngine::recoverDelta(int64_t signature)
+{
+	const char *filename = xdir_format_filename(&m_delta_dir, signature,
+						    NONE);
+	say_info("recovering from `%s'", filename);
+	struct xlog_cursor cursor;
+	if (xdir_open_cursor(&m_delta_dir, signature, &cursor) != 0)
+		diag_raise();
+	auto reader_guard = make_scoped_guard([&]{
+		xlog_cursor_close(&cursor, false);
+	});
+
+	struct xrow_header row;
+	while (xlog_cursor_next_xc(&cursor, &row,
+				   m_delta_dir.panic_if_error) == 0) {
+		try {
+			recoverDeltaRow(&row);
+		} catch (ClientError *e) {
+			if (m_delta_dir.panic_if_error)
+				throw;
+			say_error("can't apply row: ");
+			e->log();
+		}
+	}
+	if (!cursor.eof_read)
+		panic("snapshot `%s' has no EOF marker", filename);
+}
+
+void
+MemtxEngine::recoverDeltaRow(struct xrow_header *row)
+{
+	assert(row->bodycnt == 1); /* always 1 for read */
+	if (row->type != IPROTO_REPLACE && row->type != IPROTO_DELETE) {
+		tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+			  (uint32_t) row->type);
+	}
+
+	struct request *request = xrow_decode_request(row);
+	struct space *space = space_cache_find(request->space_id);
+	/* memtx snapshot must contain only memtx spaces */
+	if (space->handler->engine != this)
+		tnt_raise(ClientError, ER_CROSS_ENGINE_TRANSACTION);
+	struct txn *txn = txn_begin_stmt(space);
+	try {
+		if (row->type == IPROTO_REPLACE)
+			space->handler->executeReplace(txn, space, request);
+		else
+			space->handler->executeDelete(txn, space, request);
+		txn_commit_stmt(txn, request);
+	} catch (Exception *e) {
+		txn_rollback_stmt();
+		throw;
+	}
+	fiber_gc();
 }
 
 void
@@ -343,7 +630,8 @@ MemtxEngine::beginInitialRecovery(struct vclock *vclock)
 void
 MemtxEngine::beginFinalRecovery()
 {
-	if (m_state == MEMTX_OK)
+	/* Done already: no keys or incremental snapshots. */
+	if (m_state != MEMTX_INITIAL_RECOVERY)
 		return;
 
 	assert(m_state == MEMTX_INITIAL_RECOVERY);
@@ -623,6 +911,9 @@ MemtxEngine::rollbackStatement(struct txn *, struct txn_stmt *stmt)
 		Index *index = space->index[i];
 		index->replace(stmt->new_tuple, stmt->old_tuple, DUP_INSERT);
 	}
+	if (index_count > 0)
+		delta_log_track_rollback(space, stmt->old_tuple,
+					 stmt->new_tuple);
 	if (stmt->new_tuple)
 		tuple_unref(stmt->new_tuple);
 
@@ -710,9 +1001,6 @@ checkpoint_write_row(struct xlog *l, struct xrow_header *row,
 	}
 	bytes += written;
 
-	if (l->rows % 100000 == 0)
-		say_crit("%.1fM rows written", l->rows / 1000000.);
-
 
 	if (snap_io_rate_limit != UINT64_MAX) {
 		if (last == 0) {
@@ -752,45 +1040,78 @@ checkpoint_write_row(struct xlog *l, struct xrow_header *row,
 	}
 }
 
+/**
+ * Write an INSERT or REPLACE of a tuple, or a DELETE by key.
+ */
 static void
-checkpoint_write_tuple(struct xlog *l, uint32_t n, struct tuple *tuple,
-		       uint64_t snap_io_rate_limit)
+checkpoint_write_data(struct xlog *l, uint16_t type, uint32_t n,
+		      const char *data, uint32_t size,
+		      uint64_t snap_io_rate_limit)
 {
 	struct request_replace_body body;
 	body.m_body = 0x82; /* map of two elements. */
 	body.k_space_id = IPROTO_SPACE_ID;
 	body.m_space_id = 0xce; /* uint32 */
 	body.v_space_id = mp_bswap_u32(n);
-	body.k_tuple = IPROTO_TUPLE;
+	body.k_tuple = type == IPROTO_DELETE ? IPROTO_KEY : IPROTO_TUPLE;
 
 	struct xrow_header row;
 	memset(&row, 0, sizeof(struct xrow_header));
-	row.type = IPROTO_INSERT;
+	row.type = type;
 
 	row.bodycnt = 2;
 	row.body[0].iov_base = &body;
 	row.body[0].iov_len = sizeof(body);
-	uint32_t bsize;
-	row.body[1].iov_base = (char *) tuple_data_range(tuple, &bsize);
-	row.body[1].iov_len = bsize;
+	row.body[1].iov_base = (char *) data;
+	row.body[1].iov_len = size;
 	checkpoint_write_row(l, &row, snap_io_rate_limit);
 }
 
+/**
+ * Compressed tuples are decompressed into a private buffer,
+ * since the snapshot thread can not use the tx thread cache.
+ */
+static void
+checkpoint_write_tuple(struct xlog *l, uint16_t type, uint32_t n,
+		       struct tuple *tuple, struct tuple_unpack_ctx *unpack,
+		       uint64_t snap_io_rate_limit)
+{
+	uint32_t bsize;
+	const char *data = tuple_unpack(unpack, tuple, &bsize);
+	if (data == NULL)
+		diag_raise();
+	checkpoint_write_data(l, type, n, data, bsize, snap_io_rate_limit);
+}
+
 struct checkpoint_entry {
 	struct space *space;
 	struct iterator *iterator;
 	struct rlist link;
 };
 
+const char *memtx_snapshot_mode_STRS[] = { "thread", "fork", NULL };
+
 struct checkpoint {
 	/**
 	 * List of MemTX spaces to snapshot, with consistent
 	 * read view iterators.
 	 */
 	struct rlist entries;
+	/** Total number of tuples in the spaces, for progress. */
+	uint64_t total_rows;
 	uint64_t snap_io_rate_limit;
 	struct cord cord;
 	bool waiting_for_snap_thread;
+	/** True if the snapshot is written by a forked process. */
+	bool is_forked;
+	/** The snapshot process, 0 if it has exited. */
+	pid_t pid;
+	/** A pipe to pass the snapshot vclock to the process. */
+	int vclock_fd;
+	/** True if only the changes are written. */
+	bool is_delta;
+	/** The changes since the previous checkpoint. */
+	struct delta_log delta;
 	/** The vclock of the snapshot file. */
 	struct vclock vclock;
 	struct xdir dir;
@@ -798,11 +1119,20 @@ struct checkpoint {
 
 static void
 checkpoint_init(struct checkpoint *ckpt, const char *snap_dirname,
-		uint64_t snap_io_rate_limit)
+		uint64_t snap_io_rate_limit, bool is_delta)
 {
 	ckpt->entries = RLIST_HEAD_INITIALIZER(ckpt->entries);
+	ckpt->total_rows = 0;
 	ckpt->waiting_for_snap_thread = false;
-	xdir_create(&ckpt->dir, snap_dirname, SNAP, &SERVER_UUID);
+	ckpt->is_forked = false;
+	ckpt->pid = 0;
+	ckpt->vclock_fd = -1;
+	ckpt->is_delta = is_delta;
+	/* Changes made from now on go to the next checkpoint. */
+	ckpt->delta = delta_log;
+	delta_log_create(&delta_log, delta_log.is_enabled);
+	xdir_create(&ckpt->dir, snap_dirname, is_delta ? DELTA : SNAP,
+		    &SERVER_UUID);
 	ckpt->snap_io_rate_limit = snap_io_rate_limit;
 	/* May be used in abortCheckpoint() */
 	vclock_create(&ckpt->vclock);
@@ -818,6 +1148,7 @@ checkpoint_destroy(struct checkpoint *ckpt)
 		entry->iterator->free(entry->iterator);
 	}
 	ckpt->entries = RLIST_HEAD_INITIALIZER(ckpt->entries);
+	delta_log_destroy(&ckpt->delta);
 	xdir_destroy(&ckpt->dir);
 }
 
@@ -839,37 +1170,206 @@ checkpoint_add_space(struct space *sp, void *data)
 
 	entry->space = sp;
 	entry->iterator = pk->allocIterator();
+	ckpt->total_rows += pk->size();
 
 	pk->initIterator(entry->iterator, ITER_ALL, NULL, 0);
 	pk->createReadViewForIterator(entry->iterator);
 };
 
-int
-checkpoint_f(va_list ap)
+static void
+checkpoint_write_delta_log(struct xlog *l, struct checkpoint *ckpt)
 {
-	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
+	const char *pos = ckpt->delta.buf.rpos;
+	const char *end = ckpt->delta.buf.wpos;
+	while (pos < end) {
+		const struct delta_log_entry *entry =
+			(const struct delta_log_entry *) pos;
+		const char *data = (const char *) (entry + 1);
+		checkpoint_write_data(l, entry->type, entry->space_id,
+				      data, entry->size,
+				      ckpt->snap_io_rate_limit);
+		pos = data + entry->size;
+	}
+}
 
+static void
+checkpoint_write(struct checkpoint *ckpt)
+{
 	struct xlog snap;
 	if (xdir_create_xlog(&ckpt->dir, &snap, &ckpt->vclock) != 0)
 		diag_raise();
 
-	auto guard = make_scoped_guard([&]{ xlog_close(&snap, false); });
+	struct tuple_unpack_ctx unpack;
+	tuple_unpack_ctx_create(&unpack);
+	auto guard = make_scoped_guard([&]{
+		tuple_unpack_ctx_destroy(&unpack);
+		xlog_close(&snap, false);
+	});
 
 	say_info("saving snapshot `%s'", snap.filename);
+	/*
+	 * An incremental snapshot is recovered on top of the
+	 * previous one: deletes go first, then the tuples
+	 * inserted since the previous snapshot.
+	 */
+	uint16_t type = IPROTO_INSERT;
+	if (ckpt->is_delta) {
+		checkpoint_write_delta_log(&snap, ckpt);
+		type = IPROTO_REPLACE;
+	}
+	uint64_t scanned = 0;
 	struct checkpoint_entry *entry;
 	rlist_foreach_entry(entry, &ckpt->entries, link) {
 		struct tuple *tuple;
 		struct iterator *it = entry->iterator;
 		for (tuple = it->next(it); tuple; tuple = it->next(it)) {
-			checkpoint_write_tuple(&snap, space_id(entry->space),
-					       tuple, ckpt->snap_io_rate_limit);
+			if (++scanned % 100000 == 0) {
+				say_crit("%.1fM rows written, %.0f%% done",
+					 snap.rows / 1000000.,
+					 100. * scanned / ckpt->total_rows);
+			}
+			if (ckpt->is_delta &&
+			    tuple->version < ckpt->delta.version)
+				continue;
+			checkpoint_write_tuple(&snap, type,
+					       space_id(entry->space), tuple,
+					       &unpack, ckpt->snap_io_rate_limit);
 		}
 	}
 	xlog_flush(&snap);
 	say_info("done");
+}
+
+int
+checkpoint_f(va_list ap)
+{
+	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
+	checkpoint_write(ckpt);
+	return 0;
+}
+
+/**
+ * The body of the process forked to write a snapshot. The
+ * process owns a copy-on-write image of the parent memory
+ * frozen at the time of fork, so no read views are needed.
+ */
+static void NORETURN
+checkpoint_process(struct checkpoint *ckpt, int vclock_fd)
+{
+	/* Don't hold client connections and other files open */
+	close_all_xcpt(2, log_fd, vclock_fd);
+	title_set_status("snapshot");
+	title_update();
+#if defined(HAVE_PRCTL_H)
+	prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+	/*
+	 * Under memory pressure it's better to lose the
+	 * snapshot than the instance.
+	 */
+	int fd = open("/proc/self/oom_score_adj", O_WRONLY);
+	if (fd >= 0) {
+		if (write(fd, "1000", 4) < 0)
+			say_syserror("failed to set oom_score_adj");
+		close(fd);
+	}
+
+	/* Wait for the vclock from waitCheckpoint() */
+	size_t size = sizeof(ckpt->vclock);
+	char *pos = (char *) &ckpt->vclock;
+	while (size > 0) {
+		ssize_t n = read(vclock_fd, pos, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			/* The checkpoint is aborted */
+			_exit(EXIT_FAILURE);
+		}
+		pos += n;
+		size -= n;
+	}
+	close(vclock_fd);
+
+	try {
+		space_foreach(checkpoint_add_space, ckpt);
+		checkpoint_write(ckpt);
+	} catch (Exception *e) {
+		e->log();
+		_exit(EXIT_FAILURE);
+	}
+	_exit(EXIT_SUCCESS);
+}
+
+/**
+ * Fork a process to write the snapshot.
+ * @retval 0 the process is started
+ * @retval -1 fork failed, the snapshot should be written
+ *         by a thread
+ */
+static int
+checkpoint_fork(struct checkpoint *ckpt)
+{
+	if (memtx_arena_fork_begin(memtx_arena.arena,
+				   memtx_arena.prealloc) != 0) {
+		say_warn("writing the snapshot by a thread");
+		return -1;
+	}
+	int fds[2];
+	if (pipe(fds) != 0) {
+		say_syserror("pipe");
+		memtx_arena_fork_end(memtx_arena.arena, memtx_arena.prealloc);
+		return -1;
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+		say_syserror("can't fork a snapshot process, "
+			     "using a thread");
+		close(fds[0]);
+		close(fds[1]);
+		memtx_arena_fork_end(memtx_arena.arena, memtx_arena.prealloc);
+		return -1;
+	}
+	if (pid == 0) {
+		close(fds[1]);
+		checkpoint_process(ckpt, fds[0]);
+	}
+	close(fds[0]);
+	ckpt->is_forked = true;
+	ckpt->pid = pid;
+	ckpt->vclock_fd = fds[1];
+	say_info("snapshot process %d started", (int) pid);
 	return 0;
 }
 
+/**
+ * Wait for the snapshot process to exit.
+ * @retval 0 the snapshot is written
+ * @retval -1 the process failed
+ */
+static int
+checkpoint_wait_process(struct checkpoint *ckpt)
+{
+	assert(ckpt->pid > 0);
+	if (ckpt->vclock_fd >= 0) {
+		close(ckpt->vclock_fd);
+		ckpt->vclock_fd = -1;
+	}
+	int status = coio_waitpid(ckpt->pid);
+	ckpt->pid = 0;
+	memtx_arena_fork_end(memtx_arena.arena, memtx_arena.prealloc);
+	if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+		return 0;
+	char msg[64];
+	if (WIFSIGNALED(status)) {
+		snprintf(msg, sizeof(msg), "snapshot process killed "
+			 "by signal %d", WTERMSIG(status));
+	} else {
+		snprintf(msg, sizeof(msg), "snapshot process failed");
+	}
+	diag_set(ClientError, ER_SYSTEM, msg);
+	return -1;
+}
+
 int
 MemtxEngine::beginCheckpoint()
 {
@@ -877,7 +1377,13 @@ MemtxEngine::beginCheckpoint()
 
 	m_checkpoint = region_alloc_object_xc(&fiber()->gc, struct checkpoint);
 
-	checkpoint_init(m_checkpoint, m_snap_dir.dirname, m_snap_io_rate_limit);
+	bool is_delta = m_has_checkpoint && delta_log.is_complete &&
+			m_delta_count < m_snapshot_delta_count;
+	checkpoint_init(m_checkpoint, m_snap_dir.dirname, m_snap_io_rate_limit,
+			is_delta);
+	if (m_snapshot_mode == MEMTX_SNAPSHOT_FORK &&
+	    checkpoint_fork(m_checkpoint) == 0)
+		return 0;
 	space_foreach(checkpoint_add_space, m_checkpoint);
 
 	/* increment snapshot version; set tuple deletion to delayed mode */
@@ -892,6 +1398,27 @@ MemtxEngine::waitCheckpoint(struct vclock *vclock)
 
 	vclock_copy(&m_checkpoint->vclock, vclock);
 
+	if (m_checkpoint->is_forked) {
+		/*
+		 * A pipe write of this size is atomic. If it
+		 * fails, the process gets EOF and exits without
+		 * writing the snapshot.
+		 */
+		bool is_sent = write(m_checkpoint->vclock_fd, vclock,
+				     sizeof(*vclock)) == sizeof(*vclock);
+		int write_errno = errno;
+		int result = checkpoint_wait_process(m_checkpoint);
+		if (!is_sent) {
+			errno = write_errno;
+			diag_set(SystemError, "failed to pass vclock "
+				 "to the snapshot process");
+			result = -1;
+		}
+		if (result != 0)
+			error_log(diag_last_error(diag_get()));
+		return result;
+	}
+
 	if (cord_costart(&m_checkpoint->cord, "snapshot",
 			 checkpoint_f, m_checkpoint)) {
 		return -1;
@@ -915,11 +1442,24 @@ MemtxEngine::commitCheckpoint(struct vclock *vclock)
 	assert(m_checkpoint);
 	/* waitCheckpoint() must have been done. */
 	assert(!m_checkpoint->waiting_for_snap_thread);
+	assert(m_checkpoint->pid == 0);
 
-	tuple_end_snapshot();
+	if (!m_checkpoint->is_forked)
+		tuple_end_snapshot();
 
 	int64_t lsn = vclock_sum(&m_checkpoint->vclock);
 	struct xdir *dir = &m_checkpoint->dir;
+	if (m_checkpoint->is_delta && lsn == vclock_sum(&m_last_checkpoint)) {
+		/*
+		 * Nothing has been written to WAL since the last
+		 * snapshot, don't replace it with an empty one.
+		 */
+		(void) coeio_unlink(xdir_format_filename(dir, lsn,
+							 INPROGRESS));
+		checkpoint_destroy(m_checkpoint);
+		m_checkpoint = 0;
+		return;
+	}
 	/* rename snapshot on completion */
 	char to[PATH_MAX];
 	snprintf(to, sizeof(to), "%s",
@@ -931,6 +1471,7 @@ MemtxEngine::commitCheckpoint(struct vclock *vclock)
 
 	vclock_copy(&m_last_checkpoint, &m_checkpoint->vclock);
 	m_has_checkpoint = true;
+	m_delta_count = m_checkpoint->is_delta ? m_delta_count + 1 : 0;
 	checkpoint_destroy(m_checkpoint);
 	m_checkpoint = 0;
 }
@@ -947,8 +1488,14 @@ MemtxEngine::abortCheckpoint()
 			error_log(diag_last_error(diag_get()));
 		m_checkpoint->waiting_for_snap_thread = false;
 	}
+	if (m_checkpoint->pid != 0) {
+		/* The process exits as soon as the pipe is closed */
+		if (checkpoint_wait_process(m_checkpoint) != 0)
+			diag_clear(diag_get());
+	}
 
-	tuple_end_snapshot();
+	if (!m_checkpoint->is_forked)
+		tuple_end_snapshot();
 
 	/** Remove garbage .inprogress file. */
 	char *filename =
@@ -957,10 +1504,182 @@ MemtxEngine::abortCheckpoint()
 				     INPROGRESS);
 	(void) coeio_unlink(filename);
 
+	/* The next checkpoint must include the lost changes. */
+	delta_log_merge(&delta_log, &m_checkpoint->delta);
 	checkpoint_destroy(m_checkpoint);
 	m_checkpoint = 0;
 }
 
+/* {{{ Read views */
+
+struct read_view_entry {
+	uint32_t space_id;
+	/**
+	 * The primary key the iterator was opened on.
+	 * NULL if the space was altered or dropped.
+	 */
+	Index *index;
+	/** A frozen iterator over the primary key. */
+	struct iterator *iterator;
+};
+
+struct memtx_read_view {
+	/** Link in the list of all open read views. */
+	struct rlist link;
+	/**
+	 * Tuples seen by the view may be already deleted, so
+	 * they can't use the decompressed data cache.
+	 */
+	struct tuple_unpack_ctx unpack;
+	uint32_t entry_count;
+	struct read_view_entry entries[0];
+};
+
+/** All open read views, to detach dropped indexes from. */
+static RLIST_HEAD(memtx_read_views);
+
+static void
+read_view_entry_close(struct read_view_entry *entry)
+{
+	if (entry->index == NULL)
+		return;
+	entry->index->destroyReadViewForIterator(entry->iterator);
+	entry->iterator->free(entry->iterator);
+	entry->index = NULL;
+	entry->iterator = NULL;
+}
+
+struct memtx_read_view *
+memtx_read_view_new(const uint32_t *space_ids, uint32_t space_count)
+{
+	size_t size = sizeof(struct memtx_read_view) +
+		space_count * sizeof(struct read_view_entry);
+	struct memtx_read_view *view =
+		(struct memtx_read_view *) calloc(1, size);
+	if (view == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "struct memtx_read_view");
+		return NULL;
+	}
+	rlist_add_entry(&memtx_read_views, view, link);
+	tuple_unpack_ctx_create(&view->unpack);
+	/*
+	 * Bump the snapshot version before freezing the
+	 * indexes, so that tuples deleted from now on are not
+	 * reused while the view can still see them.
+	 */
+	tuple_begin_snapshot();
+	try {
+		for (uint32_t i = 0; i < space_count; i++) {
+			struct space *space = space_cache_find(space_ids[i]);
+			access_check_space(space, PRIV_R);
+			if (!space_is_memtx(space)) {
+				tnt_raise(ClientError, ER_UNSUPPORTED,
+					  space->handler->engine->name,
+					  "read view");
+			}
+			Index *pk = index_find_xc(space, 0);
+			struct read_view_entry *entry = &view->entries[i];
+			entry->space_id = space_ids[i];
+			entry->iterator = pk->allocIterator();
+			pk->initIterator(entry->iterator, ITER_ALL, NULL, 0);
+			pk->createReadViewForIterator(entry->iterator);
+			entry->index = pk;
+			view->entry_count = i + 1;
+		}
+	} catch (Exception *) {
+		struct read_view_entry *entry =
+			&view->entries[view->entry_count];
+		if (entry->iterator != NULL)
+			entry->iterator->free(entry->iterator);
+		memtx_read_view_delete(view);
+		return NULL;
+	}
+	return view;
+}
+
+int
+memtx_read_view_next(struct memtx_read_view *view, uint32_t space_id,
+		     const char **data, const char **data_end)
+{
+	for (uint32_t i = 0; i < view->entry_count; i++) {
+		struct read_view_entry *entry = &view->entries[i];
+		if (entry->space_id != space_id)
+			continue;
+		if (entry->index == NULL) {
+			diag_set(ClientError, ER_READ_VIEW_SPACE_CHANGED,
+				 int2str(space_id));
+			return -1;
+		}
+		struct iterator *it = entry->iterator;
+		struct tuple *tuple = it->next(it);
+		if (tuple == NULL) {
+			*data = *data_end = NULL;
+			return 0;
+		}
+		uint32_t bsize;
+		*data = tuple_unpack(&view->unpack, tuple, &bsize);
+		if (*data == NULL)
+			return -1;
+		*data_end = *data + bsize;
+		return 0;
+	}
+	diag_set(ClientError, ER_NO_SUCH_SPACE, int2str(space_id));
+	return -1;
+}
+
+void
+memtx_read_view_delete(struct memtx_read_view *view)
+{
+	for (uint32_t i = 0; i < view->entry_count; i++)
+		read_view_entry_close(&view->entries[i]);
+	rlist_del_entry(view, link);
+	tuple_unpack_ctx_destroy(&view->unpack);
+	tuple_end_snapshot();
+	free(view);
+}
+
+void
+memtx_read_view_detach(Index *index)
+{
+	struct memtx_read_view *view;
+	rlist_foreach_entry(view, &memtx_read_views, link) {
+		for (uint32_t i = 0; i < view->entry_count; i++) {
+			if (view->entries[i].index == index)
+				read_view_entry_close(&view->entries[i]);
+		}
+	}
+}
+
+/* }}} */
+
+enum {
+	/**
+	 * Snapshot txs are accumulated and sent to a joining
+	 * replica in chunks of about this size.
+	 */
+	MEMTX_JOIN_CHUNK_SIZE = 1024 * 1024
+};
+
+/**
+ * Send a chunk of raw snapshot txs as a single
+ * IPROTO_XLOG_TX row.
+ */
+static void
+memtx_join_send_chunk(struct xstream *stream, struct ibuf *chunk)
+{
+	char bin[5];
+	struct xrow_header row;
+	memset(&row, 0, sizeof(row));
+	row.type = IPROTO_XLOG_TX;
+	row.body[0].iov_base = bin;
+	row.body[0].iov_len = mp_encode_binl(bin, ibuf_used(chunk)) - bin;
+	row.body[1].iov_base = chunk->rpos;
+	row.body[1].iov_len = ibuf_used(chunk);
+	row.bodycnt = 2;
+	xstream_write(stream, &row);
+	ibuf_reset(chunk);
+}
+
 /** Used to pass arguments to memtx_initial_join_f */
 struct memtx_join_arg {
 	const char *snap_dirname;
@@ -994,10 +1713,35 @@ memtx_initial_join_f(va_list ap)
 		xlog_cursor_close(&cursor, false);
 	});
 
-	struct xrow_header row;
-	while (xlog_cursor_next_xc(&cursor, &row, true) == 0) {
-		xstream_write(stream, &row);
+	/*
+	 * Send snapshot txs as they are stored in the file,
+	 * possibly compressed: there is no need to decode
+	 * every row only to encode it again. The relay unpacks
+	 * the chunks for replicas which don't support them.
+	 */
+	struct ibuf chunk;
+	ibuf_create(&chunk, &cord()->slabc, MEMTX_JOIN_CHUNK_SIZE);
+	auto chunk_guard = make_scoped_guard([&]{
+		ibuf_destroy(&chunk);
+	});
+	const char *data, *data_end;
+	int rc;
+	while ((rc = xlog_cursor_next_raw_tx(&cursor, &data,
+					     &data_end)) == 0) {
+		size_t size = data_end - data;
+		void *dst = ibuf_alloc(&chunk, size);
+		if (dst == NULL) {
+			tnt_raise(OutOfMemory, size, "runtime",
+				  "join chunk");
+		}
+		memcpy(dst, data, size);
+		if (ibuf_used(&chunk) >= MEMTX_JOIN_CHUNK_SIZE)
+			memtx_join_send_chunk(stream, &chunk);
 	}
+	if (rc < 0)
+		diag_raise();
+	if (ibuf_used(&chunk) > 0)
+		memtx_join_send_chunk(stream, &chunk);
 
 	/**
 	 * We should never try to read snapshots with no EOF
@@ -1020,7 +1764,7 @@ MemtxEngine::join(struct xstream *stream)
 	 * as a replica. Our best effort is to not crash in such
 	 * case: raise ER_MISSING_SNAPSHOT.
 	 */
-	if (!m_has_checkpoint)
+	if (!m_has_checkpoint || lastCheckpointIsDelta())
 		tnt_raise(ClientError, ER_MISSING_SNAPSHOT);
 
 	/*
@@ -47,6 +47,23 @@
  * inserted only into the primary key. The final
  * state is for a fully functional space.
  */
+/** How memtx writes a checkpoint (box.cfg.snapshot_mode). */
+enum memtx_snapshot_mode {
+	/**
+	 * A thread writes consistent read views of the
+	 * spaces, freed tuples are kept until it's done.
+	 */
+	MEMTX_SNAPSHOT_THREAD,
+	/**
+	 * A forked process writes its copy-on-write image
+	 * of the spaces.
+	 */
+	MEMTX_SNAPSHOT_FORK,
+	MEMTX_SNAPSHOT_MODE_MAX
+};
+
+extern const char *memtx_snapshot_mode_STRS[];
+
 enum memtx_recovery_state {
 	/** The space has no indexes. */
 	MEMTX_INITIALIZED,
@@ -97,6 +114,13 @@ struct MemtxEngine: public Engine {
 	virtual void commitCheckpoint(struct vclock *vclock) override;
 	virtual void abortCheckpoint() override;
 	virtual void initSystemSpace(struct space *space) override;
+	/* Update snapshot_mode. */
+	void setSnapshotMode(enum memtx_snapshot_mode mode)
+	{
+		m_snapshot_mode = mode;
+	}
+	/* Update snapshot_delta_count. */
+	void setSnapshotDeltaCount(int count);
 	/* Update snap_io_rate_limit. */
 	void setSnapIoRateLimit(double new_limit)
 	{
@@ -109,10 +133,21 @@ struct MemtxEngine: public Engine {
 	 * no snapshot.
 	 */
 	int64_t lastCheckpoint(struct vclock *vclock);
+	/** True if the most recent snapshot is incremental. */
+	bool lastCheckpointIsDelta()
+	{
+		return m_delta_count > 0;
+	}
+	/** Make the next snapshot a full one. */
+	void forceFullCheckpoint();
 	void recoverSnapshot();
 private:
 	void
 	recoverSnapshotRow(struct xrow_header *row);
+	void
+	recoverDelta(int64_t signature);
+	void
+	recoverDeltaRow(struct xrow_header *row);
 	/** Non-zero if there is a checkpoint (snapshot) in progress. */
 	struct checkpoint *m_checkpoint;
 	enum memtx_recovery_state m_state;
@@ -120,6 +155,17 @@ private:
 	struct xdir m_snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t m_snap_io_rate_limit;
+	enum memtx_snapshot_mode m_snapshot_mode;
+	/** The directory index of incremental snapshots. */
+	struct xdir m_delta_dir;
+	/**
+	 * Max number of incremental snapshots between two
+	 * full ones, 0 if incremental snapshots are off.
+	 */
+	int m_snapshot_delta_count;
+	/** Number of incremental snapshots since the last full one. */
+	int m_delta_count;
+	/** The vclock of the last snapshot, full or incremental. */
 	struct vclock m_last_checkpoint;
 	bool m_has_checkpoint;
 	bool m_panic_on_wal_error;
@@ -158,4 +204,59 @@ memtx_index_extent_free(void *ctx, void *extent);
 void
 memtx_index_extent_reserve(int num);
 
+/**
+ * A consistent read view of a set of memtx spaces.
+ *
+ * A read view freezes the primary key of every space it was
+ * opened on and switches tuple memory to the delayed free mode,
+ * exactly like a checkpoint does. Writers are not blocked: the
+ * view keeps seeing the data as of the moment it was opened.
+ * Until the view is closed, the data it returns is immutable
+ * and doesn't depend on the schema cache, so
+ * memtx_read_view_next() may be called from any thread, while
+ * memtx_read_view_new() and memtx_read_view_delete() must be
+ * called from the tx thread. A reader in another thread must
+ * be done with the view before a space in it is altered or
+ * dropped: DDL detaches the space from all open views.
+ *
+ * Several read views and a checkpoint may be open at the same
+ * time.
+ */
+struct memtx_read_view;
+
+extern "C" {
+
+/**
+ * Open a read view on primary keys of the given spaces.
+ * \retval NULL on error, check diag.
+ */
+struct memtx_read_view *
+memtx_read_view_new(const uint32_t *space_ids, uint32_t space_count);
+
+/**
+ * Fetch the next tuple of a space from a read view.
+ * The tuple is returned as its MsgPack data, which stays
+ * valid until the view is deleted, or, if the tuple is
+ * compressed, until the next call. *data is set to NULL when
+ * the space is exhausted.
+ * \retval -1 if the space is not in the view, or was altered
+ *         or dropped after the view was opened, check diag.
+ */
+int
+memtx_read_view_next(struct memtx_read_view *view, uint32_t space_id,
+		     const char **data, const char **data_end);
+
+/** Close a read view and release the memory it pins. */
+void
+memtx_read_view_delete(struct memtx_read_view *view);
+
+} /* extern "C" */
+
+/**
+ * Detach an index which is about to be destroyed from all
+ * open read views.
+ */
+void
+memtx_read_view_detach(Index *index);
+
 #endif /* TARANTOOL_BOX_MEMTX_ENGINE_H_INCLUDED */
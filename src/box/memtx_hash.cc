@@ -226,6 +226,7 @@ MemtxHash::MemtxHash(struct key_def *key_def_arg)
 
 MemtxHash::~MemtxHash()
 {
+	memtx_read_view_detach(this);
 	light_index_destroy(hash_table);
 	free(hash_table);
 }
@@ -158,7 +158,13 @@ static struct tuple *
 index_rtree_iterator_next(struct iterator *i)
 {
 	struct index_rtree_iterator *itr = (struct index_rtree_iterator *)i;
-	return (struct tuple *)rtree_iterator_next(&itr->impl);
+	struct tuple *tuple = (struct tuple *)rtree_iterator_next(&itr->impl);
+	if (tuple == NULL && itr->impl.is_oom) {
+		tnt_raise(OutOfMemory, itr->impl.neigh_capacity *
+			  sizeof(struct rtree_neighbor),
+			  "MemtxRTree", "neighbor iterator");
+	}
+	return tuple;
 }
 
 /* }}} */
@@ -308,7 +314,10 @@ MemtxRTree::initIterator(struct iterator *iterator, enum iterator_type type,
 	default:
 		return Index::initIterator(iterator, type, key, part_count);
 	}
-	rtree_search(&m_tree, &rect, op, &it->impl);
+	if (!rtree_search(&m_tree, &rect, op, &it->impl) && it->impl.is_oom) {
+		tnt_raise(OutOfMemory, sizeof(struct rtree_neighbor),
+			  "MemtxRTree", "neighbor iterator");
+	}
 }
 
 void
@@ -317,3 +326,30 @@ MemtxRTree::beginBuild()
 	rtree_purge(&m_tree);
 }
 
+void
+MemtxRTree::buildNext(struct tuple *tuple)
+{
+	struct rtree_rect rect;
+	extract_rectangle(&rect, tuple, key_def);
+	if (rtree_bulk_add(&m_tree, &rect, tuple) != 0) {
+		tnt_raise(OutOfMemory, m_tree.page_branch_size,
+			  "MemtxRTree", "build");
+	}
+}
+
+void
+MemtxRTree::endBuild()
+{
+	/*
+	 * The tree is packed level by level and can't be left
+	 * half built, so reserve extents for all its pages and
+	 * for the matras directory up front.
+	 */
+	size_t size = (size_t) rtree_bulk_page_count(&m_tree) *
+		      m_tree.page_size;
+	size_t extents = (size + MEMTX_EXTENT_SIZE - 1) / MEMTX_EXTENT_SIZE;
+	extents += extents / (MEMTX_EXTENT_SIZE / sizeof(void *)) + 2;
+	memtx_index_extent_reserve(extents);
+	rtree_bulk_load(&m_tree);
+}
+
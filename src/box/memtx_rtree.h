@@ -41,6 +41,8 @@ public:
 	~MemtxRTree();
 
 	virtual void beginBuild() override;
+	virtual void buildNext(struct tuple *tuple) override;
+	virtual void endBuild() override;
 	virtual size_t size() const override;
 	virtual struct tuple *findByKey(const char *key,
 					uint32_t part_count) const override;
@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "memtx_tree.h"
+#include "memtx_engine.h"
 #include "tuple.h"
 #include "space.h"
 #include "schema.h" /* space_cache_find() */
@@ -198,6 +199,7 @@ MemtxTree::MemtxTree(struct key_def *key_def_arg)
 
 MemtxTree::~MemtxTree()
 {
+	memtx_read_view_detach(this);
 	memtx_tree_destroy(&tree);
 	free(build_array);
 }
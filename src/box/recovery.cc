@@ -39,6 +39,10 @@
 #include "cluster.h"
 #include "session.h"
 
+#if defined(HAVE_INOTIFY_INIT1)
+#include <sys/inotify.h>
+#endif /* defined(HAVE_INOTIFY_INIT1) */
+
 /*
  * Recovery subsystem
  * ------------------
@@ -200,6 +204,32 @@ recovery_exit(struct recovery *r)
 	recovery_delete(r);
 }
 
+/**
+ * Apply a row read from the WAL, unless it has been
+ * applied already.
+ */
+static void
+recover_row(struct recovery *r, struct xstream *stream,
+	    struct xrow_header *row, uint64_t *row_count)
+{
+	int64_t current_lsn = vclock_get(&r->vclock, row->server_id);
+	if (row->lsn <= current_lsn)
+		return; /* already applied, skip */
+
+	try {
+		xstream_write(stream, row);
+		++*row_count;
+		if (*row_count % 100000 == 0)
+			say_info("%.1fM rows processed",
+				 *row_count / 1000000.);
+	} catch (ClientError *e) {
+		say_error("can't apply row: ");
+		e->log();
+		if (r->wal_dir.panic_if_error)
+			throw;
+	}
+}
+
 /**
  * Read all rows in a file starting from the last position.
  * Advance the position. If end of file is reached,
@@ -213,6 +243,22 @@ recover_xlog(struct recovery *r, struct xstream *stream,
 {
 	struct xrow_header row;
 	uint64_t row_count = 0;
+	if (r->read_ahead && stop_vclock == NULL &&
+	    !r->cursor.is_opened) {
+		/*
+		 * Read and decompress the next chunk of the file
+		 * in a coeio thread while applying the rows of
+		 * the current one, then let the cursor handle
+		 * whatever is left.
+		 */
+		struct xlog_prefetch prefetch;
+		xlog_prefetch_create(&prefetch, &r->cursor);
+		auto guard = make_scoped_guard([&]{
+			xlog_prefetch_destroy(&prefetch);
+		});
+		while (xlog_prefetch_next_row(&prefetch, &row) == 0)
+			recover_row(r, stream, &row, &row_count);
+	}
 	while (xlog_cursor_next_xc(&r->cursor, &row,
 				   r->wal_dir.panic_if_error) == 0) {
 		/*
@@ -226,22 +272,7 @@ recover_xlog(struct recovery *r, struct xstream *stream,
 		if (stop_vclock != NULL &&
 		    r->vclock.signature >= stop_vclock->signature)
 			return;
-		int64_t current_lsn = vclock_get(&r->vclock, row.server_id);
-		if (row.lsn <= current_lsn)
-			continue; /* already applied, skip */
-
-		try {
-			xstream_write(stream, &row);
-			++row_count;
-			if (row_count % 100000 == 0)
-				say_info("%.1fM rows processed",
-					 row_count / 1000000.);
-		} catch (ClientError *e) {
-			say_error("can't apply row: ");
-			e->log();
-			if (r->wal_dir.panic_if_error)
-				throw;
-		}
+		recover_row(r, stream, &row, &row_count);
 	}
 }
 
@@ -376,6 +407,11 @@ recovery_finalize(struct recovery *r, struct xstream *stream)
  * In the latter mode either a change to the WAL dir itself or a change
  * in the XLOG file triggers a wakeup. The WAL dir path is set in
  * constructor. XLOG file path is set via .set_log_path().
+ *
+ * Where available, fs events are received from inotify directly:
+ * ev_stat only reports a change if stat data differs, and misses
+ * changes made within the same second, e.g. creation and rename of
+ * a new WAL, until the next WAL dir rescan.
  */
 class WalSubscription {
 public:
@@ -385,6 +421,11 @@ public:
 	struct ev_stat file_stat;
 	struct ev_async async;
 	struct wal_watcher watcher;
+	/** inotify instance, or -1 if ev_stat is used. */
+	int inotify_fd;
+	struct ev_io inotify_io;
+	/** inotify watch of the XLOG file, or -1. */
+	int file_wd;
 	char dir_path[PATH_MAX];
 	char file_path[PATH_MAX];
 
@@ -398,6 +439,42 @@ public:
 		((WalSubscription *)async->data)->wakeup();
 	}
 
+#if defined(HAVE_INOTIFY_INIT1)
+	static void inotify_cb(struct ev_loop *, struct ev_io *io, int)
+	{
+		char buf[4096];
+		/* Drain the queue, one wakeup is enough for all events. */
+		while (read(io->fd, buf, sizeof(buf)) > 0)
+			;
+		((WalSubscription *)io->data)->wakeup();
+	}
+
+	bool start_inotify()
+	{
+		inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotify_fd < 0)
+			return false;
+		/* A new WAL appears in the dir or an old one is removed. */
+		if (inotify_add_watch(inotify_fd, dir_path,
+				      IN_CREATE | IN_MOVED_TO | IN_DELETE |
+				      IN_MOVED_FROM) < 0) {
+			say_syserror("inotify_add_watch, [%s]", dir_path);
+			close(inotify_fd);
+			inotify_fd = -1;
+			return false;
+		}
+		ev_io_init(&inotify_io, inotify_cb, inotify_fd, EV_READ);
+		inotify_io.data = this;
+		ev_io_start(loop(), &inotify_io);
+		return true;
+	}
+#else
+	bool start_inotify()
+	{
+		return false;
+	}
+#endif /* defined(HAVE_INOTIFY_INIT1) */
+
 	void wakeup()
 	{
 		signaled = true;
@@ -409,6 +486,8 @@ public:
 	{
 		f = fiber();
 		signaled = false;
+		inotify_fd = -1;
+		file_wd = -1;
 		if ((size_t)snprintf(dir_path, sizeof(dir_path), "%s", wal_dir) >=
 				sizeof(dir_path)) {
 
@@ -426,6 +505,8 @@ public:
 		if (wal_set_watcher(wal, &watcher, &async) == -1) {
 			/* Fallback to fs events. */
 			ev_async_stop(loop(), &async);
+			if (start_inotify())
+				return;
 			ev_stat_set(&dir_stat, dir_path, 0.0);
 			ev_stat_start(loop(), &dir_stat);
 		}
@@ -433,6 +514,11 @@ public:
 
 	~WalSubscription()
 	{
+		if (inotify_fd >= 0) {
+			ev_io_stop(loop(), &inotify_io);
+			/* Closing the instance removes all its watches. */
+			close(inotify_fd);
+		}
 		ev_stat_stop(loop(), &file_stat);
 		ev_stat_stop(loop(), &dir_stat);
 		wal_clear_watcher(wal, &watcher);
@@ -448,6 +534,10 @@ public:
 			 */
 			return;
 		}
+		if (inotify_fd >= 0) {
+			set_log_path_inotify(path);
+			return;
+		}
 
 		/*
 		 * Avoid toggling ev_stat if the path didn't change.
@@ -472,6 +562,41 @@ public:
 		ev_stat_set(&file_stat, file_path, 0.0);
 		ev_stat_start(loop(), &file_stat);
 	}
+
+	void set_log_path_inotify(const char *path)
+	{
+#if defined(HAVE_INOTIFY_INIT1)
+		/* Note: .file_path valid iff file_wd is set. */
+		if (path && file_wd >= 0 && strcmp(file_path, path) == 0)
+			return;
+
+		if (file_wd >= 0) {
+			inotify_rm_watch(inotify_fd, file_wd);
+			file_wd = -1;
+		}
+
+		if (path == NULL)
+			return;
+
+		if ((size_t)snprintf(file_path, sizeof(file_path), "%s", path) >=
+				sizeof(file_path)) {
+
+			panic("path too long: %s", path);
+		}
+		file_wd = inotify_add_watch(inotify_fd, file_path,
+					    IN_MODIFY | IN_CLOSE_WRITE);
+		if (file_wd < 0)
+			say_syserror("inotify_add_watch, [%s]", file_path);
+		/*
+		 * Rows could have been appended before the watch
+		 * was added, have another look at the file.
+		 */
+		signaled = true;
+#else
+		(void) path;
+		unreachable();
+#endif /* defined(HAVE_INOTIFY_INIT1) */
+	}
 };
 
 static int
@@ -542,7 +667,11 @@ recovery_follow_local(struct recovery *r, struct xstream *stream,
 	 * Blocks until finished.
 	 */
 	xdir_scan_xc(&r->wal_dir);
-	recover_remaining_wals(r, stream, NULL);
+	r->read_ahead = true;
+	{
+		auto guard = make_scoped_guard([=]{ r->read_ahead = false; });
+		recover_remaining_wals(r, stream, NULL);
+	}
 	/*
 	 * Start 'hot_standby' background fiber to follow xlog changes.
 	 * It will pick up from the position of the currently open
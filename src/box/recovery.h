@@ -60,6 +60,13 @@ struct recovery {
 	 */
 	struct fiber *watcher;
 	uint32_t server_id;
+	/**
+	 * Read and decode WAL rows ahead in a coeio thread.
+	 * Set while catching up with the existing WALs, but
+	 * not while following the tail of the WAL being
+	 * written, where there's little to read ahead.
+	 */
+	bool read_ahead;
 };
 
 struct recovery *
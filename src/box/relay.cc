@@ -44,6 +44,7 @@
 #include "trigger.h"
 #include "errinj.h"
 #include "xrow_io.h"
+#include "clock.h"
 
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row);
@@ -65,7 +66,8 @@ relay_create(struct relay *relay, int fd, uint64_t sync,
 static inline void
 relay_destroy(struct relay *relay)
 {
-	(void) relay;
+	if (relay->zdctx != NULL)
+		ZSTD_freeDStream(relay->zdctx);
 }
 
 static inline void
@@ -81,10 +83,15 @@ relay_set_cord_name(int fd)
 }
 
 void
-relay_initial_join(int fd, uint64_t sync)
+relay_initial_join(int fd, uint64_t sync, bool xlog_tx_chunks)
 {
 	struct relay relay;
 	relay_create(&relay, fd, sync, relay_send_initial_join_row);
+	relay.xlog_tx_chunks = xlog_tx_chunks;
+	/* Megabytes per second, as snap_io_rate_limit */
+	relay.join_rate_limit =
+		cfg_getd("replication_join_rate_limit") * 1024 * 1024;
+	relay.join_start = clock_monotonic();
 	auto scope_guard = make_scoped_guard([&]{
 		relay_destroy(&relay);
 	});
@@ -243,11 +250,52 @@ relay_send(struct relay *relay, struct xrow_header *packet)
 	fiber_gc();
 }
 
+/**
+ * Sleep if the initial join goes faster than
+ * replication_join_rate_limit allows.
+ */
+static void
+relay_join_throttle(struct relay *relay, struct xrow_header *row)
+{
+	if (relay->join_rate_limit <= 0)
+		return;
+	for (int i = 0; i < row->bodycnt; i++)
+		relay->join_bytes += row->body[i].iov_len;
+	double elapsed = clock_monotonic() - relay->join_start;
+	double expected = relay->join_bytes / relay->join_rate_limit;
+	if (expected > elapsed)
+		fiber_sleep(expected - elapsed);
+}
+
+/**
+ * A replica which doesn't support IPROTO_XLOG_TX gets the
+ * chunk row by row.
+ */
+static void
+relay_unpack_xlog_tx(struct relay *relay, struct xrow_header *row)
+{
+	if (relay->zdctx == NULL) {
+		relay->zdctx = ZSTD_createDStream();
+		if (relay->zdctx == NULL) {
+			tnt_raise(ClientError, ER_DECOMPRESSION,
+				  "failed to create context");
+		}
+	}
+	/* See memtx_join_send_chunk() for the layout */
+	assert(row->bodycnt == 2);
+	const char *data = (const char *) row->body[1].iov_base;
+	const char *data_end = data + row->body[1].iov_len;
+	xlog_tx_chunk_write_xc(data, data_end, relay->zdctx, &relay->stream);
+}
+
 static void
 relay_send_initial_join_row(struct xstream *stream, struct xrow_header *row)
 {
 	struct relay *relay = container_of(stream, struct relay, stream);
+	if (row->type == IPROTO_XLOG_TX && !relay->xlog_tx_chunks)
+		return relay_unpack_xlog_tx(relay, row);
 	relay_send(relay, row);
+	relay_join_throttle(relay, row);
 	ERROR_INJECT(ERRINJ_RELAY,
 	{
 		fiber_sleep(1000.0);
@@ -34,6 +34,7 @@
 #include "fiber.h"
 #include "vclock.h"
 #include "xstream.h"
+#include "xlog.h"
 
 struct server;
 struct tt_uuid;
@@ -50,6 +51,15 @@ struct relay {
 	struct xstream stream;
 	struct vclock stop_vclock;
 	ev_tstamp wal_dir_rescan_delay;
+	/** True if the replica accepts IPROTO_XLOG_TX chunks. */
+	bool xlog_tx_chunks;
+	/** Used to unpack IPROTO_XLOG_TX for older replicas. */
+	ZSTD_DStream *zdctx;
+	/** Initial join bandwidth limit, bytes/sec, 0 if none. */
+	double join_rate_limit;
+	/** Bytes sent and start time, to enforce the limit. */
+	uint64_t join_bytes;
+	double join_start;
 };
 
 /**
@@ -57,9 +67,11 @@ struct relay {
  *
  * @param fd        client connection
  * @param sync      sync from incoming JOIN request
+ * @param xlog_tx_chunks true if the replica accepts snapshot
+ *                  data as IPROTO_XLOG_TX chunks
  */
 void
-relay_initial_join(int fd, uint64_t sync);
+relay_initial_join(int fd, uint64_t sync, bool xlog_tx_chunks);
 
 /**
  * Send final JOIN rows to the replica.
@@ -121,6 +121,12 @@ space_new(struct space_def *def, struct rlist *key_list)
 	space->has_unique_secondary_key = has_unique_secondary_key;
 	tuple_format_ref(space->format, 1);
 	space->format->exact_field_count = def->exact_field_count;
+	if (def->opts.compress_threshold > 0) {
+		space->format->compression =
+			tuple_compression_new(def->opts.compress_threshold);
+		if (space->format->compression == NULL)
+			diag_raise();
+	}
 	space->index_id_max = index_id_max;
 	/* init space engine instance */
 	Engine *engine = engine_find(def->engine_name);
@@ -86,9 +86,15 @@ tuple_validate_raw(struct tuple_format *format, const char *tuple)
 
 	/* Check field types */
 	for (uint32_t i = 0; i < format->field_count; i++) {
-		if (key_mp_type_validate(format->fields[i].type,
-					 mp_typeof(*tuple), ER_FIELD_TYPE,
-					 i + TUPLE_INDEX_BASE))
+		const struct tuple_field_format *field = &format->fields[i];
+		if (field->gap_length > 0) {
+			/* Fields of any type, skip them at once. */
+			tuple = mp_skip(tuple, field->gap_length);
+			i += field->gap_length - 1;
+			continue;
+		}
+		if (key_mp_type_validate(field->type, mp_typeof(*tuple),
+					 ER_FIELD_TYPE, i + TUPLE_INDEX_BASE))
 			return -1;
 		mp_next(&tuple);
 	}
@@ -152,6 +158,7 @@ tuple_alloc(struct tuple_format *format, size_t size)
 	tuple->refs = 0;
 	tuple->version = snapshot_version;
 	tuple->size = size;
+	tuple->is_compressed = 0;
 	tuple->format_id = tuple_format_id(format);
 	tuple_format_ref(format, 1);
 
@@ -172,6 +179,8 @@ tuple_delete(struct tuple *tuple)
 	size_t total = sizeof(struct tuple) + tuple->size +
 		       format->field_map_size;
 	char *ptr = (char *) tuple - format->field_map_size;
+	if (tuple->is_compressed)
+		tuple_unpacked_drop(tuple);
 	tuple_format_ref(format, -1);
 	if (!memtx_alloc.is_delayed_free_mode || tuple->version == snapshot_version)
 		smfree(&memtx_alloc, ptr, total);
@@ -188,10 +197,33 @@ tuple_ref_exception()
 	tnt_raise(ClientError, ER_TUPLE_REF_OVERFLOW);
 }
 
+/**
+ * Decompressed data of a compressed tuple may be dropped
+ * and decompressed again to another place between two
+ * iterator calls, so move the iterator after it.
+ */
+static inline void
+tuple_iterator_rebase(struct tuple_iterator *it)
+{
+	if (likely(!it->tuple->is_compressed))
+		return;
+	uint32_t bsize;
+	const char *data = tuple_data_range(it->tuple, &bsize);
+	const char *old_data = it->end - bsize;
+	if (data != old_data) {
+		it->pos = data + (it->pos - old_data);
+		it->end = data + bsize;
+	}
+}
+
 const char *
 tuple_seek(struct tuple_iterator *it, uint32_t fieldno)
 {
-	const char *field = tuple_field(it->tuple, fieldno);
+	tuple_iterator_rebase(it);
+	struct tuple *tuple = it->tuple;
+	const char *field = tuple_field_raw(tuple_format(tuple),
+					    tuple_data(tuple),
+					    tuple_field_map(tuple), fieldno);
 	if (likely(field != NULL)) {
 		it->pos = field;
 		it->fieldno = fieldno;
@@ -206,6 +238,7 @@ tuple_seek(struct tuple_iterator *it, uint32_t fieldno)
 const char *
 tuple_next(struct tuple_iterator *it)
 {
+	tuple_iterator_rebase(it);
 	if (it->pos < it->end) {
 		const char *field = it->pos;
 		mp_next(&it->pos);
@@ -260,7 +293,7 @@ tuple_extract_key(const struct tuple *tuple, const struct key_def *key_def,
 		  uint32_t *key_size)
 {
 	uint32_t bsize;
-	const char *data = tuple_data_range(tuple, &bsize);
+	const char *data = tuple_key_data_range(tuple, &bsize);
 	return tuple_extract_key_raw(data, data + bsize, key_def, key_size);
 }
 
@@ -343,17 +376,56 @@ tuple_upsert(struct tuple_format *format,
 	return ret;
 }
 
+/**
+ * Create a compressed tuple.
+ * @param[out] p_tuple the new tuple, or NULL if the data is
+ *                     not worth compressing
+ * @retval 0 success
+ * @retval -1 out of memory, diag is set
+ */
+static int
+tuple_new_compressed(struct tuple_format *format, const char *data,
+		     const char *end, struct tuple **p_tuple)
+{
+	*p_tuple = NULL;
+	struct tuple_ztrailer trailer;
+	const char *zdata;
+	size_t zsize = tuple_compress(format, data, end, &trailer, &zdata);
+	if (zsize == 0)
+		return 0;
+	struct tuple *tuple = tuple_alloc(format, trailer.prefix_size +
+					  zsize + sizeof(trailer));
+	if (tuple == NULL)
+		return -1;
+	char *pos = tuple->raw;
+	memcpy(pos, data, trailer.prefix_size);
+	pos += trailer.prefix_size;
+	memcpy(pos, zdata, zsize);
+	pos += zsize;
+	memcpy(pos, &trailer, sizeof(trailer));
+	tuple->is_compressed = 1;
+	*p_tuple = tuple;
+	return 0;
+}
+
 struct tuple *
 tuple_new(struct tuple_format *format, const char *data, const char *end)
 {
 	size_t tuple_len = end - data;
 	assert(mp_typeof(*data) == MP_ARRAY);
-	struct tuple *new_tuple = tuple_alloc(format, tuple_len);
-	if (new_tuple == NULL)
+	struct tuple *new_tuple = NULL;
+	if (format->compression != NULL &&
+	    tuple_len >= format->compression->threshold &&
+	    tuple_new_compressed(format, data, end, &new_tuple) != 0)
 		return NULL;
-	memcpy(new_tuple->raw, data, tuple_len);
-	if (tuple_init_field_map(format, (uint32_t *) new_tuple,
-				 tuple_data(new_tuple))) {
+	if (new_tuple == NULL) {
+		new_tuple = tuple_alloc(format, tuple_len);
+		if (new_tuple == NULL)
+			return NULL;
+		memcpy(new_tuple->raw, data, tuple_len);
+	}
+	/* The field map is built on the original data. */
+	if (tuple_init_field_map(format, (uint32_t *) new_tuple, data)) {
 		tuple_delete(new_tuple);
 		return NULL;
 	}
@@ -362,9 +434,11 @@ tuple_new(struct tuple_format *format, const char *data, const char *end)
 
 void
 tuple_init(float tuple_arena_max_size, uint32_t objsize_min,
-	   uint32_t objsize_max, float alloc_factor)
+	   uint32_t objsize_max, float alloc_factor,
+	   enum memtx_huge_pages huge_pages, uint64_t numa_nodes)
 {
 	tuple_format_init();
+	tuple_compression_init();
 
 	/* Apply lowest allowed objsize bounds */
 	if (objsize_min < OBJSIZE_MIN)
@@ -376,6 +450,15 @@ tuple_init(float tuple_arena_max_size, uint32_t objsize_min,
 	size_t slab_size = small_round(objsize_max * 4);
 	if (slab_size < SLAB_SIZE_MIN)
 		slab_size = SLAB_SIZE_MIN;
+	if (huge_pages == MEMTX_HUGE_PAGES_EXPLICIT) {
+		/*
+		 * hugetlbfs mappings can only be trimmed at
+		 * huge page boundaries.
+		 */
+		size_t huge_page_size = memtx_huge_page_size();
+		if (slab_size < huge_page_size)
+			slab_size = huge_page_size;
+	}
 
 	/*
 	 * Ensure that quota is a multiple of slab_size, to
@@ -388,8 +471,18 @@ tuple_init(float tuple_arena_max_size, uint32_t objsize_min,
 
 	say_info("mapping %zu bytes for tuple arena...", prealloc);
 
-	if (slab_arena_create(&memtx_arena, &memtx_quota,
-			      prealloc, slab_size, MAP_PRIVATE)) {
+	int rc = slab_arena_create(&memtx_arena, &memtx_quota, prealloc,
+				   slab_size,
+				   memtx_arena_mmap_flags(huge_pages));
+	if (rc != 0 && huge_pages == MEMTX_HUGE_PAGES_EXPLICIT &&
+	    errno == ENOMEM) {
+		say_warn("not enough reserved huge pages for tuple arena, "
+			 "falling back to transparent huge pages");
+		huge_pages = MEMTX_HUGE_PAGES_TRANSPARENT;
+		rc = slab_arena_create(&memtx_arena, &memtx_quota, prealloc,
+				       slab_size, MAP_PRIVATE);
+	}
+	if (rc != 0) {
 		if (ENOMEM == errno) {
 			panic("failed to preallocate %zu bytes: "
 			      "Cannot allocate memory, check option "
@@ -400,6 +493,12 @@ tuple_init(float tuple_arena_max_size, uint32_t objsize_min,
 				       prealloc);
 		}
 	}
+	/*
+	 * Index extents are allocated from the same arena,
+	 * so the policy applies to them as well.
+	 */
+	memtx_arena_set_policy(memtx_arena.arena, memtx_arena.prealloc,
+			       huge_pages, numa_nodes);
 	slab_cache_create(&memtx_slab_cache, &memtx_arena);
 	small_alloc_create(&memtx_alloc, &memtx_slab_cache,
 			   objsize_min, alloc_factor);
@@ -420,20 +519,33 @@ tuple_free()
 
 	mempool_destroy(&tuple_iterator_pool);
 
+	tuple_compression_free();
 	tuple_format_free();
 }
 
+/**
+ * The number of consistent read views (a checkpoint or
+ * box.read_view()) currently open. Tuple memory stays in the
+ * delayed free mode until the last of them is closed.
+ */
+static int snapshot_count;
+
 void
 tuple_begin_snapshot()
 {
 	snapshot_version++;
-	small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, true);
+	if (snapshot_count++ == 0)
+		small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, true);
+	tuple_compression_begin_snapshot();
 }
 
 void
 tuple_end_snapshot()
 {
-	small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, false);
+	assert(snapshot_count > 0);
+	if (--snapshot_count == 0)
+		small_alloc_setopt(&memtx_alloc, SMALL_DELAYED_FREE_MODE, false);
+	tuple_compression_end_snapshot();
 }
 
 box_tuple_format_t *
@@ -482,14 +594,18 @@ size_t
 box_tuple_bsize(const box_tuple_t *tuple)
 {
 	assert(tuple != NULL);
-	return tuple->size;
+	return tuple_bsize(tuple);
 }
 
 ssize_t
 box_tuple_to_buf(const box_tuple_t *tuple, char *buf, size_t size)
 {
 	assert(tuple != NULL);
-	return tuple_to_buf(tuple, buf, size);
+	try {
+		return tuple_to_buf(tuple, buf, size);
+	} catch (Exception *e) {
+		return -1;
+	}
 }
 
 box_tuple_format_t *
@@ -503,7 +619,11 @@ const char *
 box_tuple_field(const box_tuple_t *tuple, uint32_t fieldno)
 {
 	assert(tuple != NULL);
-	return tuple_field(tuple, fieldno);
+	try {
+		return tuple_field(tuple, fieldno);
+	} catch (Exception *e) {
+		return NULL;
+	}
 }
 
 typedef struct tuple_iterator box_tuple_iterator_t;
@@ -519,8 +639,13 @@ box_tuple_iterator(box_tuple_t *tuple)
 	} catch (Exception *e) {
 		return NULL;
 	}
+	try {
+		tuple_rewind(it, tuple);
+	} catch (Exception *e) {
+		mempool_free(&tuple_iterator_pool, it);
+		return NULL;
+	}
 	tuple_ref(tuple);
-	tuple_rewind(it, tuple);
 	return it;
 }
 
@@ -540,19 +665,32 @@ box_tuple_position(box_tuple_iterator_t *it)
 void
 box_tuple_rewind(box_tuple_iterator_t *it)
 {
-	tuple_rewind(it, it->tuple);
+	try {
+		tuple_rewind(it, it->tuple);
+	} catch (Exception *e) {
+		/* Leave the iterator at the end, diag is set. */
+		it->pos = it->end;
+	}
 }
 
 const char *
 box_tuple_seek(box_tuple_iterator_t *it, uint32_t fieldno)
 {
-	return tuple_seek(it, fieldno);
+	try {
+		return tuple_seek(it, fieldno);
+	} catch (Exception *e) {
+		return NULL;
+	}
 }
 
 const char *
 box_tuple_next(box_tuple_iterator_t *it)
 {
-	return tuple_next(it);
+	try {
+		return tuple_next(it);
+	} catch (Exception *e) {
+		return NULL;
+	}
 }
 
 box_tuple_t *
@@ -31,8 +31,10 @@
  * SUCH DAMAGE.
  */
 #include "trivia/util.h"
+#include "diag.h"
 
 #include "tuple_format.h"
+#include "tuple_compression.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -274,11 +276,25 @@ struct PACKED tuple
 	/** format identifier */
 	uint16_t format_id;
 	/** length of the variable part of the tuple */
-	uint32_t size;
+	uint32_t size:31;
+	/**
+	 * The tuple data is compressed and ends with
+	 * struct tuple_ztrailer, see tuple_compression.h.
+	 */
+	uint32_t is_compressed:1;
 	/** MessagePack array data */
 	char raw[0];
 };
 
+/** Trailer of a compressed tuple. */
+inline struct tuple_ztrailer *
+tuple_ztrailer(const struct tuple *tuple)
+{
+	assert(tuple->is_compressed);
+	return (struct tuple_ztrailer *) (tuple->raw + tuple->size -
+					  sizeof(struct tuple_ztrailer));
+}
+
 /**
  * Get pointer to MessagePack data of the tuple.
  * @param tuple tuple.
@@ -287,9 +303,27 @@ struct PACKED tuple
 inline const char *
 tuple_data(const struct tuple *tuple)
 {
+	if (unlikely(tuple->is_compressed)) {
+		const char *data = tuple_unpack_cached(tuple);
+		if (data == NULL)
+			diag_raise();
+		return data;
+	}
 	return tuple->raw;
 }
 
+/**
+ * Size of MessagePack data of the tuple.
+ * @param tuple tuple.
+ */
+inline uint32_t
+tuple_bsize(const struct tuple *tuple)
+{
+	if (unlikely(tuple->is_compressed))
+		return tuple_ztrailer(tuple)->bsize;
+	return tuple->size;
+}
+
 /**
  * Get pointer to MessagePack data of the tuple.
  * @param tuple tuple.
@@ -299,7 +333,37 @@ tuple_data(const struct tuple *tuple)
 inline const char *
 tuple_data_range(const struct tuple *tuple, uint32_t *p_size)
 {
-	*p_size = tuple->size;
+	*p_size = tuple_bsize(tuple);
+	return tuple_data(tuple);
+}
+
+/**
+ * Get pointer to MessagePack data of the tuple which is
+ * enough to access the fields covered by the tuple format.
+ * Unlike tuple_data(), never decompresses the tuple.
+ * @param tuple tuple.
+ * @return MessagePack array, possibly truncated.
+ */
+inline const char *
+tuple_key_data(const struct tuple *tuple)
+{
+	return tuple->raw;
+}
+
+/**
+ * Get pointer to MessagePack data of the tuple which is
+ * enough to access the fields covered by the tuple format.
+ * @param tuple tuple.
+ * @param[out] size Size in bytes of the returned data.
+ * @return MessagePack array, possibly truncated.
+ */
+inline const char *
+tuple_key_data_range(const struct tuple *tuple, uint32_t *p_size)
+{
+	if (unlikely(tuple->is_compressed))
+		*p_size = tuple_ztrailer(tuple)->prefix_size;
+	else
+		*p_size = tuple->size;
 	return tuple->raw;
 }
 
@@ -436,7 +500,7 @@ tuple_field_map(const struct tuple *tuple)
 inline uint32_t
 tuple_field_count(const struct tuple *tuple)
 {
-	const char *data = tuple_data(tuple);
+	const char *data = tuple_key_data(tuple);
 	return mp_decode_array(&data);
 }
 
@@ -451,8 +515,10 @@ tuple_field_count(const struct tuple *tuple)
 inline const char *
 tuple_field(const struct tuple *tuple, uint32_t fieldno)
 {
-	return tuple_field_raw(tuple_format(tuple), tuple_data(tuple),
-			       tuple_field_map(tuple), fieldno);
+	struct tuple_format *format = tuple_format(tuple);
+	const char *data = fieldno < format->field_count ?
+			   tuple_key_data(tuple) : tuple_data(tuple);
+	return tuple_field_raw(format, data, tuple_field_map(tuple), fieldno);
 }
 
 /**
@@ -547,6 +613,7 @@ box_tuple_field_u32(box_tuple_t *tuple, uint32_t fieldno, uint32_t deflt)
 } /* extern "C" */
 
 #include "tuple_update.h"
+#include "memtx_arena.h"
 #include "errinj.h"
 
 enum { TUPLE_REF_MAX = UINT16_MAX };
@@ -735,10 +802,16 @@ tuple_to_obuf(struct tuple *tuple, struct obuf *buf);
 ssize_t
 tuple_to_buf(const struct tuple *tuple, char *buf, size_t size);
 
-/** Initialize tuple library */
+/**
+ * Initialize tuple library
+ * @param huge_pages page size policy of the arena
+ * @param numa_nodes a mask of NUMA nodes to bind the arena
+ *        to, 0 for the default policy
+ */
 void
 tuple_init(float alloc_arena_max_size, uint32_t slab_alloc_minimal,
-	   uint32_t slab_alloc_maximal, float alloc_factor);
+	   uint32_t slab_alloc_maximal, float alloc_factor,
+	   enum memtx_huge_pages huge_pages, uint64_t numa_nodes);
 
 /** Cleanup tuple library */
 void
@@ -265,10 +265,10 @@ tuple_compare_default(const struct tuple *tuple_a, const struct tuple *tuple_b,
 		      const struct key_def *key_def)
 {
 	return tuple_compare_default_raw(tuple_format(tuple_a),
-					 tuple_data(tuple_a),
+					 tuple_key_data(tuple_a),
 					 tuple_field_map(tuple_a),
 					 tuple_format(tuple_b),
-					 tuple_data(tuple_b),
+					 tuple_key_data(tuple_b),
 					 tuple_field_map(tuple_b), key_def);
 }
 
@@ -335,7 +335,7 @@ tuple_compare_with_key_default(const struct tuple *tuple, const char *key,
 			       const struct key_def *key_def)
 {
 	return tuple_compare_with_key_default_raw(tuple_format(tuple),
-						  tuple_data(tuple),
+						  tuple_key_data(tuple),
 						  tuple_field_map(tuple), key,
 						  part_count, key_def);
 }
@@ -371,6 +371,27 @@ field_compare<FIELD_TYPE_STRING>(const char **field_a, const char **field_b)
 	return r;
 }
 
+template <>
+inline int
+field_compare<FIELD_TYPE_INTEGER>(const char **field_a, const char **field_b)
+{
+	return mp_compare_integer(*field_a, *field_b);
+}
+
+template <>
+inline int
+field_compare<FIELD_TYPE_NUMBER>(const char **field_a, const char **field_b)
+{
+	return mp_compare_number(*field_a, *field_b);
+}
+
+template <>
+inline int
+field_compare<FIELD_TYPE_SCALAR>(const char **field_a, const char **field_b)
+{
+	return mp_compare_scalar(*field_a, *field_b);
+}
+
 template <int TYPE>
 static inline int
 field_compare_and_next(const char **field_a, const char **field_b);
@@ -402,6 +423,39 @@ field_compare_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+					   const char **field_b)
+{
+	int r = mp_compare_integer(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_NUMBER>(const char **field_a,
+					  const char **field_b)
+{
+	int r = mp_compare_number(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_and_next<FIELD_TYPE_SCALAR>(const char **field_a,
+					  const char **field_b)
+{
+	int r = mp_compare_scalar(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple comparator */
 namespace /* local symbols */ {
 
@@ -429,10 +483,12 @@ struct FieldCompare<IDX, TYPE, IDX2, TYPE2, MORE_TYPES...>
 		} else {
 			if ((r = field_compare<TYPE>(&field_a, &field_b)) != 0)
 				return r;
-			field_a = tuple_field_raw(format_a, tuple_data(tuple_a),
+			field_a = tuple_field_raw(format_a,
+						  tuple_key_data(tuple_a),
 						  tuple_field_map(tuple_a),
 						  IDX2);
-			field_b = tuple_field_raw(format_b, tuple_data(tuple_b),
+			field_b = tuple_field_raw(format_b,
+						  tuple_key_data(tuple_b),
 						  tuple_field_map(tuple_b),
 						  IDX2);
 		}
@@ -469,9 +525,9 @@ struct TupleCompare
 		struct tuple_format *format_a = tuple_format(tuple_a);
 		struct tuple_format *format_b = tuple_format(tuple_b);
 		const char *field_a, *field_b;
-		field_a = tuple_field_raw(format_a, tuple_data(tuple_a),
+		field_a = tuple_field_raw(format_a, tuple_key_data(tuple_a),
 					  tuple_field_map(tuple_a), IDX);
-		field_b = tuple_field_raw(format_b, tuple_data(tuple_b),
+		field_b = tuple_field_raw(format_b, tuple_key_data(tuple_b),
 					  tuple_field_map(tuple_b), IDX);
 		return FieldCompare<IDX, TYPE, MORE_TYPES...>::
 			compare(tuple_a, tuple_b, format_a,
@@ -487,8 +543,8 @@ struct TupleCompare<0, TYPE, MORE_TYPES...> {
 	{
 		struct tuple_format *format_a = tuple_format(tuple_a);
 		struct tuple_format *format_b = tuple_format(tuple_b);
-		const char *field_a = tuple_data(tuple_a);
-		const char *field_b = tuple_data(tuple_b);
+		const char *field_a = tuple_key_data(tuple_a);
+		const char *field_b = tuple_key_data(tuple_b);
 		mp_decode_array(&field_a);
 		mp_decode_array(&field_b);
 		return FieldCompare<0, TYPE, MORE_TYPES...>::compare(tuple_a, tuple_b,
@@ -510,18 +566,94 @@ struct comparator_signature {
 static const comparator_signature cmp_arr[] = {
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_SCALAR)
+
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_NUMBER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_SCALAR)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_SCALAR)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_SCALAR)
+	COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_SCALAR)
+	COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_SCALAR)
+
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
 	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+	COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+
+	/*
+	 * A key on field 1 merged with a primary key on field 0,
+	 * as vinyl builds for its secondary indexes (key_def_merge).
+	 */
+	COMPARATOR(1, FIELD_TYPE_UNSIGNED, 0, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(1, FIELD_TYPE_STRING  , 0, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(1, FIELD_TYPE_INTEGER , 0, FIELD_TYPE_UNSIGNED)
+	COMPARATOR(1, FIELD_TYPE_UNSIGNED, 0, FIELD_TYPE_STRING)
+	COMPARATOR(1, FIELD_TYPE_STRING  , 0, FIELD_TYPE_STRING)
+	COMPARATOR(1, FIELD_TYPE_INTEGER , 0, FIELD_TYPE_STRING)
+	COMPARATOR(1, FIELD_TYPE_UNSIGNED, 0, FIELD_TYPE_INTEGER)
+	COMPARATOR(1, FIELD_TYPE_STRING  , 0, FIELD_TYPE_INTEGER)
+	COMPARATOR(1, FIELD_TYPE_INTEGER , 0, FIELD_TYPE_INTEGER)
 };
 
 #undef COMPARATOR
@@ -567,6 +699,27 @@ field_compare_with_key<FIELD_TYPE_STRING>(const char **field, const char **key)
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_INTEGER>(const char **field, const char **key)
+{
+	return mp_compare_integer(*field, *key);
+}
+
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_NUMBER>(const char **field, const char **key)
+{
+	return mp_compare_number(*field, *key);
+}
+
+template <>
+inline int
+field_compare_with_key<FIELD_TYPE_SCALAR>(const char **field, const char **key)
+{
+	return mp_compare_scalar(*field, *key);
+}
+
 template <int TYPE>
 static inline int
 field_compare_with_key_and_next(const char **field_a, const char **field_b);
@@ -598,6 +751,39 @@ field_compare_with_key_and_next<FIELD_TYPE_STRING>(const char **field_a,
 	return r;
 }
 
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_INTEGER>(const char **field_a,
+						    const char **field_b)
+{
+	int r = mp_compare_integer(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_NUMBER>(const char **field_a,
+						   const char **field_b)
+{
+	int r = mp_compare_number(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
+template <>
+inline int
+field_compare_with_key_and_next<FIELD_TYPE_SCALAR>(const char **field_a,
+						   const char **field_b)
+{
+	int r = mp_compare_scalar(*field_a, *field_b);
+	mp_next(field_a);
+	mp_next(field_b);
+	return r;
+}
+
 /* Tuple with key comparator */
 namespace /* local symbols */ {
 
@@ -624,7 +810,8 @@ struct FieldCompareWithKey<FLD_ID, IDX, TYPE, IDX2, TYPE2, MORE_TYPES...>
 			r = field_compare_with_key<TYPE>(&field, &key);
 			if (r || part_count == FLD_ID + 1)
 				return r;
-			field = tuple_field_raw(format, tuple_data(tuple),
+			field = tuple_field_raw(format,
+						tuple_key_data(tuple),
 						tuple_field_map(tuple), IDX2);
 			mp_next(&key);
 		}
@@ -661,7 +848,8 @@ struct TupleCompareWithKey
 		if (part_count == 0)
 			return 0;
 		struct tuple_format *format = tuple_format(tuple);
-		const char *field = tuple_field_raw(format, tuple_data(tuple),
+		const char *field = tuple_field_raw(format,
+						    tuple_key_data(tuple),
 						    tuple_field_map(tuple),
 						    IDX);
 		return FieldCompareWithKey<FLD_ID, IDX, TYPE, MORE_TYPES...>::
@@ -682,7 +870,7 @@ struct TupleCompareWithKey<0, 0, TYPE, MORE_TYPES...>
 		if (part_count == 0)
 			return 0;
 		struct tuple_format *format = tuple_format(tuple);
-		const char *field = tuple_data(tuple);
+		const char *field = tuple_key_data(tuple);
 		mp_decode_array(&field);
 		return FieldCompareWithKey<0, 0, TYPE, MORE_TYPES...>::
 			compare(tuple, key, part_count,
@@ -702,19 +890,96 @@ struct comparator_with_key_signature
 	{ TupleCompareWithKey<0, __VA_ARGS__>::compare, { __VA_ARGS__ } },
 
 static const comparator_with_key_signature cmp_wk_arr[] = {
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED, 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING  , 3, FIELD_TYPE_STRING)
+
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_NUMBER)
+	KEY_COMPARATOR(0, FIELD_TYPE_UNSIGNED, 1, FIELD_TYPE_SCALAR)
+	KEY_COMPARATOR(0, FIELD_TYPE_STRING  , 1, FIELD_TYPE_SCALAR)
+	KEY_COMPARATOR(0, FIELD_TYPE_INTEGER , 1, FIELD_TYPE_SCALAR)
+	KEY_COMPARATOR(0, FIELD_TYPE_NUMBER  , 1, FIELD_TYPE_SCALAR)
+	KEY_COMPARATOR(0, FIELD_TYPE_SCALAR  , 1, FIELD_TYPE_SCALAR)
 
 	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_UNSIGNED)
 	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_STRING)
 	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 2, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 2, FIELD_TYPE_INTEGER)
+
+	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 0, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 0, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 0, FIELD_TYPE_UNSIGNED)
+	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 0, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 0, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 0, FIELD_TYPE_STRING)
+	KEY_COMPARATOR(1, FIELD_TYPE_UNSIGNED, 0, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_STRING  , 0, FIELD_TYPE_INTEGER)
+	KEY_COMPARATOR(1, FIELD_TYPE_INTEGER , 0, FIELD_TYPE_INTEGER)
 };
 
 #undef KEY_COMPARATOR
@@ -0,0 +1,565 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "tuple_compression.h"
+
+#include <zstd.h>
+#include <zdict.h>
+#include <msgpuck.h>
+#include <small/rlist.h>
+
+#include "tuple.h"
+#include "fiber.h"
+#include "coeio.h"
+#include "say.h"
+
+enum {
+	/** zstd compression level, favour speed. */
+	TUPLE_ZSTD_LEVEL = 1,
+	/** Maximal size of a trained dictionary. */
+	TUPLE_DICT_SIZE_MAX = 16 * 1024,
+	/**
+	 * zstd recommends training on about a hundred times
+	 * the dictionary size worth of samples.
+	 */
+	TUPLE_DICT_SAMPLES_SIZE = 100 * TUPLE_DICT_SIZE_MAX,
+	/** Maximal number of samples to train on. */
+	TUPLE_DICT_SAMPLE_COUNT = 4096,
+	/** Only this much of a large tuple makes a sample. */
+	TUPLE_DICT_SAMPLE_SIZE_MAX = 8 * 1024,
+	/** Memory budget of the decompressed data cache. */
+	TUPLE_UNPACKED_CACHE_SIZE = 4 * 1024 * 1024,
+};
+
+/** A compression dictionary trained for a tuple format. */
+struct tuple_dict {
+	ZSTD_CDict *cdict;
+	ZSTD_DDict *ddict;
+	/** Link in tuple_dict_graveyard. */
+	struct rlist in_graveyard;
+};
+
+/** Decompressed data of a compressed tuple. */
+struct tuple_unpacked {
+	/** Link in tuple_unpacked_lru. */
+	struct rlist in_lru;
+	const struct tuple *tuple;
+	/** Size of the entry, including the data. */
+	size_t size;
+	/** Event loop iteration the data was used last at. */
+	unsigned iteration;
+	char data[0];
+};
+
+/*
+ * Decompressed data of tuples, by tuple. It's kept aside
+ * rather than referenced from the tuple trailer, so that the
+ * tuple memory is never written to after the tuple is created:
+ * a snapshot may be reading it at the moment.
+ */
+typedef struct tuple_unpacked *tuple_unpacked_ptr;
+#define mh_name _tuple_unpacked
+#define mh_key_t const struct tuple *
+#define mh_node_t tuple_unpacked_ptr
+#define mh_arg_t void *
+#if UINTPTR_MAX == 0xffffffff
+#define mh_hash_key(a, arg) ((uintptr_t)(a))
+#else
+#define mh_hash_key(a, arg) ((uint32_t)(((uintptr_t)(a)) >> 33 ^ ((uintptr_t)(a)) ^ ((uintptr_t)(a)) << 11))
+#endif
+#define mh_hash(a, arg) mh_hash_key((*(a))->tuple, arg)
+#define mh_cmp(a, b, arg) ((*(a))->tuple != (*(b))->tuple)
+#define mh_cmp_key(a, b, arg) ((a) != (*(b))->tuple)
+#define MH_SOURCE 1
+#include <salad/mhash.h>
+
+/** Compression context of the tx thread. */
+static ZSTD_CCtx *tuple_cctx;
+/** Decompression context of the tx thread. */
+static ZSTD_DCtx *tuple_dctx;
+/** Output buffer of tuple_compress(). */
+static char *tuple_zbuf;
+static size_t tuple_zbuf_capacity;
+
+static struct mh_tuple_unpacked_t *tuple_unpacked_hash;
+/**
+ * Decompressed data cached at the moment, the least recently
+ * used first.
+ */
+static RLIST_HEAD(tuple_unpacked_lru);
+/** Total size of the decompressed data cache. */
+static size_t tuple_unpacked_size;
+/** Trims the cache to its budget at the end of a loop iteration. */
+static struct ev_prepare tuple_unpacked_trim;
+
+/**
+ * Dictionaries of deleted formats, which are freed once the
+ * last snapshot is over.
+ */
+static RLIST_HEAD(tuple_dict_graveyard);
+/** The number of snapshots in progress. */
+static int tuple_snapshot_count;
+
+static struct tuple_dict *
+tuple_dict_new(const char *buf, size_t size)
+{
+	struct tuple_dict *dict = (struct tuple_dict *)
+		calloc(1, sizeof(*dict));
+	if (dict == NULL) {
+		diag_set(OutOfMemory, sizeof(*dict), "calloc",
+			 "struct tuple_dict");
+		return NULL;
+	}
+	dict->cdict = ZSTD_createCDict(buf, size, TUPLE_ZSTD_LEVEL);
+	dict->ddict = ZSTD_createDDict(buf, size);
+	if (dict->cdict == NULL || dict->ddict == NULL) {
+		ZSTD_freeCDict(dict->cdict);
+		ZSTD_freeDDict(dict->ddict);
+		free(dict);
+		diag_set(ClientError, ER_COMPRESSION,
+			 "failed to create dictionary");
+		return NULL;
+	}
+	return dict;
+}
+
+static void
+tuple_dict_delete(struct tuple_dict *dict)
+{
+	if (tuple_snapshot_count > 0) {
+		/* The snapshot may need it for deleted tuples. */
+		rlist_add_entry(&tuple_dict_graveyard, dict, in_graveyard);
+		return;
+	}
+	ZSTD_freeCDict(dict->cdict);
+	ZSTD_freeDDict(dict->ddict);
+	free(dict);
+}
+
+struct tuple_compression *
+tuple_compression_new(uint32_t threshold)
+{
+	struct tuple_compression *compression = (struct tuple_compression *)
+		calloc(1, sizeof(*compression));
+	if (compression == NULL) {
+		diag_set(OutOfMemory, sizeof(*compression), "calloc",
+			 "struct tuple_compression");
+		return NULL;
+	}
+	compression->threshold = threshold;
+	return compression;
+}
+
+void
+tuple_compression_delete(struct tuple_compression *compression)
+{
+	if (compression->dict != NULL)
+		tuple_dict_delete(compression->dict);
+	free(compression->samples);
+	free(compression->sample_sizes);
+	free(compression);
+}
+
+static ssize_t
+tuple_dict_train_cb(va_list ap)
+{
+	struct tuple_compression *compression =
+		va_arg(ap, struct tuple_compression *);
+	struct tuple_dict **p_dict = va_arg(ap, struct tuple_dict **);
+	char *buf = (char *) malloc(TUPLE_DICT_SIZE_MAX);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, TUPLE_DICT_SIZE_MAX, "malloc",
+			 "tuple dictionary");
+		return -1;
+	}
+	size_t size = ZDICT_trainFromBuffer(buf, TUPLE_DICT_SIZE_MAX,
+					    compression->samples,
+					    compression->sample_sizes,
+					    compression->sample_count);
+	if (ZDICT_isError(size)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZDICT_getErrorName(size));
+		free(buf);
+		return -1;
+	}
+	*p_dict = tuple_dict_new(buf, size);
+	free(buf);
+	return *p_dict != NULL ? 0 : -1;
+}
+
+static int
+tuple_dict_train_f(va_list ap)
+{
+	struct tuple_format *format = va_arg(ap, struct tuple_format *);
+	struct tuple_compression *compression = format->compression;
+	struct tuple_dict *dict = NULL;
+	if (coio_call(tuple_dict_train_cb, compression, &dict) == 0) {
+		compression->dict = dict;
+		say_info("trained a tuple compression dictionary on "
+			 "%u samples of %zu bytes", compression->sample_count,
+			 compression->samples_size);
+	} else {
+		struct error *e = diag_last_error(diag_get());
+		if (e != NULL)
+			error_log(e);
+		say_warn("failed to train a tuple compression dictionary, "
+			 "tuples are compressed without it");
+	}
+	free(compression->samples);
+	free(compression->sample_sizes);
+	compression->samples = NULL;
+	compression->sample_sizes = NULL;
+	/* May delete the format if the space was dropped. */
+	tuple_format_ref(format, -1);
+	return 0;
+}
+
+/**
+ * Train the dictionary in a coeio thread. The samples stay
+ * untouched meanwhile, since no more of them are collected.
+ */
+static void
+tuple_dict_train(struct tuple_format *format)
+{
+	struct fiber *f = fiber_new("tuple_dict", tuple_dict_train_f);
+	if (f == NULL) {
+		/* Not critical, go on without a dictionary. */
+		error_log(diag_last_error(diag_get()));
+		return;
+	}
+	tuple_format_ref(format, 1);
+	fiber_start(f, format);
+}
+
+/** Collect a sample of tuple data to train the dictionary on. */
+static void
+tuple_compression_sample(struct tuple_format *format, const char *data,
+			 size_t size)
+{
+	struct tuple_compression *compression = format->compression;
+	if (compression->is_training_started)
+		return;
+	if (compression->samples == NULL) {
+		compression->samples = (char *) malloc(TUPLE_DICT_SAMPLES_SIZE);
+		compression->sample_sizes = (size_t *)
+			malloc(TUPLE_DICT_SAMPLE_COUNT * sizeof(size_t));
+		if (compression->samples == NULL ||
+		    compression->sample_sizes == NULL) {
+			/* Not critical, go on without a dictionary. */
+			free(compression->samples);
+			free(compression->sample_sizes);
+			compression->samples = NULL;
+			compression->sample_sizes = NULL;
+			compression->is_training_started = true;
+			return;
+		}
+	}
+	size = MIN(size, (size_t) TUPLE_DICT_SAMPLE_SIZE_MAX);
+	size = MIN(size, TUPLE_DICT_SAMPLES_SIZE - compression->samples_size);
+	memcpy(compression->samples + compression->samples_size, data, size);
+	compression->samples_size += size;
+	compression->sample_sizes[compression->sample_count++] = size;
+	if (compression->samples_size == TUPLE_DICT_SAMPLES_SIZE ||
+	    compression->sample_count == TUPLE_DICT_SAMPLE_COUNT) {
+		compression->is_training_started = true;
+		tuple_dict_train(format);
+	}
+}
+
+size_t
+tuple_compress(struct tuple_format *format, const char *data,
+	       const char *end, struct tuple_ztrailer *trailer,
+	       const char **zdata)
+{
+	struct tuple_compression *compression = format->compression;
+	assert(compression != NULL);
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	if (field_count < format->field_count) {
+		/* Let tuple_init_field_map() complain. */
+		return 0;
+	}
+	for (uint32_t i = 0; i < format->field_count; i++)
+		mp_next(&pos);
+	size_t size = end - pos;
+	if (size <= sizeof(*trailer))
+		return 0;
+	size_t capacity = ZSTD_compressBound(size);
+	if (capacity > tuple_zbuf_capacity) {
+		char *buf = (char *) realloc(tuple_zbuf, capacity);
+		if (buf == NULL)
+			return 0;
+		tuple_zbuf = buf;
+		tuple_zbuf_capacity = capacity;
+	}
+	tuple_compression_sample(format, pos, size);
+	struct tuple_dict *dict = compression->dict;
+	size_t zsize;
+	if (dict != NULL) {
+		zsize = ZSTD_compress_usingCDict(tuple_cctx, tuple_zbuf,
+						 capacity, pos, size,
+						 dict->cdict);
+	} else {
+		zsize = ZSTD_compressCCtx(tuple_cctx, tuple_zbuf, capacity,
+					  pos, size, TUPLE_ZSTD_LEVEL);
+	}
+	if (ZSTD_isError(zsize) || zsize + sizeof(*trailer) >= size)
+		return 0;
+	trailer->dict = dict;
+	trailer->prefix_size = pos - data;
+	trailer->bsize = end - data;
+	*zdata = tuple_zbuf;
+	return zsize;
+}
+
+/**
+ * Decompress tuple data into a buffer of trailer->bsize bytes.
+ * @retval -1 the data is corrupted, diag is set
+ */
+static int
+tuple_decompress(const struct tuple *tuple, ZSTD_DCtx *dctx, char *buf)
+{
+	const struct tuple_ztrailer *trailer = tuple_ztrailer(tuple);
+	const char *zdata = tuple->raw + trailer->prefix_size;
+	size_t zsize = tuple->size - trailer->prefix_size - sizeof(*trailer);
+	size_t size = trailer->bsize - trailer->prefix_size;
+	memcpy(buf, tuple->raw, trailer->prefix_size);
+	buf += trailer->prefix_size;
+	size_t rc;
+	if (trailer->dict != NULL) {
+		rc = ZSTD_decompress_usingDDict(dctx, buf, size, zdata, zsize,
+						trailer->dict->ddict);
+	} else {
+		rc = ZSTD_decompressDCtx(dctx, buf, size, zdata, zsize);
+	}
+	if (ZSTD_isError(rc)) {
+		diag_set(ClientError, ER_DECOMPRESSION, ZSTD_getErrorName(rc));
+		return -1;
+	}
+	if (rc != size) {
+		diag_set(ClientError, ER_DECOMPRESSION, "invalid tuple size");
+		return -1;
+	}
+	return 0;
+}
+
+static void
+tuple_unpacked_delete(struct tuple_unpacked *unpacked)
+{
+	mh_int_t k = mh_tuple_unpacked_find(tuple_unpacked_hash,
+					    unpacked->tuple, NULL);
+	assert(k != mh_end(tuple_unpacked_hash));
+	mh_tuple_unpacked_del(tuple_unpacked_hash, k, NULL);
+	rlist_del_entry(unpacked, in_lru);
+	tuple_unpacked_size -= unpacked->size;
+	free(unpacked);
+}
+
+/**
+ * Evict the least recently used entries until the cache size
+ * is within the limit. Unless @a evict_all is set, the data
+ * used at the current event loop iteration is never evicted,
+ * since pointers to it may still be in use.
+ */
+static void
+tuple_unpacked_evict(size_t limit, bool evict_all)
+{
+	unsigned iteration = ev_iteration(loop());
+	while (tuple_unpacked_size > limit &&
+	       !rlist_empty(&tuple_unpacked_lru)) {
+		struct tuple_unpacked *unpacked =
+			rlist_first_entry(&tuple_unpacked_lru,
+					  struct tuple_unpacked, in_lru);
+		if (!evict_all && unpacked->iteration == iteration)
+			break;
+		tuple_unpacked_delete(unpacked);
+	}
+}
+
+static void
+tuple_unpacked_trim_cb(ev_loop *loop, struct ev_prepare *watcher, int events)
+{
+	(void) events;
+	/* No fiber is running, none may use the data. */
+	tuple_unpacked_evict(TUPLE_UNPACKED_CACHE_SIZE, true);
+	ev_prepare_stop(loop, watcher);
+}
+
+void
+tuple_unpacked_drop(const struct tuple *tuple)
+{
+	mh_int_t k = mh_tuple_unpacked_find(tuple_unpacked_hash, tuple, NULL);
+	if (k != mh_end(tuple_unpacked_hash))
+		tuple_unpacked_delete(*mh_tuple_unpacked_node(
+			tuple_unpacked_hash, k));
+}
+
+const char *
+tuple_unpack_cached(const struct tuple *tuple)
+{
+	unsigned iteration = ev_iteration(loop());
+	struct tuple_unpacked *unpacked;
+	mh_int_t k = mh_tuple_unpacked_find(tuple_unpacked_hash, tuple, NULL);
+	if (k != mh_end(tuple_unpacked_hash)) {
+		unpacked = *mh_tuple_unpacked_node(tuple_unpacked_hash, k);
+		unpacked->iteration = iteration;
+		rlist_move_tail_entry(&tuple_unpacked_lru, unpacked, in_lru);
+		return unpacked->data;
+	}
+	const struct tuple_ztrailer *trailer = tuple_ztrailer(tuple);
+	size_t size = sizeof(*unpacked) + trailer->bsize;
+	tuple_unpacked_evict(size < TUPLE_UNPACKED_CACHE_SIZE ?
+			     TUPLE_UNPACKED_CACHE_SIZE - size : 0, false);
+	unpacked = (struct tuple_unpacked *) malloc(size);
+	if (unpacked == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "decompressed tuple");
+		return NULL;
+	}
+	if (tuple_decompress(tuple, tuple_dctx, unpacked->data) != 0) {
+		free(unpacked);
+		return NULL;
+	}
+	unpacked->tuple = tuple;
+	unpacked->size = size;
+	unpacked->iteration = iteration;
+	if (mh_tuple_unpacked_put(tuple_unpacked_hash, &unpacked,
+				  NULL, NULL) == mh_end(tuple_unpacked_hash)) {
+		free(unpacked);
+		diag_set(OutOfMemory, sizeof(unpacked), "mhash",
+			 "decompressed tuple");
+		return NULL;
+	}
+	rlist_add_tail_entry(&tuple_unpacked_lru, unpacked, in_lru);
+	tuple_unpacked_size += size;
+	/*
+	 * The data used at this iteration may exceed the budget,
+	 * trim the cache once the fibers are done with it.
+	 */
+	if (tuple_unpacked_size > TUPLE_UNPACKED_CACHE_SIZE &&
+	    !ev_is_active(&tuple_unpacked_trim))
+		ev_prepare_start(loop(), &tuple_unpacked_trim);
+	return unpacked->data;
+}
+
+void
+tuple_unpack_ctx_create(struct tuple_unpack_ctx *ctx)
+{
+	ctx->dctx = NULL;
+	ctx->buf = NULL;
+	ctx->capacity = 0;
+}
+
+void
+tuple_unpack_ctx_destroy(struct tuple_unpack_ctx *ctx)
+{
+	if (ctx->dctx != NULL)
+		ZSTD_freeDCtx((ZSTD_DCtx *) ctx->dctx);
+	free(ctx->buf);
+}
+
+const char *
+tuple_unpack(struct tuple_unpack_ctx *ctx, const struct tuple *tuple,
+	     uint32_t *p_size)
+{
+	if (!tuple->is_compressed) {
+		*p_size = tuple->size;
+		return tuple->raw;
+	}
+	const struct tuple_ztrailer *trailer = tuple_ztrailer(tuple);
+	if (ctx->dctx == NULL) {
+		ctx->dctx = ZSTD_createDCtx();
+		if (ctx->dctx == NULL) {
+			diag_set(ClientError, ER_DECOMPRESSION,
+				 "failed to create context");
+			return NULL;
+		}
+	}
+	if (trailer->bsize > ctx->capacity) {
+		char *buf = (char *) realloc(ctx->buf, trailer->bsize);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, trailer->bsize, "realloc",
+				 "decompressed tuple");
+			return NULL;
+		}
+		ctx->buf = buf;
+		ctx->capacity = trailer->bsize;
+	}
+	if (tuple_decompress(tuple, (ZSTD_DCtx *) ctx->dctx, ctx->buf) != 0)
+		return NULL;
+	*p_size = trailer->bsize;
+	return ctx->buf;
+}
+
+void
+tuple_compression_begin_snapshot(void)
+{
+	tuple_snapshot_count++;
+}
+
+void
+tuple_compression_end_snapshot(void)
+{
+	assert(tuple_snapshot_count > 0);
+	if (--tuple_snapshot_count > 0)
+		return;
+	struct tuple_dict *dict, *tmp;
+	rlist_foreach_entry_safe(dict, &tuple_dict_graveyard,
+				 in_graveyard, tmp) {
+		rlist_del_entry(dict, in_graveyard);
+		tuple_dict_delete(dict);
+	}
+}
+
+void
+tuple_compression_init(void)
+{
+	tuple_cctx = ZSTD_createCCtx();
+	tuple_dctx = ZSTD_createDCtx();
+	tuple_unpacked_hash = mh_tuple_unpacked_new();
+	if (tuple_cctx == NULL || tuple_dctx == NULL ||
+	    tuple_unpacked_hash == NULL)
+		panic("failed to create tuple compression context");
+	ev_prepare_init(&tuple_unpacked_trim, tuple_unpacked_trim_cb);
+}
+
+void
+tuple_compression_free(void)
+{
+	struct tuple_unpacked *unpacked, *tmp;
+	rlist_foreach_entry_safe(unpacked, &tuple_unpacked_lru, in_lru, tmp)
+		tuple_unpacked_delete(unpacked);
+	mh_tuple_unpacked_delete(tuple_unpacked_hash);
+	ev_prepare_stop(loop(), &tuple_unpacked_trim);
+	ZSTD_freeCCtx(tuple_cctx);
+	ZSTD_freeDCtx(tuple_dctx);
+	free(tuple_zbuf);
+	tuple_zbuf = NULL;
+	tuple_zbuf_capacity = 0;
+}
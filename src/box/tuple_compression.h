@@ -0,0 +1,199 @@
+#ifndef TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED
+#define TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trivia/util.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/*
+ * Tuple compression.
+ *
+ * A space with compress_threshold option set stores tuples
+ * larger than the threshold compressed with zstd. The data of
+ * a compressed tuple consists of:
+ *
+ * - the MessagePack array header and all fields covered by
+ *   the tuple format (i.e. up to the last indexed one), as is;
+ * - the rest of the fields, compressed;
+ * - struct tuple_ztrailer.
+ *
+ * So indexes find and compare compressed tuples without
+ * decompressing them, and only reads of the whole tuple or
+ * of an unindexed field pay for decompression.
+ *
+ * The first tuples of a space are compressed without a
+ * dictionary, and sampled. Once there are enough samples,
+ * a dictionary is trained on them in a coeio thread and used
+ * for all tuples created in the space afterwards.
+ *
+ * Decompressed data is kept in a small LRU cache, so that
+ * repeated reads of a tuple don't decompress it every time.
+ * The pointers returned by tuple_data() and tuple_field()
+ * stay valid until the end of the current event loop
+ * iteration, i.e. until the fiber yields: copy the data to
+ * keep it longer. The cache may grow over its budget within
+ * an iteration and is trimmed back once it's over.
+ */
+
+struct tuple;
+struct tuple_format;
+struct tuple_dict;
+
+/** Trailer of a compressed tuple. */
+struct PACKED tuple_ztrailer {
+	/** Dictionary used for compression, or NULL. */
+	struct tuple_dict *dict;
+	/** Size of the uncompressed beginning of the data. */
+	uint32_t prefix_size;
+	/** Size of the data when decompressed. */
+	uint32_t bsize;
+};
+
+/** Compression settings and state of a tuple format. */
+struct tuple_compression {
+	/** Tuples of this size or larger are compressed. */
+	uint32_t threshold;
+	/** The trained dictionary, or NULL. */
+	struct tuple_dict *dict;
+	/** Set once the dictionary training has been started. */
+	bool is_training_started;
+	/**
+	 * Samples of tuple data collected to train the
+	 * dictionary, allocated on the first sample.
+	 */
+	char *samples;
+	/** Total size of collected samples. */
+	size_t samples_size;
+	/** Sizes of individual samples. */
+	size_t *sample_sizes;
+	/** The number of collected samples. */
+	unsigned sample_count;
+};
+
+/**
+ * A private buffer to decompress tuples into, for those who
+ * can not use the decompressed data cache: another thread,
+ * or a read view, which may see tuples which were already
+ * deleted.
+ */
+struct tuple_unpack_ctx {
+	/** zstd decompression context, created on demand. */
+	void *dctx;
+	char *buf;
+	size_t capacity;
+};
+
+/**
+ * Create compression state for a tuple format.
+ * @retval NULL out of memory, diag is set
+ */
+struct tuple_compression *
+tuple_compression_new(uint32_t threshold);
+
+void
+tuple_compression_delete(struct tuple_compression *compression);
+
+/**
+ * Compress tuple data for a format which has compression
+ * enabled. Only the fields not covered by the format are
+ * compressed.
+ *
+ * @param format tuple format
+ * @param data, end tuple data
+ * @param[out] trailer trailer of the compressed tuple
+ * @param[out] zdata compressed data, valid until the next call
+ *
+ * @retval > 0 the size of compressed data
+ * @retval 0 the data is not worth compressing
+ */
+size_t
+tuple_compress(struct tuple_format *format, const char *data,
+	       const char *end, struct tuple_ztrailer *trailer,
+	       const char **zdata);
+
+/**
+ * Return decompressed data of a compressed tuple, from the
+ * cache if possible. For use in the tx thread only.
+ * @retval NULL out of memory or corrupt data, diag is set
+ */
+const char *
+tuple_unpack_cached(const struct tuple *tuple);
+
+/** Drop the cached decompressed data of a deleted tuple. */
+void
+tuple_unpacked_drop(const struct tuple *tuple);
+
+void
+tuple_unpack_ctx_create(struct tuple_unpack_ctx *ctx);
+
+void
+tuple_unpack_ctx_destroy(struct tuple_unpack_ctx *ctx);
+
+/**
+ * Return tuple data, decompressing it into a private
+ * buffer if the tuple is compressed. The data is valid
+ * until the next call with the same buffer.
+ *
+ * @retval NULL out of memory, diag is set
+ */
+const char *
+tuple_unpack(struct tuple_unpack_ctx *ctx, const struct tuple *tuple,
+	     uint32_t *p_size);
+
+/**
+ * Dictionaries of dropped formats are not freed while a
+ * snapshot is in progress, since the snapshot may still need
+ * them to decompress deleted tuples.
+ */
+void
+tuple_compression_begin_snapshot(void);
+
+void
+tuple_compression_end_snapshot(void);
+
+void
+tuple_compression_init(void);
+
+void
+tuple_compression_free(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_TUPLE_COMPRESSION_H_INCLUDED */
@@ -29,6 +29,7 @@
  * SUCH DAMAGE.
  */
 #include "tuple_format.h"
+#include "tuple_compression.h"
 
 /** Global table of tuple formats */
 struct tuple_format **tuple_formats;
@@ -144,6 +145,7 @@ tuple_format_alloc(struct rlist *key_list)
 	format->id = FORMAT_ID_NIL;
 	format->field_count = field_count;
 	format->exact_field_count = 0;
+	format->compression = NULL;
 	return format;
 }
 
@@ -151,6 +153,8 @@ void
 tuple_format_delete(struct tuple_format *format)
 {
 	tuple_format_deregister(format);
+	if (format->compression != NULL)
+		tuple_compression_delete(format->compression);
 	free(format);
 }
 
@@ -193,6 +197,15 @@ tuple_format_new(struct rlist *key_list)
 			format->fields[i].offset_slot = --current_slot;
 	}
 	format->field_map_size = -current_slot * sizeof(uint32_t);
+	/* The last field is always indexed, hence no gap at the end. */
+	uint32_t gap_length = 0;
+	for (uint32_t i = format->field_count; i-- > 0; ) {
+		if (format->fields[i].type == FIELD_TYPE_ANY)
+			gap_length++;
+		else
+			gap_length = 0;
+		format->fields[i].gap_length = gap_length;
+	}
 	return format;
 }
 
@@ -230,12 +243,19 @@ tuple_init_field_map(const struct tuple_format *format, uint32_t *field_map,
 	mp_next(&pos);
 	/* other fields...*/
 	for (uint32_t i = 1; i < format->field_count; i++) {
+		const struct tuple_field_format *field = &format->fields[i];
+		if (field->gap_length > 0) {
+			/* Not indexed: nothing to check or remember. */
+			pos = mp_skip(pos, field->gap_length);
+			i += field->gap_length - 1;
+			continue;
+		}
 		mp_type = mp_typeof(*pos);
-		if (key_mp_type_validate(format->fields[i].type, mp_type,
+		if (key_mp_type_validate(field->type, mp_type,
 					 ER_FIELD_TYPE, i + TUPLE_INDEX_BASE))
 			return -1;
-		if (format->fields[i].offset_slot < 0)
-			field_map[format->fields[i].offset_slot] =
+		if (field->offset_slot < 0)
+			field_map[field->offset_slot] =
 				(uint32_t) (pos - tuple);
 		mp_next(&pos);
 	}
@@ -33,11 +33,14 @@
 
 #include "key_def.h" /* for enum field_type */
 #include "errinj.h"
+#include "mp_scan.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+struct tuple_compression;
+
 enum { FORMAT_ID_MAX = UINT16_MAX - 1, FORMAT_ID_NIL = UINT16_MAX };
 enum { FORMAT_REF_MAX = INT32_MAX};
 
@@ -78,6 +81,14 @@ struct tuple_field_format {
 	 * gives the start of the field
 	 */
 	int32_t offset_slot;
+	/**
+	 * The number of consecutive fields which do not
+	 * participate in indexes, starting from this one.
+	 * Such fields need neither type check nor an offset
+	 * slot, so tuple_init_field_map() skips them in bulk.
+	 * Zero if this field is indexed.
+	 */
+	uint32_t gap_length;
 };
 
 /**
@@ -100,6 +111,11 @@ struct tuple_format {
 	 * See tuple_field_format::ofset for details//
 	 */
 	uint32_t field_map_size;
+	/**
+	 * Compression of large tuples, or NULL if tuples of
+	 * this format are never compressed.
+	 */
+	struct tuple_compression *compression;
 
 	/* Formats of the fields */
 	struct tuple_field_format fields[];
@@ -202,9 +218,7 @@ tuple_field_raw(const struct tuple_format *format, const char *tuple,
 	uint32_t field_count = mp_decode_array(&tuple);
 	if (unlikely(field_no >= field_count))
 		return NULL;
-	for (uint32_t k = 0; k < field_no; k++)
-		mp_next(&tuple);
-	return tuple;
+	return mp_skip(tuple, field_no);
 }
 
 #if defined(__cplusplus)
@@ -315,6 +315,49 @@ user_reload_privs(struct user *user)
 	user->is_dirty = false;
 }
 
+/**
+ * Re-calculate effective access of the user to a single
+ * object, assuming nothing but the grants on this object
+ * has changed since the last reload. Roles of the user
+ * must already have their effective privileges up to date.
+ * Unlike user_reload_privs(), which rescans _priv and
+ * rebuilds the whole set, this costs one lookup per
+ * role of the user.
+ */
+static void
+user_reload_priv(struct user *user, struct priv_def *priv,
+		 struct access *object)
+{
+	if (user->is_dirty == false)
+		return;
+	struct access *access = &object[user->auth_token];
+	uint8_t effective = access->granted;
+	struct user_map_iterator it;
+	user_map_iterator_init(&it, &user->roles);
+	struct user *role;
+	while ((role = user_map_iterator_next(&it))) {
+		struct priv_def *def = privset_search(&role->privs, priv);
+		if (def != NULL)
+			effective |= def->access;
+	}
+	struct priv_def *old = privset_search(&user->privs, priv);
+	if (old != NULL) {
+		old->access = effective;
+	} else if (effective != 0) {
+		old = (struct priv_def *)
+			region_alloc_xc(&user->pool, sizeof(struct priv_def));
+		*old = *priv;
+		old->access = effective;
+		privset_insert(&user->privs, old);
+	}
+	access->effective = effective;
+	/** Update global access in the current session. */
+	struct credentials *cr = current_user();
+	if (priv->object_type == SC_UNIVERSE && user->def.uid == cr->uid)
+		cr->universal_access = effective;
+	user->is_dirty = false;
+}
+
 /** }}} */
 
 /* {{{ authentication tokens */
@@ -532,10 +575,15 @@ role_check(struct user *grantee, struct user *role)
 
 /**
  * Re-calculate effective grants of the linked subgraph
- * this user/role is a part of.
+ * this user/role is a part of. If only a grant on a single
+ * object has changed, pass its definition and access array
+ * in priv and object to refresh just this object instead of
+ * reloading all privileges of every user in the subgraph.
+ * Otherwise pass NULL in both.
  */
 void
-rebuild_effective_grants(struct user *grantee)
+rebuild_effective_grants(struct user *grantee, struct priv_def *priv,
+			 struct access *object)
 {
 	/*
 	 * Recurse over all roles to which grantee is granted
@@ -586,7 +634,10 @@ rebuild_effective_grants(struct user *grantee)
 			struct user_map indirect_edges = user->roles;
 			user_map_minus(&indirect_edges, &transitive_closure);
 			if (user_map_is_empty(&indirect_edges)) {
-				user_reload_privs(user);
+				if (priv != NULL)
+					user_reload_priv(user, priv, object);
+				else
+					user_reload_privs(user);
 				user_map_union(&next_layer, &user->users);
 			} else {
 				/*
@@ -620,7 +671,7 @@ role_grant(struct user *grantee, struct user *role)
 {
 	user_map_set(&role->users, grantee->auth_token);
 	user_map_set(&grantee->roles, role->auth_token);
-	rebuild_effective_grants(grantee);
+	rebuild_effective_grants(grantee, NULL, NULL);
 }
 
 /**
@@ -632,7 +683,7 @@ role_revoke(struct user *grantee, struct user *role)
 {
 	user_map_clear(&role->users, grantee->auth_token);
 	user_map_clear(&grantee->roles, role->auth_token);
-	rebuild_effective_grants(grantee);
+	rebuild_effective_grants(grantee, NULL, NULL);
 }
 
 void
@@ -644,7 +695,7 @@ priv_grant(struct user *grantee, struct priv_def *priv)
 	struct access *access = &object[grantee->auth_token];
 	assert(privset_search(&grantee->privs, priv) || access->granted == 0);
 	access->granted = priv->access;
-	rebuild_effective_grants(grantee);
+	rebuild_effective_grants(grantee, priv, object);
 }
 
 /** }}} */
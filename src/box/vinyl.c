@@ -104,6 +104,8 @@ struct vy_conf {
 	char *path;
 	/* memory */
 	uint64_t memory_limit;
+	/* number of pages to read ahead on sequential scans */
+	uint32_t read_ahead;
 };
 
 struct vy_env {
@@ -1073,6 +1075,10 @@ struct vy_page_read_task {
 	struct vy_page *page;
 	/** [out] result code */
 	int rc;
+	/** page number in the run */
+	uint32_t page_no;
+	/** link in vy_run_iterator->read_ahead */
+	struct rlist in_read_ahead;
 };
 
 static struct txv *
@@ -4942,6 +4948,7 @@ vy_conf_new()
 		return NULL;
 	}
 	conf->memory_limit = cfg_getd("vinyl.memory_limit")*1024*1024*1024;
+	conf->read_ahead = cfg_geti("vinyl.read_ahead");
 
 	conf->path = strdup(cfg_gets("vinyl_dir"));
 	if (conf->path == NULL) {
@@ -7124,6 +7131,18 @@ struct vy_run_iterator {
 	/** LRU cache of two active pages (two pages is enough). */
 	struct vy_page *curr_page;
 	struct vy_page *prev_page;
+	/** The last page read from the disk, UINT32_MAX if none */
+	uint32_t last_page_no;
+	/**
+	 * The number of pages read one after another in the
+	 * iteration order. Once it's non-zero, the following
+	 * pages are read ahead.
+	 */
+	uint32_t seq_page_count;
+	/** Pages being read on coeio, in the iteration order */
+	struct rlist read_ahead;
+	/** The number of pages in the read_ahead list */
+	uint32_t read_ahead_count;
 	/** Is false until first .._get ot .._next_.. method is called */
 	bool search_started;
 	/** Search is finished, you will not get more values from iterator */
@@ -7273,12 +7292,16 @@ vy_run_iterator_cache_put(struct vy_run_iterator *itr, struct vy_page *page,
 	page->page_no = page_no;
 }
 
+static void
+vy_run_iterator_read_ahead_cancel(struct vy_run_iterator *itr);
+
 /**
  * Clear LRU cache
  */
 static void
 vy_run_iterator_cache_clean(struct vy_run_iterator *itr)
 {
+	vy_run_iterator_read_ahead_cancel(itr);
 	if (itr->curr_stmt != NULL) {
 		vy_stmt_unref(itr->curr_stmt);
 		itr->curr_stmt = NULL;
@@ -7423,6 +7446,133 @@ vy_page_read_cb_free(struct coio_task *base)
 	return 0;
 }
 
+/**
+ * Allocate a task to read a page of the iterator run on coeio.
+ */
+static struct vy_page_read_task *
+vy_page_read_task_new(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_env *env = itr->index->env;
+	struct vy_page_info *page_info = vy_run_page_info(itr->run, page_no);
+	struct vy_page *page = vy_page_new(page_info);
+	if (page == NULL)
+		return NULL;
+	struct vy_page_read_task *task =
+		(struct vy_page_read_task *)mempool_alloc(&env->read_task_pool);
+	if (task == NULL) {
+		diag_set(OutOfMemory, sizeof(*task), "malloc",
+			 "vy_page_read_task");
+		vy_page_delete(page);
+		return NULL;
+	}
+	coio_task_create(&task->base, vy_page_read_cb,
+			  vy_page_read_cb_free);
+
+	/*
+	 * Make sure the run file descriptor won't be closed
+	 * (even worse, reopened) while a coeio thread is
+	 * reading it.
+	 */
+	task->run = itr->run;
+	vy_run_ref(task->run);
+	task->page_info = *page_info;
+	task->env = env;
+	task->page = page;
+	task->page_no = page_no;
+	return task;
+}
+
+/**
+ * Give up the pages being read ahead.
+ */
+static void
+vy_run_iterator_read_ahead_cancel(struct vy_run_iterator *itr)
+{
+	struct vy_page_read_task *task, *tmp;
+	rlist_foreach_entry_safe(task, &itr->read_ahead, in_read_ahead, tmp) {
+		rlist_del_entry(task, in_read_ahead);
+		if (coio_task_detach(&task->base) == 0)
+			vy_page_read_cb_free(&task->base);
+	}
+	itr->read_ahead_count = 0;
+	itr->seq_page_count = 0;
+}
+
+/**
+ * Take the task reading the given page ahead, if any. The
+ * pages read ahead before it are skipped by the iterator and
+ * given up.
+ */
+static struct vy_page_read_task *
+vy_run_iterator_read_ahead_take(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_page_read_task *task, *tmp;
+	rlist_foreach_entry_safe(task, &itr->read_ahead, in_read_ahead, tmp) {
+		rlist_del_entry(task, in_read_ahead);
+		itr->read_ahead_count--;
+		if (task->page_no == page_no)
+			return task;
+		if (coio_task_detach(&task->base) == 0)
+			vy_page_read_cb_free(&task->base);
+	}
+	return NULL;
+}
+
+/**
+ * Keep up to vinyl.read_ahead pages following the given one
+ * in the iteration order being read and decompressed on
+ * coeio while the current page is processed, once the access
+ * looks sequential.
+ */
+static void
+vy_run_iterator_read_ahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	uint32_t limit = itr->index->env->conf->read_ahead;
+	if (itr->seq_page_count == 0 || itr->read_ahead_count >= limit)
+		return;
+	bool is_backward = itr->iterator_type == ITER_LE ||
+			   itr->iterator_type == ITER_LT;
+	if (!rlist_empty(&itr->read_ahead)) {
+		page_no = rlist_last_entry(&itr->read_ahead,
+					   struct vy_page_read_task,
+					   in_read_ahead)->page_no;
+	}
+	while (itr->read_ahead_count < limit) {
+		if (is_backward ? page_no == 0 :
+		    page_no + 1 >= itr->run->info.count)
+			break;
+		page_no = is_backward ? page_no - 1 : page_no + 1;
+		struct vy_page_read_task *task =
+			vy_page_read_task_new(itr, page_no);
+		if (task == NULL) {
+			/* Read-ahead is only a hint */
+			diag_clear(diag_get());
+			break;
+		}
+		coio_task_submit(&task->base);
+		rlist_add_tail_entry(&itr->read_ahead, task, in_read_ahead);
+		itr->read_ahead_count++;
+	}
+}
+
+/**
+ * Account a page read from the disk to detect sequential
+ * access.
+ */
+static void
+vy_run_iterator_track_page(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	bool is_backward = itr->iterator_type == ITER_LE ||
+			   itr->iterator_type == ITER_LT;
+	uint32_t prev_page_no = itr->last_page_no;
+	itr->last_page_no = page_no;
+	if (prev_page_no != UINT32_MAX &&
+	    page_no == (is_backward ? prev_page_no - 1 : prev_page_no + 1))
+		itr->seq_page_count++;
+	else
+		itr->seq_page_count = 0;
+}
+
 /**
  * Get a page by the given number the cache or load it from the disk.
  *
@@ -7442,13 +7592,8 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	if (*result != NULL)
 		return 0;
 
-	/* Allocate buffers */
-	struct vy_page_info *page_info = vy_run_page_info(itr->run, page_no);
-	struct vy_page *page = vy_page_new(page_info);
-	if (page == NULL)
-		return -1;
-
 	/* Read page data from the disk */
+	struct vy_page *page;
 	int rc;
 	if (cord_is_main() && env->status == VINYL_ONLINE) {
 		/*
@@ -7461,30 +7606,19 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		uint32_t index_version = itr->index->version;
 		uint32_t range_version = itr->range->version;
 
-		/* Allocate a coio task */
 		struct vy_page_read_task *task =
-			(struct vy_page_read_task *)mempool_alloc(&itr->index->env->read_task_pool);
-		if (task == NULL) {
-			diag_set(OutOfMemory, sizeof(*task), "malloc",
-				 "vy_page_read_task");
-			return -1;
+			vy_run_iterator_read_ahead_take(itr, page_no);
+		if (task != NULL) {
+			/* The page has been read ahead */
+			rc = coio_task_wait(&task->base, TIMEOUT_INFINITY);
+		} else {
+			vy_run_iterator_read_ahead_cancel(itr);
+			task = vy_page_read_task_new(itr, page_no);
+			if (task == NULL)
+				return -1;
+			/* Post task to coeio */
+			rc = coio_task_post(&task->base, TIMEOUT_INFINITY);
 		}
-		coio_task_create(&task->base, vy_page_read_cb,
-				  vy_page_read_cb_free);
-
-		/*
-		 * Make sure the run file descriptor won't be closed
-		 * (even worse, reopened) while a coeio thread is
-		 * reading it.
-		 */
-		task->run = itr->run;
-		vy_run_ref(task->run);
-		task->page_info = *page_info;
-		task->env = index->env;
-		task->page = page;
-
-		/* Post task to coeio */
-		rc = coio_task_post(&task->base, TIMEOUT_INFINITY);
 		if (rc < 0)
 			return -1; /* timed out or cancelled */
 
@@ -7495,6 +7629,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 			return -1;
 		}
 
+		page = task->page;
 		task->page = NULL;
 		vy_page_read_cb_free(&task->base);
 
@@ -7504,23 +7639,33 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		 */
 		if (index_version != itr->index->version ||
 		    range_version != itr->range->version) {
+			vy_run_iterator_read_ahead_cancel(itr);
 			itr->index = NULL;
 			itr->range = NULL;
 			itr->run = NULL;
 			vy_page_delete(page);
 			return -2; /* iterator is no more valid */
 		}
+		vy_run_iterator_track_page(itr, page_no);
+		vy_run_iterator_read_ahead(itr, page_no);
 	} else {
 		/*
 		 * Optimization: use blocked I/O for non-TX threads or
 		 * during WAL recovery (env->status != VINYL_ONLINE).
 		 */
+		struct vy_page_info *page_info =
+			vy_run_page_info(itr->run, page_no);
+		page = vy_page_new(page_info);
+		if (page == NULL)
+			return -1;
 		ZSTD_DStream *zdctx = vy_env_get_zdctx(itr->index->env);
-		if (zdctx == NULL)
+		if (zdctx == NULL) {
+			vy_page_delete(page);
 			return -1;
+		}
 		if (vy_page_read(page, page_info, itr->run->fd, zdctx) != 0) {
 			vy_page_delete(page);
-			page = NULL;
+			return -1;
 		}
 	}
 
@@ -7930,6 +8075,10 @@ vy_run_iterator_open(struct vy_run_iterator *itr, struct vy_range *range,
 	itr->curr_stmt_pos.page_no = UINT32_MAX;
 	itr->curr_page = NULL;
 	itr->prev_page = NULL;
+	itr->last_page_no = UINT32_MAX;
+	itr->seq_page_count = 0;
+	rlist_create(&itr->read_ahead);
+	itr->read_ahead_count = 0;
 
 	itr->search_started = false;
 	itr->search_ended = false;
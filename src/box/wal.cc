@@ -39,11 +39,15 @@
 #include "xrow.h"
 #include "cbus.h"
 #include "coeio.h"
+#include "ipc.h"
 
 const char *wal_mode_STRS[] = { "none", "write", "fsync", NULL };
 
 int wal_dir_lock = -1;
 
+/** The maximal disk space preallocated for the next WAL. */
+static const off_t WAL_SPARE_SIZE_MAX = 1024 * 1024 * 1024;
+
 /*
  * WAL writer - maintain a Write Ahead Log for every change
  * in the data state.
@@ -95,6 +99,16 @@ struct wal_writer
 	struct xlog current_wal;
 	/** true if wal file is opened */
 	bool is_active;
+	/**
+	 * A file created in advance to become the next WAL,
+	 * so that rotation doesn't stall the writes, or -1.
+	 * @sa wal_prepare_spare().
+	 */
+	int spare_fd;
+	/** The fiber creating the spare file, if any. */
+	struct fiber *spare_f;
+	/** Signaled when the spare file fiber is done. */
+	struct ipc_cond spare_cond;
 	/**
 	 * Used if there was a WAL I/O error and we need to
 	 * keep adding all incoming requests to the rollback
@@ -226,6 +240,9 @@ wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, server_uuid);
 	writer->is_active = false;
+	writer->spare_fd = -1;
+	writer->spare_f = NULL;
+	ipc_cond_create(&writer->spare_cond);
 	if (wal_mode == WAL_FSYNC)
 		writer->wal_dir.open_wflags |= O_SYNC;
 	cbus_create(&writer->tx_wal_bus);
@@ -250,6 +267,7 @@ static void
 wal_writer_destroy(struct wal_writer *writer)
 {
 	xdir_destroy(&writer->wal_dir);
+	ipc_cond_destroy(&writer->spare_cond);
 	cbus_destroy(&writer->tx_wal_bus);
 	tt_pthread_mutex_destroy(&writer->watchers_mutex);
 }
@@ -426,15 +444,80 @@ wal_opt_rotate(struct wal_writer *writer)
 	if (writer->is_active)
 		return 0;
 
-	if (xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
-			     &writer->vclock) != 0) {
-		return -1;
+	int rc;
+	if (writer->spare_fd >= 0) {
+		int spare_fd = writer->spare_fd;
+		writer->spare_fd = -1;
+		rc = xdir_create_xlog_from_spare(&writer->wal_dir,
+						 &writer->current_wal,
+						 &writer->vclock, spare_fd);
+	} else {
+		rc = xdir_create_xlog(&writer->wal_dir, &writer->current_wal,
+				      &writer->vclock);
 	}
+	if (rc != 0)
+		return -1;
 	writer->is_active = true;
 
 	return 0;
 }
 
+static ssize_t
+wal_create_spare_f(va_list ap)
+{
+	struct xdir *dir = va_arg(ap, struct xdir *);
+	off_t size = va_arg(ap, off_t);
+	return xdir_create_spare(dir, size);
+}
+
+/** Create the spare file in a coeio thread. */
+static int
+wal_spare_f(va_list ap)
+{
+	struct wal_writer *writer = va_arg(ap, struct wal_writer *);
+	off_t size = va_arg(ap, off_t);
+	ssize_t fd = coio_call(wal_create_spare_f, &writer->wal_dir, size);
+	if (fd >= 0) {
+		writer->spare_fd = fd;
+	} else {
+		struct error *e = diag_last_error(diag_get());
+		if (e != NULL)
+			error_log(e);
+		say_warn("failed to create a spare WAL file");
+	}
+	writer->spare_f = NULL;
+	ipc_cond_signal(&writer->spare_cond);
+	return 0;
+}
+
+/**
+ * Once the current WAL is half full, start creating the
+ * next one in background, preallocating as much disk space
+ * for it as the current WAL is expected to take. Then
+ * wal_opt_rotate() only needs to write the header and rename
+ * the spare, and the appends to it don't have to grow the
+ * file.
+ */
+static void
+wal_prepare_spare(struct wal_writer *writer)
+{
+	struct xlog *l = &writer->current_wal;
+	if (!writer->is_active || writer->spare_fd >= 0 ||
+	    writer->spare_f != NULL || l->rows == 0 ||
+	    l->rows < writer->rows_per_wal / 2)
+		return;
+	struct fiber *f = fiber_new("wal_spare", wal_spare_f);
+	if (f == NULL) {
+		/* Not critical, rotate the WAL the old way. */
+		error_log(diag_last_error(diag_get()));
+		return;
+	}
+	off_t size = l->offset / l->rows * writer->rows_per_wal;
+	size = MIN(size, WAL_SPARE_SIZE_MAX);
+	writer->spare_f = f;
+	fiber_start(f, writer, size);
+}
+
 static void
 wal_writer_clear_bus(struct cmsg *msg)
 {
@@ -538,15 +621,12 @@ wal_write_to_disk(struct cmsg *msg)
 		 * Iterate over request rows (tx statements)
 		 */
 		xlog_tx_begin(l);
-		struct xrow_header **row = req->rows;
-		for (; row < req->rows + req->n_rows; row++) {
-			if (xlog_write_row(l, *row) < 0) {
-				/*
-				 * Rollback all un-written rows
-				 */
-				xlog_tx_rollback(l);
-				goto done;
-			}
+		if (xlog_write_rows(l, req->rows, req->n_rows) < 0) {
+			/*
+			 * Rollback all un-written rows
+			 */
+			xlog_tx_rollback(l);
+			goto done;
 		}
 		int rc = xlog_tx_commit(l);
 		if (rc < 0) {
@@ -589,6 +669,7 @@ done:
 		stailq_splice(&wal_msg->commit, &req->fifo, &wal_msg->rollback);
 		wal_writer_begin_rollback(writer);
 	}
+	wal_prepare_spare(writer);
 	fiber_gc();
 	wal_notify_watchers(writer);
 }
@@ -610,6 +691,12 @@ wal_writer_f(va_list ap)
 		xlog_close(&writer->current_wal, false);
 		writer->is_active = false;
 	}
+	while (writer->spare_f != NULL)
+		ipc_cond_wait(&writer->spare_cond);
+	if (writer->spare_fd >= 0) {
+		xdir_destroy_spare(&writer->wal_dir, writer->spare_fd);
+		writer->spare_fd = -1;
+	}
 	return 0;
 }
 
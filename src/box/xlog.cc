@@ -31,6 +31,7 @@
 #include "xlog.h"
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/statvfs.h>
 #include <ctype.h>
 
 #include "fiber.h"
@@ -41,9 +42,11 @@
 #include "scoped_guard.h"
 
 #include "coeio_file.h"
+#include "coeio.h"
 
 #include "error.h"
 #include "xrow.h"
+#include "xstream.h"
 #include "iproto_constants.h"
 #include "errinj.h"
 
@@ -183,7 +186,7 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 	const char *pos = (const char *)*data;
 
 	/*
-	 * Parse filetype, i.e "SNAP" or "XLOG"
+	 * Parse filetype, i.e "SNAP", "XLOG" or "DELTA"
 	 */
 	const char *eol = (const char *)memchr(pos, '\n', end - pos);
 	if (eol == end || (eol - pos) >= (ptrdiff_t) sizeof(meta->filetype)) {
@@ -305,6 +308,12 @@ xdir_create(struct xdir *dir, const char *dirname,
 		dir->panic_if_error = true;
 		dir->suffix = INPROGRESS;
 		dir->sync_interval = SNAP_SYNC_INTERVAL;
+	} else if (type == DELTA) {
+		dir->filetype = "DELTA";
+		dir->filename_ext = ".delta";
+		dir->panic_if_error = true;
+		dir->suffix = INPROGRESS;
+		dir->sync_interval = SNAP_SYNC_INTERVAL;
 	} else {
 		dir->sync_is_async = true;
 		dir->filetype = "XLOG";
@@ -642,9 +651,15 @@ xlog_rename(struct xlog *l)
 	return 0;
 }
 
-int
-xlog_create(struct xlog *xlog, const char *name,
-	    const struct xlog_meta *meta)
+/**
+ * Create a new xlog. If @a spare_fd is not negative, the file
+ * @a spare_name open with it is renamed and used instead of
+ * creating a new one. The spare is consumed in any case.
+ */
+static int
+xlog_create_impl(struct xlog *xlog, const char *name,
+		 const struct xlog_meta *meta,
+		 int spare_fd, const char *spare_name)
 {
 	char meta_buf[XLOG_META_LEN_MAX];
 	int meta_len;
@@ -656,7 +671,7 @@ xlog_create(struct xlog *xlog, const char *name,
 	if (access(name, F_OK) == 0) {
 		errno = EEXIST;
 		diag_set(SystemError, "file '%s' already exists", name);
-		return -1;
+		goto error_spare;
 	}
 
 	/*
@@ -670,11 +685,32 @@ xlog_create(struct xlog *xlog, const char *name,
 	 * replication.
 	 */
 	snprintf(xlog->filename, PATH_MAX, "%s%s", name, inprogress_suffix);
-	xlog->fd = open(xlog->filename, O_RDWR | O_CREAT | O_EXCL, 0644);
-	if (xlog->fd < 0) {
-		say_syserror("open, [%s]", name);
-		diag_set(SystemError, "failed to create file '%s'", name);
-		goto error;
+	if (spare_fd >= 0) {
+		/* Unlike open(O_EXCL), rename() replaces the target. */
+		if (access(xlog->filename, F_OK) == 0) {
+			errno = EEXIST;
+			diag_set(SystemError, "file '%s' already exists",
+				 xlog->filename);
+			goto error_spare;
+		}
+		if (rename(spare_name, xlog->filename) != 0) {
+			say_syserror("can't rename %s to %s", spare_name,
+				     xlog->filename);
+			diag_set(SystemError, "failed to rename '%s' file",
+				 spare_name);
+			goto error_spare;
+		}
+		xlog->fd = spare_fd;
+		xlog->is_preallocated = true;
+	} else {
+		xlog->fd = open(xlog->filename,
+				O_RDWR | O_CREAT | O_EXCL, 0644);
+		if (xlog->fd < 0) {
+			say_syserror("open, [%s]", name);
+			diag_set(SystemError, "failed to create file '%s'",
+				 name);
+			goto error;
+		}
 	}
 
 	xlog->meta = *meta;
@@ -719,15 +755,87 @@ error:
 		ZSTD_freeCCtx(xlog->zctx);
 
 	return -1;
+error_spare:
+	if (spare_fd >= 0) {
+		close(spare_fd);
+		unlink(spare_name);
+	}
+	return -1;
+}
+
+int
+xlog_create(struct xlog *xlog, const char *name,
+	    const struct xlog_meta *meta)
+{
+	return xlog_create_impl(xlog, name, meta, -1, NULL);
+}
+
+/** The name of the spare file of a directory. */
+static char *
+xdir_spare_filename(struct xdir *dir)
+{
+	static __thread char filename[PATH_MAX + 1];
+	snprintf(filename, PATH_MAX, "%s/spare%s%s", dir->dirname,
+		 dir->filename_ext, inprogress_suffix);
+	return filename;
+}
+
+int
+xdir_create_spare(struct xdir *dir, off_t size)
+{
+	char *filename = xdir_spare_filename(dir);
+	int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to create file '%s'", filename);
+		return -1;
+	}
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_KEEP_SIZE)
+	/*
+	 * Allocate the blocks but keep the file size, so that
+	 * readers following the xlog never see the zeros past
+	 * the last written row.
+	 */
+	struct statvfs st;
+	if (fstatvfs(fd, &st) == 0) {
+		/* Leave most of the free space to the others */
+		off_t avail = (off_t) st.f_bavail * st.f_frsize / 4;
+		size = MIN(size, avail);
+	}
+	if (size > 0 && fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) != 0 &&
+	    errno != EOPNOTSUPP) {
+		say_syserror("%s: fallocate() failed", filename);
+		/* Give back the blocks allocated before the failure */
+		if (ftruncate(fd, 0) != 0) {
+			diag_set(SystemError, "%s: ftruncate() failed",
+				 filename);
+			close(fd);
+			unlink(filename);
+			return -1;
+		}
+	}
+#else
+	(void) size;
+#endif /* HAVE_FALLOCATE */
+	return fd;
+}
+
+void
+xdir_destroy_spare(struct xdir *dir, int fd)
+{
+	char *filename = xdir_spare_filename(dir);
+	if (close(fd) < 0)
+		say_syserror("%s: close() failed", filename);
+	if (unlink(filename) < 0)
+		say_syserror("%s: unlink() failed", filename);
 }
 
 /**
  * In case of error, writes a message to the server log
  * and sets errno.
  */
-int
-xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
-		 const struct vclock *vclock)
+static int
+xdir_create_xlog_impl(struct xdir *dir, struct xlog *xlog,
+		      const struct vclock *vclock, int spare_fd)
 {
 	char *filename;
 	int64_t signature = vclock_sum(vclock);
@@ -746,7 +854,9 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	meta.server_uuid = *dir->server_uuid;
 	vclock_copy(&meta.vclock, vclock);
 
-	if (xlog_create(xlog, filename, &meta) != 0)
+	if (xlog_create_impl(xlog, filename, &meta, spare_fd,
+			     spare_fd >= 0 ? xdir_spare_filename(dir) :
+			     NULL) != 0)
 		return -1;
 
 	/* set sync interval from xdir settings */
@@ -763,6 +873,21 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	return 0;
 }
 
+int
+xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
+		 const struct vclock *vclock)
+{
+	return xdir_create_xlog_impl(dir, xlog, vclock, -1);
+}
+
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock, int spare_fd)
+{
+	assert(spare_fd >= 0);
+	return xdir_create_xlog_impl(dir, xlog, vclock, spare_fd);
+}
+
 /**
  * Write a sequence of uncompressed xrow objects.
  *
@@ -978,20 +1103,49 @@ xlog_tx_write(struct xlog *log)
 	return written;
 }
 
-/*
- * Add a row to a log and possibly flush the log.
+/**
+ * Encode a row straight into the xlog buffer: reserve space
+ * for the whole row, write the header in place and copy the
+ * body after it.
  *
  * @retval  -1 error, check diag.
  * @retval >=0 the number of bytes written to buffer.
  */
-ssize_t
-xlog_write_row(struct xlog *log, const struct xrow_header *packet)
+static ssize_t
+xlog_encode_row(struct xlog *log, const struct xrow_header *packet)
+{
+	size_t size = XROW_HEADER_LEN_MAX + xrow_body_len(packet);
+	char *data = (char *) obuf_reserve(&log->obuf, size);
+	if (data == NULL) {
+		tnt_error(OutOfMemory, size,
+			  "runtime arena", "xlog tx output buffer");
+		return -1;
+	}
+	char *pos = xrow_header_encode_buf(packet, data);
+	for (int i = 0; i < packet->bodycnt; i++) {
+		memcpy(pos, packet->body[i].iov_base, packet->body[i].iov_len);
+		pos += packet->body[i].iov_len;
+	}
+	/* Leave a part of the row in the buffer. */
+	ERROR_INJECT(ERRINJ_WAL_WRITE_PARTIAL,
+		{if (obuf_size(&log->obuf) > (1 << 14)) {
+			obuf_alloc(&log->obuf, (pos - data) / 2);
+			tnt_error(ClientError, ER_INJECTION,
+				  "xlog write injection");
+			return -1;}});
+	/* Can't fail: the space has just been reserved. */
+	obuf_alloc(&log->obuf, pos - data);
+	return pos - data;
+}
+
+/**
+ * Automatically reserve space for a fixheader when adding
+ * the first row in a log. The fixheader is populated
+ * at write. @sa xlog_tx_write().
+ */
+static int
+xlog_reserve_fixheader(struct xlog *log)
 {
-	/*
-	 * Automatically reserve space for a fixheader when adding
-	 * the first row in * a log. The fixheader is populated
-	 * at write. @sa xlog_tx_write().
-	 */
 	if (obuf_size(&log->obuf) == 0) {
 		if (!obuf_alloc(&log->obuf, XLOG_FIXHEADER_SIZE)) {
 			tnt_error(OutOfMemory, XLOG_FIXHEADER_SIZE,
@@ -999,35 +1153,63 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 			return -1;
 		}
 	}
+	return 0;
+}
 
-	size_t page_offset = obuf_size(&log->obuf);
-	/** encode row into iovec */
-	struct iovec iov[XROW_IOVMAX];
-	int iovcnt = xrow_header_encode(packet, iov, 0);
+/*
+ * Add a row to a log and possibly flush the log.
+ *
+ * @retval  -1 error, check diag. The row is rolled back.
+ * @retval >=0 the number of bytes written to buffer.
+ */
+ssize_t
+xlog_write_row(struct xlog *log, const struct xrow_header *packet)
+{
+	if (xlog_reserve_fixheader(log) < 0)
+		return -1;
 	struct obuf_svp svp = obuf_create_svp(&log->obuf);
-	for (int i = 0; i < iovcnt; ++i) {
-		ERROR_INJECT(ERRINJ_WAL_WRITE_PARTIAL,
-			{if (obuf_size(&log->obuf) > (1 << 14)) {
-				tnt_error(ClientError, ER_INJECTION, "xlog write injection");
-				obuf_rollback_to_svp(&log->obuf, &svp);
-				return -1;}});
-		if (obuf_dup(&log->obuf, iov[i].iov_base, iov[i].iov_len) <
-		    iov[i].iov_len) {
-			tnt_error(OutOfMemory, XLOG_FIXHEADER_SIZE,
-				  "runtime arena", "xlog tx output buffer");
+	ssize_t row_size = xlog_encode_row(log, packet);
+	if (row_size < 0) {
+		obuf_rollback_to_svp(&log->obuf, &svp);
+		return -1;
+	}
+	if (log->is_autocommit &&
+	    obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD &&
+	    xlog_tx_write(log) < 0)
+		return -1;
+
+	return row_size;
+}
+
+/*
+ * Add rows of a single transaction to a log, and possibly
+ * flush the log after the last one.
+ *
+ * @retval  -1 error, check diag. Rows written so far are
+ *             rolled back.
+ * @retval >=0 the number of bytes written to buffer.
+ */
+ssize_t
+xlog_write_rows(struct xlog *log, struct xrow_header **rows, int row_count)
+{
+	if (xlog_reserve_fixheader(log) < 0)
+		return -1;
+	struct obuf_svp svp = obuf_create_svp(&log->obuf);
+	ssize_t total = 0;
+	for (int i = 0; i < row_count; i++) {
+		ssize_t row_size = xlog_encode_row(log, rows[i]);
+		if (row_size < 0) {
 			obuf_rollback_to_svp(&log->obuf, &svp);
 			return -1;
 		}
+		total += row_size;
 	}
-	assert(iovcnt <= XROW_IOVMAX);
-
-	size_t row_size = obuf_size(&log->obuf) - page_offset;
 	if (log->is_autocommit &&
 	    obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD &&
 	    xlog_tx_write(log) < 0)
 		return -1;
 
-	return row_size;
+	return total;
 }
 
 /**
@@ -1119,6 +1301,13 @@ xlog_close(struct xlog *l, bool reuse_fd)
 	int rc = fio_writen(l->fd, &eof_marker, sizeof(log_magic_t));
 	if (rc < 0)
 		say_syserror("%s: failed to write EOF marker", l->filename);
+	/*
+	 * Give back the disk space preallocated past the end
+	 * of the file.
+	 */
+	if (rc >= 0 && l->is_preallocated &&
+	    ftruncate(l->fd, l->offset + sizeof(log_magic_t)) != 0)
+		say_syserror("%s: ftruncate() failed", l->filename);
 
 	/*
 	 * Sync the file before closing, since
@@ -1476,6 +1665,29 @@ xlog_tx_cursor_destroy(struct xlog_tx_cursor *tx_cursor)
 	return 0;
 }
 
+void
+xlog_tx_chunk_write_xc(const char *data, const char *data_end,
+		       ZSTD_DStream *zdctx, struct xstream *stream)
+{
+	while (data < data_end) {
+		struct xlog_tx_cursor tx_cursor;
+		ssize_t rc = xlog_tx_cursor_create(&tx_cursor, &data,
+						   data_end, zdctx);
+		if (rc < 0)
+			diag_raise();
+		if (rc > 0)
+			tnt_raise(XlogError, "truncated xlog tx chunk");
+		auto tx_guard = make_scoped_guard([&]{
+			xlog_tx_cursor_destroy(&tx_cursor);
+		});
+		struct xrow_header row;
+		while ((rc = xlog_tx_cursor_next_row(&tx_cursor, &row)) == 0)
+			xstream_write(stream, &row);
+		if (rc < 0)
+			diag_raise();
+	}
+}
+
 /**
  * Find a next xlog tx magic
  */
@@ -1502,6 +1714,32 @@ xlog_cursor_find_tx_magic(struct xlog_cursor *i)
 	return 0;
 }
 
+/**
+ * Handle the end of data in the read buffer: if the eof marker
+ * has been read, check that there is nothing after it.
+ *
+ * @retval 1 eof
+ * @retval -1 error, check diag
+ */
+static int
+xlog_cursor_eof(struct xlog_cursor *i)
+{
+	if (i->eof_read) {
+		/* eof marker readen, check that no more data in file */
+		int rc = xlog_cursor_ensure(i, sizeof(log_magic_t) +
+					    sizeof(char));
+		if (rc < 0)
+			return -1;
+		if (rc == 0) {
+			tnt_error(XlogError, "%s: has some data after "
+				  "eof marker at %lld", i->name,
+				  xlog_cursor_pos(i));
+			return -1;
+		}
+	}
+	return 1;
+}
+
 int
 xlog_cursor_next_tx(struct xlog_cursor *i)
 {
@@ -1517,7 +1755,7 @@ xlog_cursor_next_tx(struct xlog_cursor *i)
 	if (load_u32(i->rbuf.rpos) == eof_marker) {
 		/* eof marker found */
 		i->eof_read = true;
-		goto eof;
+		return xlog_cursor_eof(i);
 	}
 
 	ssize_t to_load;
@@ -1529,28 +1767,65 @@ xlog_cursor_next_tx(struct xlog_cursor *i)
 		if (rc < 0)
 			return -1;
 		if (rc > 0)
-			goto eof;
+			return xlog_cursor_eof(i);
 	}
 	if (to_load < 0)
 		return -1;
 
 	i->is_opened = true;
 	return 0;
-eof:
-	if (i->eof_read) {
-		/* eof marker readen, check that no more data in file */
-		rc = xlog_cursor_ensure(i, sizeof(log_magic_t) + sizeof(char));
+}
 
-		if (rc < 0)
-			return -1;
-		if (rc == 0) {
-			tnt_error(XlogError, "%s: has some data after "
-				  "eof marker at %lld", i->name,
-				  xlog_cursor_pos(i));
+int
+xlog_cursor_next_raw_tx(struct xlog_cursor *i, const char **data,
+			const char **data_end)
+{
+	int rc;
+	assert(i->eof_read == false);
+	assert(i->is_opened == false);
+
+	/* load at least magic to check eof */
+	rc = xlog_cursor_ensure(i, sizeof(log_magic_t));
+	if (rc < 0)
+		return -1;
+	if (rc > 0)
+		return 1;
+	if (load_u32(i->rbuf.rpos) == eof_marker) {
+		/* eof marker found */
+		i->eof_read = true;
+		return xlog_cursor_eof(i);
+	}
+
+	struct xlog_fixheader fixheader;
+	const char *rpos;
+	while (true) {
+		rpos = i->rbuf.rpos;
+		ssize_t to_load = xlog_fixheader_decode(&fixheader, &rpos,
+							i->rbuf.wpos);
+		if (to_load < 0)
 			return -1;
+		if (to_load == 0) {
+			ptrdiff_t avail = i->rbuf.wpos - rpos;
+			if (avail >= (ptrdiff_t)fixheader.len)
+				break;
+			to_load = fixheader.len - avail;
 		}
+		/* not enough data in read buffer */
+		rc = xlog_cursor_ensure(i, ibuf_used(&i->rbuf) + to_load);
+		if (rc < 0)
+			return -1;
+		if (rc > 0)
+			return xlog_cursor_eof(i);
 	}
-	return 1;
+	/*
+	 * The checksum is not validated here: the block is
+	 * going to be decoded by xlog_tx_cursor_create(),
+	 * which does it anyway.
+	 */
+	*data = i->rbuf.rpos;
+	*data_end = rpos + fixheader.len;
+	i->rbuf.rpos = (char *) *data_end;
+	return 0;
 }
 
 int
@@ -1675,3 +1950,342 @@ xlog_cursor_close(struct xlog_cursor *i, bool reuse_fd)
 }
 
 /* }}} */
+
+/* {{{ struct xlog_prefetch */
+
+enum {
+	/** How many bytes of a file to read ahead at once. */
+	XLOG_PREFETCH_CHUNK_SIZE = 1 << 20,
+};
+
+/**
+ * A chunk of txs read and decompressed in a coeio thread.
+ */
+struct xlog_prefetch_task {
+	struct coio_task base;
+	/**
+	 * The file to read, a duplicate of the cursor descriptor
+	 * owned by the task: a detached task may still be reading
+	 * after the cursor is closed.
+	 */
+	int fd;
+	/** The file offset of the chunk. */
+	off_t offset;
+	/** The file offset after the last complete tx read. */
+	off_t end;
+	/**
+	 * Set if there is nothing to prefetch past the end of
+	 * the chunk: the eof marker, a broken or a partially
+	 * written tx has been met.
+	 */
+	bool is_last;
+	/** Raw file data. */
+	char *buf;
+	size_t buf_capacity;
+	/** Decoded rows of the txs. */
+	char *rows;
+	size_t rows_size;
+	size_t rows_capacity;
+	/** Decompression context. */
+	ZSTD_DStream *zdctx;
+};
+
+static int
+xlog_prefetch_task_delete(struct coio_task *base)
+{
+	struct xlog_prefetch_task *task = (struct xlog_prefetch_task *) base;
+	if (task->fd >= 0)
+		close(task->fd);
+	free(task->buf);
+	free(task->rows);
+	ZSTD_freeDStream(task->zdctx);
+	coio_task_destroy(&task->base);
+	free(task);
+	return 0;
+}
+
+static int
+xlog_prefetch_task_f(struct coio_task *base);
+
+static struct xlog_prefetch_task *
+xlog_prefetch_task_new(int fd)
+{
+	struct xlog_prefetch_task *task = (struct xlog_prefetch_task *)
+		calloc(1, sizeof(*task));
+	if (task == NULL)
+		return NULL;
+	task->zdctx = ZSTD_createDStream();
+	if (task->zdctx == NULL) {
+		free(task);
+		return NULL;
+	}
+	task->fd = dup(fd);
+	if (task->fd < 0) {
+		ZSTD_freeDStream(task->zdctx);
+		free(task);
+		return NULL;
+	}
+	coio_task_create(&task->base, xlog_prefetch_task_f,
+			 xlog_prefetch_task_delete);
+	return task;
+}
+
+/** Grow a buffer to fit at least @a size bytes. */
+static int
+xlog_prefetch_reserve(char **buf, size_t *capacity, size_t size)
+{
+	if (size <= *capacity)
+		return 0;
+	size_t new_capacity = MAX(*capacity * 2, size);
+	char *new_buf = (char *) realloc(*buf, new_capacity);
+	if (new_buf == NULL) {
+		diag_set(OutOfMemory, new_capacity, "realloc",
+			 "xlog prefetch buffer");
+		return -1;
+	}
+	*buf = new_buf;
+	*capacity = new_capacity;
+	return 0;
+}
+
+/**
+ * Check and decompress a tx into the rows buffer.
+ * @sa xlog_tx_cursor_create().
+ */
+static int
+xlog_prefetch_decode_tx(struct xlog_prefetch_task *task,
+			const struct xlog_fixheader *fixheader,
+			const char *data)
+{
+	const char *data_end = data + fixheader->len;
+	if (crc32_calc(0, data, fixheader->len) != fixheader->crc32c) {
+		tnt_error(XlogError, "tx checksum mismatch");
+		return -1;
+	}
+	if (fixheader->magic == row_marker) {
+		if (xlog_prefetch_reserve(&task->rows, &task->rows_capacity,
+					  task->rows_size + fixheader->len) != 0)
+			return -1;
+		memcpy(task->rows + task->rows_size, data, fixheader->len);
+		task->rows_size += fixheader->len;
+		return 0;
+	}
+	assert(fixheader->magic == zrow_marker);
+	ZSTD_initDStream(task->zdctx);
+	size_t rows_size = task->rows_size;
+	int rc;
+	do {
+		if (xlog_prefetch_reserve(&task->rows, &task->rows_capacity,
+					  rows_size +
+					  XLOG_TX_AUTOCOMMIT_THRESHOLD) != 0)
+			return -1;
+		char *rows = task->rows + rows_size;
+		rc = xlog_cursor_decompress(&rows,
+					    task->rows + task->rows_capacity,
+					    &data, data_end, task->zdctx);
+		rows_size = rows - task->rows;
+	} while (rc == 1);
+	if (rc != 0)
+		return -1;
+	/* Commit the rows only once the whole tx is decoded. */
+	task->rows_size = rows_size;
+	return 0;
+}
+
+/** Read and decode a chunk of txs, runs in a coeio thread. */
+static int
+xlog_prefetch_task_f(struct coio_task *base)
+{
+	struct xlog_prefetch_task *task = (struct xlog_prefetch_task *) base;
+	task->end = task->offset;
+	task->is_last = false;
+	task->rows_size = 0;
+
+	size_t size = XLOG_PREFETCH_CHUNK_SIZE;
+	const char *pos, *end;
+	ssize_t to_load;
+	ssize_t n;
+	while (true) {
+		if (xlog_prefetch_reserve(&task->buf, &task->buf_capacity,
+					  size) != 0)
+			return -1;
+		n = fio_pread(task->fd, task->buf, size, task->offset);
+		if (n < 0) {
+			diag_set(SystemError, "failed to read xlog file");
+			return -1;
+		}
+		pos = task->buf;
+		end = task->buf + n;
+		to_load = 0;
+		while (end - pos >= (ptrdiff_t) sizeof(log_magic_t)) {
+			if (load_u32(pos) == eof_marker) {
+				task->is_last = true;
+				break;
+			}
+			struct xlog_fixheader fixheader;
+			const char *data = pos;
+			to_load = xlog_fixheader_decode(&fixheader,
+							&data, end);
+			if (to_load == 0 &&
+			    end - data < (ptrdiff_t) fixheader.len)
+				to_load = fixheader.len - (end - data);
+			if (to_load != 0)
+				break;
+			if (xlog_prefetch_decode_tx(task, &fixheader,
+						    data) != 0) {
+				to_load = -1;
+				break;
+			}
+			pos = data + fixheader.len;
+		}
+		if (pos > task->buf || task->is_last || to_load < 0 ||
+		    (size_t) n < size)
+			break;
+		/* The first tx doesn't fit in the chunk, read more. */
+		size += to_load > 0 ? to_load : sizeof(log_magic_t);
+	}
+	if (to_load < 0) {
+		/* Leave the broken tx to the cursor. */
+		diag_clear(diag_get());
+		task->is_last = true;
+	}
+	if ((size_t) n < size) {
+		/* Reached the end of the data written so far. */
+		task->is_last = true;
+	}
+	task->end = task->offset + (pos - task->buf);
+	return 0;
+}
+
+/** Make a cursor continue reading from a file offset. */
+static void
+xlog_cursor_seek(struct xlog_cursor *cursor, off_t offset)
+{
+	ibuf_reset(&cursor->rbuf);
+	cursor->read_offset = offset;
+}
+
+/** Start reading the chunk at @a offset in a coeio thread. */
+static void
+xlog_prefetch_submit(struct xlog_prefetch *prefetch,
+		     struct xlog_prefetch_task *task, off_t offset)
+{
+	assert(prefetch->next == NULL);
+	coio_task_destroy(&task->base);
+	coio_task_create(&task->base, xlog_prefetch_task_f,
+			 xlog_prefetch_task_delete);
+	task->offset = offset;
+	prefetch->next = task;
+	coio_task_submit(&task->base);
+}
+
+void
+xlog_prefetch_create(struct xlog_prefetch *prefetch,
+		     struct xlog_cursor *cursor)
+{
+	assert(!cursor->is_opened && !cursor->eof_read);
+	memset(prefetch, 0, sizeof(*prefetch));
+	prefetch->cursor = cursor;
+	if (cursor->fd < 0)
+		return;
+	/*
+	 * Not critical: if out of memory or descriptors, the
+	 * cursor reads the file.
+	 */
+	struct xlog_prefetch_task *task = xlog_prefetch_task_new(cursor->fd);
+	if (task == NULL)
+		return;
+	off_t offset = xlog_cursor_pos(cursor);
+	xlog_cursor_seek(cursor, offset);
+	xlog_prefetch_submit(prefetch, task, offset);
+}
+
+/**
+ * Switch to the next chunk, start reading the one after it.
+ * @retval 0 for Ok
+ * @retval 1 no more chunks
+ */
+static int
+xlog_prefetch_next_chunk(struct xlog_prefetch *prefetch)
+{
+	struct xlog_prefetch_task *task = prefetch->current;
+	struct xlog_prefetch_task *next = prefetch->next;
+	prefetch->current = NULL;
+	prefetch->next = NULL;
+	if (task != NULL) {
+		/* All rows of the chunk are returned, move past it. */
+		xlog_cursor_seek(prefetch->cursor, task->end);
+	}
+	if (next == NULL) {
+		if (task != NULL)
+			xlog_prefetch_task_delete(&task->base);
+		return 1;
+	}
+	if (coio_task_wait(&next->base, TIMEOUT_INFINITY) != 0) {
+		/* The task is detached and will free itself. */
+		diag_clear(diag_get());
+		if (task != NULL)
+			xlog_prefetch_task_delete(&task->base);
+		return 1;
+	}
+	if (next->base.base.result != 0) {
+		/* Let the cursor read the file and report the error. */
+		if (task != NULL)
+			xlog_prefetch_task_delete(&task->base);
+		xlog_prefetch_task_delete(&next->base);
+		return 1;
+	}
+	/* Reuse the buffers of the processed chunk. */
+	if (task == NULL && !next->is_last)
+		task = xlog_prefetch_task_new(next->fd);
+	if (task != NULL && !next->is_last)
+		xlog_prefetch_submit(prefetch, task, next->end);
+	else if (task != NULL)
+		xlog_prefetch_task_delete(&task->base);
+	prefetch->current = next;
+	prefetch->rpos = next->rows;
+	return 0;
+}
+
+int
+xlog_prefetch_next_row(struct xlog_prefetch *prefetch,
+		       struct xrow_header *xrow)
+{
+	struct xlog_prefetch_task *task = prefetch->current;
+	while (task == NULL || prefetch->rpos == task->rows + task->rows_size) {
+		if (xlog_prefetch_next_chunk(prefetch) != 0)
+			return 1;
+		task = prefetch->current;
+	}
+	const char *rpos = prefetch->rpos;
+	if (xrow_header_decode(xrow, &rpos,
+			       task->rows + task->rows_size) != 0) {
+		/* Let the cursor read the chunk and report the error. */
+		diag_clear(diag_get());
+		xlog_prefetch_destroy(prefetch);
+		return 1;
+	}
+	prefetch->rpos = rpos;
+	return 0;
+}
+
+void
+xlog_prefetch_destroy(struct xlog_prefetch *prefetch)
+{
+	struct xlog_prefetch_task *task = prefetch->current;
+	if (task != NULL) {
+		/*
+		 * Not all rows of the chunk may have been processed,
+		 * the cursor will return them again.
+		 */
+		xlog_cursor_seek(prefetch->cursor, task->offset);
+		xlog_prefetch_task_delete(&task->base);
+		prefetch->current = NULL;
+	}
+	task = prefetch->next;
+	if (task != NULL && coio_task_detach(&task->base) == 0)
+		xlog_prefetch_task_delete(&task->base);
+	prefetch->next = NULL;
+}
+
+/* }}} */
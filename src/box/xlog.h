@@ -58,7 +58,15 @@ extern const struct type type_XlogError;
  * used for logs and snapshots, but an xlog object sees only
  * those files which match its type.
  */
-enum xdir_type { SNAP, XLOG };
+enum xdir_type {
+	SNAP,
+	XLOG,
+	/**
+	 * An incremental snapshot: the changes made since
+	 * the previous snapshot, full or incremental.
+	 */
+	DELTA
+};
 
 /**
  * Newly created snapshot files get .inprogress filename suffix.
@@ -258,6 +266,12 @@ struct xlog {
 	 * synced file size
 	 */
 	uint64_t synced_size;
+	/**
+	 * true if the file was created from a spare with
+	 * disk space allocated beyond its end, which must
+	 * be given back at close.
+	 */
+	bool is_preallocated;
 };
 
 /**
@@ -278,6 +292,40 @@ int
 xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 		 const struct vclock *vclock);
 
+/**
+ * Create a spare file in the directory, to be turned into
+ * the next xlog by xdir_create_xlog_from_spare(), and
+ * preallocate @a size bytes of disk space for it, if
+ * supported by the file system, but no more than a quarter of
+ * the free space. The spare is invisible to
+ * xdir_scan(). A stale spare left by a crash is truncated.
+ *
+ * Does not yield and may be called from a coeio thread.
+ *
+ * @retval >= 0 a file descriptor of the spare
+ * @retval -1 if error
+ */
+int
+xdir_create_spare(struct xdir *dir, off_t size);
+
+/**
+ * Close and remove an unused spare file.
+ */
+void
+xdir_destroy_spare(struct xdir *dir, int fd);
+
+/**
+ * Same as xdir_create_xlog(), but reuse a spare file
+ * created by xdir_create_spare() instead of creating a new
+ * one. The spare is consumed even if the function fails.
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+xdir_create_xlog_from_spare(struct xdir *dir, struct xlog *xlog,
+			    const struct vclock *vclock, int spare_fd);
+
 /**
  * Create new xlog writer based on fd.
  * @param fd            file descriptor
@@ -310,6 +358,17 @@ xlog_rename(struct xlog *l);
 ssize_t
 xlog_write_row(struct xlog *log, const struct xrow_header *packet);
 
+/**
+ * Write rows of one transaction to xlog, without a flush
+ * in between. Cheaper than calling xlog_write_row() for
+ * each row.
+ *
+ * @retval count of writen bytes
+ * @retval -1 for error
+ */
+ssize_t
+xlog_write_rows(struct xlog *log, struct xrow_header **rows, int row_count);
+
 /**
  * Prevent xlog row buffer offloading, should be use
  * at transaction start to write transaction in one xlog tx
@@ -502,6 +561,23 @@ xlog_cursor_close(struct xlog_cursor *cursor, bool reuse_fd);
 int
 xlog_cursor_next_tx(struct xlog_cursor *cursor);
 
+/**
+ * Read next tx from xlog as is, without decompressing it.
+ * The returned block starts with the tx fixheader and stays
+ * valid until the next call on the cursor. Its checksum is
+ * not checked.
+ *
+ * @param cursor cursor
+ * @param[out] data the beginning of the raw tx
+ * @param[out] data_end the end of the raw tx
+ * @retval 0 succes
+ * @retval 1 eof
+ * retval -1 error, check diag
+ */
+int
+xlog_cursor_next_raw_tx(struct xlog_cursor *cursor, const char **data,
+			const char **data_end);
+
 /**
  * Fetch next xrow from current xlog tx
  *
@@ -524,6 +600,62 @@ xlog_cursor_find_tx_magic(struct xlog_cursor *i);
 
 /* }}} */
 
+/* {{{ xlog_prefetch - decode rows of a log file ahead */
+
+struct xlog_prefetch_task;
+
+/**
+ * Read ahead for an xlog cursor: the txs following the cursor
+ * position are read, checked and decompressed in a coeio thread
+ * one chunk ahead of the caller, so that disk reads and
+ * decompression overlap with processing of the rows.
+ *
+ * Only complete valid txs are prefetched. Prefetch stops at the
+ * eof marker, at the end of the data written so far or at the
+ * first broken tx, and leaves the rest of the file to the cursor,
+ * which handles it the usual way.
+ */
+struct xlog_prefetch {
+	/** The cursor to read ahead. */
+	struct xlog_cursor *cursor;
+	/** The chunk whose rows are being returned. */
+	struct xlog_prefetch_task *current;
+	/** The chunk being read in a coeio thread. */
+	struct xlog_prefetch_task *next;
+	/** The next row in the current chunk. */
+	const char *rpos;
+};
+
+/**
+ * Start reading ahead from the current position of a cursor.
+ * The cursor must be open on a file and must not be inside
+ * a tx. It must not be used until xlog_prefetch_destroy().
+ */
+void
+xlog_prefetch_create(struct xlog_prefetch *prefetch,
+		     struct xlog_cursor *cursor);
+
+/**
+ * Fetch the next prefetched row. The row is valid until the
+ * next call.
+ *
+ * @retval 0 for Ok
+ * @retval 1 no more rows, continue with the cursor
+ */
+int
+xlog_prefetch_next_row(struct xlog_prefetch *prefetch,
+		       struct xrow_header *xrow);
+
+/**
+ * Stop reading ahead. The cursor is positioned after the
+ * last chunk returned in full: rows of an incomplete chunk
+ * are going to be read by the cursor again.
+ */
+void
+xlog_prefetch_destroy(struct xlog_prefetch *prefetch);
+
+/* }}} */
+
 /** {{{ miscellaneous log io functions. */
 
 /**
@@ -569,6 +701,17 @@ struct XlogGapError: public XlogError
 	virtual void raise() { throw this; }
 };
 
+struct xstream;
+
+/**
+ * Decode a chunk of raw xlog txs, as they are stored in an
+ * xlog file, and write all their rows to a stream.
+ * Raises on a broken or truncated tx.
+ */
+void
+xlog_tx_chunk_write_xc(const char *data, const char *data_end,
+		       ZSTD_DStream *zdctx, struct xstream *stream);
+
 static inline void
 xdir_scan_xc(struct xdir *dir)
 {
@@ -41,7 +41,7 @@
 #include "scramble.h"
 #include "iproto_constants.h"
 
-enum { HEADER_LEN_MAX = 40, BODY_LEN_MAX = 128 };
+enum { HEADER_LEN_MAX = XROW_HEADER_LEN_MAX, BODY_LEN_MAX = 128 };
 
 int
 xrow_header_decode(struct xrow_header *header, const char **pos,
@@ -120,22 +120,10 @@ error:
 	*pos += len;
 }
 
-int
-xrow_header_encode(const struct xrow_header *header, struct iovec *out,
-		   size_t fixheader_len)
+char *
+xrow_header_encode_buf(const struct xrow_header *header, char *pos)
 {
-	/* allocate memory for sign + header */
-	out->iov_base = region_alloc(&fiber()->gc, HEADER_LEN_MAX +
-				     fixheader_len);
-	if (out->iov_base == NULL) {
-		diag_set(OutOfMemory, HEADER_LEN_MAX + fixheader_len,
-			 "gc arena", "xrow header encode");
-		return -1;
-	}
-	char *data = (char *) out->iov_base + fixheader_len;
-
-	/* Header */
-	char *d = data + 1; /* Skip 1 byte for MP_MAP */
+	char *d = pos + 1; /* Skip 1 byte for MP_MAP */
 	int map_size = 0;
 	if (true) {
 		d = mp_encode_uint(d, IPROTO_REQUEST_TYPE);
@@ -167,8 +155,25 @@ xrow_header_encode(const struct xrow_header *header, struct iovec *out,
 		d = mp_encode_double(d, header->tm);
 		map_size++;
 	}
-	assert(d <= data + HEADER_LEN_MAX);
-	mp_encode_map(data, map_size);
+	assert(d <= pos + HEADER_LEN_MAX);
+	mp_encode_map(pos, map_size);
+	return d;
+}
+
+int
+xrow_header_encode(const struct xrow_header *header, struct iovec *out,
+		   size_t fixheader_len)
+{
+	/* allocate memory for sign + header */
+	out->iov_base = region_alloc(&fiber()->gc, HEADER_LEN_MAX +
+				     fixheader_len);
+	if (out->iov_base == NULL) {
+		diag_set(OutOfMemory, HEADER_LEN_MAX + fixheader_len,
+			 "gc arena", "xrow header encode");
+		return -1;
+	}
+	char *data = (char *) out->iov_base + fixheader_len;
+	char *d = xrow_header_encode_buf(header, data);
 	out->iov_len = d - (char *) out->iov_base;
 	out++;
 
@@ -195,7 +200,7 @@ request_decode(struct request *request, const char *data, uint32_t len)
 {
 	const char *end = data + len;
 	/** Advanced requests don't have a defined key map. */
-	assert(request->type <= IPROTO_CALL);
+	assert(request->type < IPROTO_TYPE_STAT_MAX);
 	uint64_t key_map = iproto_body_key_map[request->type];
 
 	if (mp_typeof(*data) != MP_MAP || mp_check_map(data, end) > 0) {
@@ -529,17 +534,23 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *cluster_uuid,
 }
 
 void
-xrow_encode_join(struct xrow_header *row, const struct tt_uuid *server_uuid)
+xrow_encode_join(struct xrow_header *row, const struct tt_uuid *server_uuid,
+		 bool xlog_tx_chunks)
 {
 	memset(row, 0, sizeof(*row));
 
 	size_t size = 64;
 	char *buf = (char *) region_alloc_xc(&fiber()->gc, size);
 	char *data = buf;
-	data = mp_encode_map(data, 1);
+	data = mp_encode_map(data, xlog_tx_chunks ? 2 : 1);
 	data = mp_encode_uint(data, IPROTO_SERVER_UUID);
 	/* Greet the remote server with our server UUID */
 	data = xrow_encode_uuid(data, server_uuid);
+	if (xlog_tx_chunks) {
+		/* Older masters skip unknown keys */
+		data = mp_encode_uint(data, IPROTO_XLOG_TX_CHUNKS);
+		data = mp_encode_bool(data, true);
+	}
 	assert(data <= buf + size);
 
 	row->body[0].iov_base = buf;
@@ -548,6 +559,34 @@ xrow_encode_join(struct xrow_header *row, const struct tt_uuid *server_uuid)
 	row->type = IPROTO_JOIN;
 }
 
+void
+xrow_decode_join(struct xrow_header *row, struct tt_uuid *server_uuid,
+		 bool *xlog_tx_chunks)
+{
+	xrow_decode_subscribe(row, NULL, server_uuid, NULL);
+
+	/* The body has already been checked by xrow_decode_subscribe() */
+	*xlog_tx_chunks = false;
+	const char *d = (const char *) row->body[0].iov_base;
+	uint32_t map_size = mp_decode_map(&d);
+	for (uint32_t i = 0; i < map_size; i++) {
+		if (mp_typeof(*d) != MP_UINT) {
+			mp_next(&d); /* key */
+			mp_next(&d); /* value */
+			continue;
+		}
+		if (mp_decode_uint(&d) != IPROTO_XLOG_TX_CHUNKS) {
+			mp_next(&d); /* value */
+			continue;
+		}
+		if (mp_typeof(*d) != MP_BOOL) {
+			tnt_raise(ClientError, ER_INVALID_MSGPACK,
+				  "invalid XLOG_TX_CHUNKS");
+		}
+		*xlog_tx_chunks = mp_decode_bool(&d);
+	}
+}
+
 void
 xrow_encode_vclock(struct xrow_header *row, const struct vclock *vclock)
 {
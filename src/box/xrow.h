@@ -45,6 +45,8 @@ enum {
 	XROW_HEADER_IOVMAX = 1,
 	XROW_BODY_IOVMAX = 2,
 	XROW_IOVMAX = XROW_HEADER_IOVMAX + XROW_BODY_IOVMAX,
+	/** Max size of an encoded row header, without fixheader. */
+	XROW_HEADER_LEN_MAX = 40,
 };
 
 struct xrow_header {
@@ -79,6 +81,32 @@ int
 xrow_header_encode(const struct xrow_header *header,
 		   struct iovec *out, size_t fixheader_len);
 
+/**
+ * Encode xrow header into a buffer, in a single pass and
+ * without allocating memory.
+ *
+ * @param header xrow
+ * @param pos the buffer to write to, must have space for at
+ *        least XROW_HEADER_LEN_MAX bytes
+ *
+ * @return the end of the encoded header
+ */
+char *
+xrow_header_encode_buf(const struct xrow_header *header, char *pos);
+
+/**
+ * Return the size of xrow body, i.e. the total length of
+ * its body iovecs.
+ */
+static inline size_t
+xrow_body_len(const struct xrow_header *header)
+{
+	size_t len = 0;
+	for (int i = 0; i < header->bodycnt; i++)
+		len += header->body[i].iov_len;
+	return len;
+}
+
 /**
  * Decode xrow from a binary packet
  *
@@ -307,20 +335,23 @@ xrow_decode_subscribe(struct xrow_header *row, struct tt_uuid *cluster_uuid,
  * \brief Encode JOIN command
  * \param[out] row
  * \param server_uuid
+ * \param xlog_tx_chunks true if the initial data may be sent
+ *        as IPROTO_XLOG_TX chunks
 */
 void
-xrow_encode_join(struct xrow_header *row, const struct tt_uuid *server_uuid);
+xrow_encode_join(struct xrow_header *row, const struct tt_uuid *server_uuid,
+		 bool xlog_tx_chunks);
 
 /**
  * \brief Decode JOIN command
  * \param row
  * \param[out] server_uuid
+ * \param[out] xlog_tx_chunks set to true if the replica accepts
+ *             IPROTO_XLOG_TX chunks, false if it's not aware of them
 */
-static inline void
-xrow_decode_join(struct xrow_header *row, struct tt_uuid *server_uuid)
-{
-	return xrow_decode_subscribe(row, NULL, server_uuid, NULL);
-}
+void
+xrow_decode_join(struct xrow_header *row, struct tt_uuid *server_uuid,
+		 bool *xlog_tx_chunks);
 
 /**
  * \brief Encode end of stream command (a response to JOIN command)
@@ -30,9 +30,10 @@
  */
 #include "cbus.h"
 
+#include <pmatomic.h>
+
 const char *cbus_stat_strings[CBUS_STAT_LAST] = {
 	"EVENTS",
-	"LOCKS",
 };
 
 static inline void
@@ -198,17 +199,27 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 	if (pipe->n_input == 0)
 		return;
 
-	/* Trigger task processing when the queue becomes non-empty. */
-	bool pipe_was_empty;
-
-	tt_pthread_mutex_lock(&pool->mutex);
-	pipe_was_empty = stailq_empty(&pool->pipe);
-	/** Flush input */
-	stailq_concat(&pool->pipe, &pipe->input);
-	tt_pthread_mutex_unlock(&pool->mutex);
+	/*
+	 * Flush input: the consumer pipe is a stack, so push
+	 * the batch reversed, with its oldest message at the
+	 * bottom. This takes a single compare-and-swap
+	 * regardless of the batch size.
+	 */
+	stailq_reverse(&pipe->input);
+	struct stailq_entry *first = stailq_first(&pipe->input);
+	struct stailq_entry *last = stailq_last(&pipe->input);
+	struct stailq_entry *top =
+		pm_atomic_load_explicit(&pool->pipe, pm_memory_order_relaxed);
+	do {
+		last->next = top;
+	} while (! pm_atomic_compare_exchange_weak_explicit(&pool->pipe,
+			&top, first, pm_memory_order_release,
+			pm_memory_order_relaxed));
+	stailq_create(&pipe->input);
 
 	pipe->n_input = 0;
-	if (pipe_was_empty) {
+	/* Trigger task processing when the queue becomes non-empty. */
+	if (top == NULL) {
 		/* Count statistics */
 		rmean_collect(pipe->bus->stats, CBUS_STAT_EVENTS, 1);
 
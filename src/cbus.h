@@ -45,7 +45,6 @@ typedef void (*cmsg_f)(struct cmsg *);
 
 enum cbus_stat_name {
 	CBUS_STAT_EVENTS,
-	CBUS_STAT_LOCKS,
 	CBUS_STAT_LAST,
 };
 
@@ -109,7 +108,7 @@ struct cpipe {
 	/**
 	 * When pushing messages, keep the staged input size under
 	 * this limit (speeds up message delivery and reduces
-	 * latency, while still keeping the bus mutex cold enough).
+	 * latency, while still keeping consumer wakeups batched).
 	 */
 	int max_input;
 	/**
@@ -139,11 +138,6 @@ cpipe_create(struct cpipe *pipe);
  * whenever the area has more messages than the cap, and also once
  * per event loop.
  * Otherwise, the messages flushed once per event loop iteration.
- *
- * @todo: collect bus stats per second and adjust max_input once
- * a second to keep the mutex cold regardless of the message load,
- * while still keeping the latency low if there are few
- * long-to-process messages.
  */
 static inline void
 cpipe_set_max_input(struct cpipe *pipe, int max_input)
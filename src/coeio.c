@@ -173,7 +173,7 @@ static int
 coio_on_finish(eio_req *req)
 {
 	struct coio_task *task = (struct coio_task *) req;
-	if (task->fiber == NULL) {
+	if (task->fiber == NULL && task->base.destroy != NULL) {
 		/*
 		 * Timed out. Resources will be freed by coio_on_destroy.
 		 * NOTE: it is not safe to run timeout_cb handler here.
@@ -184,7 +184,9 @@ coio_on_finish(eio_req *req)
 	task->complete = 1;
 	/* Reset on_timeout hook - resources will be freed by coio_task user */
 	task->base.destroy = NULL;
-	fiber_wakeup(task->fiber);
+	/* Nobody waits for a submitted task yet */
+	if (task->fiber != NULL)
+		fiber_wakeup(task->fiber);
 	return 0;
 }
 
@@ -247,6 +249,46 @@ coio_task_post(struct coio_task *task, double timeout)
 	return 0;
 }
 
+void
+coio_task_submit(struct coio_task *task)
+{
+	assert(task->base.type == EIO_CUSTOM);
+	task->fiber = NULL;
+	/* The task is not abandoned until coio_task_detach() */
+	task->base.destroy = NULL;
+	eio_submit(&task->base);
+}
+
+int
+coio_task_wait(struct coio_task *task, double timeout)
+{
+	assert(task->fiber == NULL);
+	if (!task->complete) {
+		task->fiber = fiber();
+		fiber_yield_timeout(timeout);
+	}
+	if (!task->complete) {
+		/* timed out or cancelled. */
+		coio_task_detach(task);
+		if (fiber_is_cancelled())
+			diag_set(FiberIsCancelled);
+		else
+			diag_set(TimedOut);
+		return -1;
+	}
+	return 0;
+}
+
+int
+coio_task_detach(struct coio_task *task)
+{
+	if (task->complete)
+		return 0;
+	task->fiber = NULL;
+	task->base.destroy = coio_on_destroy;
+	return -1;
+}
+
 static void
 coio_on_call(eio_req *req)
 {
@@ -116,6 +116,40 @@ coio_task_destroy(struct coio_task *task);
 int
 coio_task_post(struct coio_task *task, double timeout);
 
+/**
+ * Post coio task to EIO thread pool and return without
+ * waiting for it, e.g. to read ahead. The task must be either
+ * waited for with coio_task_wait() or given up with
+ * coio_task_detach().
+ *
+ * @param task coio task.
+ */
+void
+coio_task_submit(struct coio_task *task);
+
+/**
+ * Wait for a task posted with coio_task_submit().
+ *
+ * @param task coio task.
+ * @param timeout timeout in seconds.
+ * @retval 0  the task completed, see coio_task_post().
+ * @retval -1 timeout or the waiting fiber was cancelled (check diag);
+ *            the task is detached.
+ */
+int
+coio_task_wait(struct coio_task *task, double timeout);
+
+/**
+ * Give up a task posted with coio_task_submit().
+ *
+ * @param task coio task.
+ * @retval 0  the task is complete, the caller should free it.
+ * @retval -1 the task is in progress, it will be freed when it's
+ *            finished in the timeout callback.
+ */
+int
+coio_task_detach(struct coio_task *task);
+
 /** \cond public */
 
 /**
@@ -100,6 +100,30 @@ sse42_enabled_cpu()
 	return (cx & (1 << 20)) != 0;
 }
 
+bool
+avx2_enabled_cpu()
+{
+	unsigned int ax, bx, cx, dx;
+
+	if (__get_cpuid(1, &ax, &bx, &cx, &dx) == 0)
+		return 0;
+	/* OSXSAVE: the OS must preserve YMM registers across switches */
+	if ((cx & (1 << 27)) == 0)
+		return 0;
+	unsigned int xcr0, xcr0_hi;
+	__asm__ __volatile__(
+		".byte 0x0f, 0x01, 0xd0" /* xgetbv */
+		:"=a"(xcr0), "=d"(xcr0_hi)
+		:"c"(0)
+	);
+	if ((xcr0 & 0x6) != 0x6) /* XMM and YMM state */
+		return 0;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return 0;
+	__cpuid_count(7, 0, ax, bx, cx, dx);
+	return (bx & (1 << 5)) != 0;
+}
+
 #else /* !(defined (__x86_64__) || defined (__i386__)) */
 
 bool
@@ -108,4 +132,10 @@ sse42_enabled_cpu()
 	return false;
 }
 
+bool
+avx2_enabled_cpu()
+{
+	return false;
+}
+
 #endif
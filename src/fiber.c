@@ -670,9 +670,18 @@ fiber_destroy_all(struct cord *cord)
 static void
 fiber_pool_fetch_output(struct fiber_pool *pool)
 {
-	tt_pthread_mutex_lock(&pool->mutex);
-	stailq_concat(&pool->output, &pool->pipe);
-	tt_pthread_mutex_unlock(&pool->mutex);
+	struct stailq_entry *item =
+		pm_atomic_exchange_explicit(&pool->pipe, NULL,
+					    pm_memory_order_acquire);
+	/* The pipe is a stack, reverse it to restore FIFO order. */
+	struct stailq input;
+	stailq_create(&input);
+	while (item != NULL) {
+		struct stailq_entry *next = item->next;
+		stailq_add(&input, item);
+		item = next;
+	}
+	stailq_concat(&pool->output, &input);
 }
 
 
@@ -726,17 +735,6 @@ fiber_pool_cb(ev_loop *loop, struct ev_async *watcher, int events)
 		}
 	}
 }
-void
-fiber_pool_destroy(struct fiber_pool *pool)
-{
-	/*
-	 * Do not destroy async or idle timers, or fibers:
-	 * events are destroyed along with the event loop,
-	 * and fibers are freed at once when thread runtime
-	 * pool is destroyed.
-         */
-	(void) tt_pthread_mutex_destroy(&pool->mutex);
-}
 
 void
 fiber_pool_create(struct fiber_pool *pool, int max_pool_size,
@@ -753,12 +751,10 @@ fiber_pool_create(struct fiber_pool *pool, int max_pool_size,
 	pool->size = 0;
 	pool->max_size = max_pool_size;
 	stailq_create(&pool->output);
-	stailq_create(&pool->pipe);
+	pool->pipe = NULL;
 	ev_async_init(&pool->fetch_output, fiber_pool_cb);
 	pool->fetch_output.data = pool;
 	ev_async_start(pool->consumer, &pool->fetch_output);
-
-	(void) tt_pthread_mutex_init(&pool->mutex, NULL);
 }
 
 /* }}} */
@@ -827,8 +823,12 @@ cord_destroy(struct cord *cord)
 	}
 	region_destroy(&cord->sched.gc);
 	diag_destroy(&cord->sched.diag);
-	if (cord->fiber_pool.f)
-		fiber_pool_destroy(&cord->fiber_pool);
+	/*
+	 * The fiber pool needs no destruction: its async and
+	 * idle timers are destroyed along with the event loop,
+	 * and its fibers are freed at once when thread runtime
+	 * pool is destroyed.
+	 */
 	slab_cache_destroy(&cord->slabc);
 }
 
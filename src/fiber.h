@@ -316,10 +316,13 @@ struct fiber_pool {
 		 * the pipe becomes non-empty.
 		 */
 		struct ev_async fetch_output;
-		/** The lock around the pipe. */
-		pthread_mutex_t mutex;
-		/** The pipe with incoming messages. */
-		struct stailq pipe;
+		/**
+		 * The pipe with incoming messages: a lock-free
+		 * stack, which producers push whole batches to
+		 * and the consumer takes all at once. Messages
+		 * are stored in reverse order of arrival.
+		 */
+		struct stailq_entry *pipe;
 	};
 	fiber_func f;
 };
@@ -63,6 +63,79 @@ bitset_destroy(struct bitset *bitset)
 	memset(&bitset->pages, 0, sizeof(bitset->pages));
 }
 
+/**
+ * Find the position of the bit offset in a sparse page or the
+ * position to insert it to.
+ */
+static uint32_t
+bitset_page_array_find(struct bitset_page *page, uint16_t offset)
+{
+	uint16_t *arr = bitset_page_array(page);
+	uint32_t i = 0;
+	while (i < page->cardinality && arr[i] < offset)
+		i++;
+	return i;
+}
+
+/**
+ * Replace a full sparse page with a bitmap one.
+ * @retval NULL on memory error
+ */
+static struct bitset_page *
+bitset_page_to_bitmap(struct bitset *bitset, struct bitset_page *page)
+{
+	assert(page->is_array);
+	size_t size = bitset_page_alloc_size(bitset->realloc);
+	struct bitset_page *bitmap = bitset->realloc(NULL, size);
+	if (bitmap == NULL)
+		return NULL;
+
+	bitset_page_create(bitmap);
+	bitmap->first_pos = page->first_pos;
+	bitmap->cardinality = page->cardinality;
+	void *data = bitset_page_data(bitmap);
+	uint16_t *arr = bitset_page_array(page);
+	for (uint32_t i = 0; i < page->cardinality; i++)
+		bit_set(data, arr[i]);
+
+	bitset_pages_remove(&bitset->pages, page);
+	bitset_pages_insert(&bitset->pages, bitmap);
+	bitset_page_destroy(page);
+	bitset->realloc(page, 0);
+	return bitmap;
+}
+
+/**
+ * Replace a bitmap page which has become sparse with an array
+ * one. The page is left intact on memory error.
+ */
+static void
+bitset_page_to_array(struct bitset *bitset, struct bitset_page *page)
+{
+	assert(!page->is_array);
+	assert(page->cardinality <= BITSET_PAGE_ARRAY_SIZE);
+	struct bitset_page *sparse =
+		bitset->realloc(NULL, bitset_page_array_alloc_size());
+	if (sparse == NULL)
+		return;
+
+	bitset_page_create_array(sparse);
+	sparse->first_pos = page->first_pos;
+	uint16_t *arr = bitset_page_array(sparse);
+	struct bit_iterator it;
+	bit_iterator_init(&it, bitset_page_data(page),
+			  BITSET_PAGE_DATA_SIZE, true);
+	size_t offset;
+	while ((offset = bit_iterator_next(&it)) != SIZE_MAX)
+		arr[sparse->cardinality++] = offset;
+	assert(sparse->cardinality == page->cardinality);
+
+	bitset_pages_remove(&bitset->pages, page);
+	bitset_pages_insert(&bitset->pages, sparse);
+	bitset_page_destroy(page);
+	bitset->realloc(page, 0);
+}
+
 bool
 bitset_test(struct bitset *bitset, size_t pos)
 {
@@ -76,7 +149,13 @@ bitset_test(struct bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	return bit_test(bitset_page_data(page), pos - page->first_pos);
+	size_t offset = pos - page->first_pos;
+	if (page->is_array) {
+		uint32_t i = bitset_page_array_find(page, offset);
+		return i < page->cardinality &&
+		       bitset_page_array(page)[i] == offset;
+	}
+	return bit_test(bitset_page_data(page), offset);
 }
 
 int
@@ -88,13 +167,13 @@ bitset_set(struct bitset *bitset, size_t pos)
 	/* Find a page in pages tree */
 	struct bitset_page *page = bitset_pages_search(&bitset->pages, &key);
 	if (page == NULL) {
-		/* Allocate a new page */
-		size_t size = bitset_page_alloc_size(bitset->realloc);
+		/* Allocate a new page, it is sparse at first */
+		size_t size = bitset_page_array_alloc_size();
 		page = bitset->realloc(NULL, size);
 		if (page == NULL)
 			return -1;
 
-		bitset_page_create(page);
+		bitset_page_create_array(page);
 		page->first_pos = key.first_pos;
 
 		/* Insert the page into pages tree */
@@ -103,12 +182,32 @@ bitset_set(struct bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_set(bitset_page_data(page), pos - page->first_pos);
+	size_t offset = pos - page->first_pos;
+	if (page->is_array) {
+		uint16_t *arr = bitset_page_array(page);
+		uint32_t i = bitset_page_array_find(page, offset);
+		if (i < page->cardinality && arr[i] == offset) {
+			/* Value has not changed */
+			return 1;
+		}
+		if (page->cardinality < BITSET_PAGE_ARRAY_SIZE) {
+			memmove(arr + i + 1, arr + i,
+				(page->cardinality - i) * sizeof(*arr));
+			arr[i] = offset;
+			goto done;
+		}
+		/* The sparse page is full, switch to a bitmap */
+		page = bitset_page_to_bitmap(bitset, page);
+		if (page == NULL)
+			return -1;
+	}
+
+	bool prev = bit_set(bitset_page_data(page), offset);
 	if (prev) {
 		/* Value has not changed */
 		return 1;
 	}
-
+done:
 	bitset->cardinality++;
 	page->cardinality++;
 
@@ -128,9 +227,19 @@ bitset_clear(struct bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_clear(bitset_page_data(page), pos - page->first_pos);
-	if (!prev) {
-		return 0;
+	size_t offset = pos - page->first_pos;
+	if (page->is_array) {
+		uint16_t *arr = bitset_page_array(page);
+		uint32_t i = bitset_page_array_find(page, offset);
+		if (i == page->cardinality || arr[i] != offset)
+			return 0;
+		memmove(arr + i, arr + i + 1,
+			(page->cardinality - i - 1) * sizeof(*arr));
+	} else {
+		bool prev = bit_clear(bitset_page_data(page), offset);
+		if (!prev) {
+			return 0;
+		}
 	}
 
 	assert(bitset->cardinality > 0);
@@ -144,6 +253,13 @@ bitset_clear(struct bitset *bitset, size_t pos)
 		/* Free the page */
 		bitset_page_destroy(page);
 		bitset->realloc(page, 0);
+	} else if (!page->is_array &&
+		   page->cardinality <= BITSET_PAGE_ARRAY_SIZE / 2) {
+		/*
+		 * Switch back to a sparse page with some slack
+		 * to avoid converting a page back and forth.
+		 */
+		bitset_page_to_array(bitset, page);
 	}
 
 	return 1;
@@ -158,12 +274,15 @@ bitset_info(struct bitset *bitset, struct bitset_info *info)
 	memset(info, 0, sizeof(*info));
 	info->page_data_size = BITSET_PAGE_DATA_SIZE;
 	info->page_total_size = bitset_page_alloc_size(bitset->realloc);
+	info->array_page_total_size = bitset_page_array_alloc_size();
 	info->page_data_alignment = BITSET_PAGE_DATA_ALIGNMENT;
 
 	size_t cardinality_check = 0;
 	struct bitset_page *page = bitset_pages_first(&bitset->pages);
 	while (page != NULL) {
 		info->pages++;
+		if (page->is_array)
+			info->array_pages++;
 		cardinality_check += page->cardinality;
 		page = bitset_pages_next(&bitset->pages, page);
 	}
@@ -186,6 +305,7 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 		info.page_data_size, info.page_total_size);
 	fprintf(stream, "    " "page_bit    = %zu\n", PAGE_BIT);
 	fprintf(stream, "    " "pages       = %zu\n", info.pages);
+	fprintf(stream, "    " "array_pages = %zu\n", info.array_pages);
 
 
 	size_t cardinality = bitset_cardinality(bitset);
@@ -204,8 +324,11 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 		fprintf(stream, "    "
 			"utilization = undefined\n");
 	}
-	size_t mem_data  = info.page_data_size * info.pages;
-	size_t mem_total = info.page_total_size * info.pages;
+	size_t bitmap_pages = info.pages - info.array_pages;
+	size_t mem_data  = info.page_data_size * bitmap_pages +
+		BITSET_PAGE_ARRAY_SIZE * sizeof(uint16_t) * info.array_pages;
+	size_t mem_total = info.page_total_size * bitmap_pages +
+		info.array_page_total_size * info.array_pages;
 
 	fprintf(stream, "    " "mem_data    = %zu bytes\n", mem_data);
 	fprintf(stream, "    " "mem_total   = %zu bytes "
@@ -236,7 +359,7 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 
 		fprintf(stream, "utilization = %8.4f%% (%zu/%zu)",
 			(float) page->cardinality * 1e2 / PAGE_BIT,
-			page->cardinality, PAGE_BIT);
+			(size_t) page->cardinality, PAGE_BIT);
 
 		if (verbose < 2) {
 			fprintf(stream, "\n");
@@ -245,6 +368,15 @@ bitset_dump(struct bitset *bitset, int verbose, FILE *stream)
 		fprintf(stream, " ");
 
 		fprintf(stream, "vals = {");
+		if (page->is_array) {
+			uint16_t *arr = bitset_page_array(page);
+			for (uint32_t i = 0; i < page->cardinality; i++) {
+				fprintf(stream, "%zu, ",
+					page->first_pos + arr[i]);
+			}
+			fprintf(stream, "}\n");
+			continue;
+		}
 
 		size_t pos = 0;
 		struct bit_iterator it;
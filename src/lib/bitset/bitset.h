@@ -69,7 +69,12 @@ extern "C" {
 struct bitset_page {
 	size_t first_pos;
 	rb_node(struct bitset_page) node;
-	size_t cardinality;
+	uint32_t cardinality;
+	/*
+	 * A sparse page: data is a sorted array of offsets of
+	 * the set bits instead of a bitmap.
+	 */
+	bool is_array;
 	uint8_t data[0];
 };
 
@@ -151,10 +156,14 @@ bitset_cardinality(const struct bitset *bitset) {
 struct bitset_info {
 	/** Number of allocated pages */
 	size_t pages;
+	/** Number of sparse pages among them */
+	size_t array_pages;
 	/** Data (payload) size of one page (in bytes) */
 	size_t page_data_size;
 	/** Full size of one page (in bytes, including padding and tree data) */
 	size_t page_total_size;
+	/** Full size of one sparse page (in bytes, including tree data) */
+	size_t array_page_total_size;
 	/** A multiplier by which an address of page data is aligned **/
 	size_t page_data_alignment;
 };
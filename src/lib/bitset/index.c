@@ -393,7 +393,9 @@ bitset_index_bsize(const struct bitset_index *index)
 			continue;
 		struct bitset_info info;
 		bitset_info(index->bitsets[b], &info);
-		result += info.page_total_size * info.pages;
+		result += info.page_total_size *
+			  (info.pages - info.array_pages) +
+			  info.array_page_total_size * info.array_pages;
 	}
 	return result;
 }
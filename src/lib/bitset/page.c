@@ -41,6 +41,15 @@ bitset_page_data(struct bitset_page *page);
 extern inline void
 bitset_page_create(struct bitset_page *page);
 
+extern inline size_t
+bitset_page_array_alloc_size(void);
+
+extern inline uint16_t *
+bitset_page_array(struct bitset_page *page);
+
+extern inline void
+bitset_page_create_array(struct bitset_page *page);
+
 extern inline void
 bitset_page_destroy(struct bitset_page *page);
 
@@ -67,6 +76,13 @@ void
 bitset_page_dump(struct bitset_page *page, FILE *stream)
 {
 	fprintf(stream, "Page %zu:\n", page->first_pos);
+	if (page->is_array) {
+		uint16_t *arr = bitset_page_array(page);
+		for (uint32_t i = 0; i < page->cardinality; i++)
+			fprintf(stream, "%u ", (unsigned) arr[i]);
+		fprintf(stream, "\n--\n");
+		return;
+	}
 	char *d = bitset_page_data(page);
 	for (int i = 0; i < BITSET_PAGE_DATA_SIZE; i++) {
 		fprintf(stream, "%x ", *d);
@@ -55,7 +55,13 @@ extern "C" {
 
 enum {
 	/** How many bytes to store in one page */
-	BITSET_PAGE_DATA_SIZE = 160
+	BITSET_PAGE_DATA_SIZE = 160,
+	/**
+	 * How many bits a sparse page can hold. Pages with few
+	 * bits set store sorted offsets of the bits (uint16_t)
+	 * instead of BITSET_PAGE_DATA_SIZE bytes of bitmap.
+	 */
+	BITSET_PAGE_ARRAY_SIZE = 16
 };
 
 #if defined(ENABLE_AVX)
@@ -106,6 +112,20 @@ bitset_page_alloc_size(void *(*realloc_arg)(void *ptr, size_t size))
 
 #undef MALLOC_ALIGNMENT
 
+inline size_t
+bitset_page_array_alloc_size(void)
+{
+	return sizeof(struct bitset_page) +
+	       BITSET_PAGE_ARRAY_SIZE * sizeof(uint16_t);
+}
+
+inline uint16_t *
+bitset_page_array(struct bitset_page *page)
+{
+	assert(page->is_array);
+	return (uint16_t *) page->data;
+}
+
 inline void *
 bitset_page_data(struct bitset_page *page)
 {
@@ -121,6 +141,13 @@ bitset_page_create(struct bitset_page *page)
 	memset(page, 0, size);
 }
 
+inline void
+bitset_page_create_array(struct bitset_page *page)
+{
+	memset(page, 0, bitset_page_array_alloc_size());
+	page->is_array = true;
+}
+
 inline void
 bitset_page_destroy(struct bitset_page *page)
 {
@@ -150,6 +177,23 @@ bitset_page_set_ones(struct bitset_page *page)
 inline void
 bitset_page_and(struct bitset_page *dst, struct bitset_page *src)
 {
+	assert(!dst->is_array);
+	if (src->is_array) {
+		/* Keep only the bits listed in src */
+		void *data = bitset_page_data(dst);
+		uint16_t *arr = bitset_page_array(src);
+		uint16_t keep[BITSET_PAGE_ARRAY_SIZE];
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < src->cardinality; i++) {
+			if (bit_test(data, arr[i]))
+				keep[count++] = arr[i];
+		}
+		bitset_page_set_zeros(dst);
+		for (uint32_t i = 0; i < count; i++)
+			bit_set(data, keep[i]);
+		return;
+	}
+
 	bitset_word_t *d = (bitset_word_t *) bitset_page_data(dst);
 	bitset_word_t *s = (bitset_word_t *) bitset_page_data(src);
 
@@ -163,6 +207,15 @@ bitset_page_and(struct bitset_page *dst, struct bitset_page *src)
 inline void
 bitset_page_nand(struct bitset_page *dst, struct bitset_page *src)
 {
+	assert(!dst->is_array);
+	if (src->is_array) {
+		void *data = bitset_page_data(dst);
+		uint16_t *arr = bitset_page_array(src);
+		for (uint32_t i = 0; i < src->cardinality; i++)
+			bit_clear(data, arr[i]);
+		return;
+	}
+
 	bitset_word_t *d = (bitset_word_t *) bitset_page_data(dst);
 	bitset_word_t *s = (bitset_word_t *) bitset_page_data(src);
 
@@ -176,6 +229,15 @@ bitset_page_nand(struct bitset_page *dst, struct bitset_page *src)
 inline void
 bitset_page_or(struct bitset_page *dst, struct bitset_page *src)
 {
+	assert(!dst->is_array);
+	if (src->is_array) {
+		void *data = bitset_page_data(dst);
+		uint16_t *arr = bitset_page_array(src);
+		for (uint32_t i = 0; i < src->cardinality; i++)
+			bit_set(data, arr[i]);
+		return;
+	}
+
 	bitset_word_t *d = (bitset_word_t *) bitset_page_data(dst);
 	bitset_word_t *s = (bitset_word_t *) bitset_page_data(src);
 
@@ -30,10 +30,14 @@
  */
 #include "rtree.h"
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
 #include <stddef.h>
 #include <sys/types.h>
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#endif
 
 /*------------------------------------------------------------------------- */
 /* R-tree internal structures definition */
@@ -65,29 +69,11 @@ struct rtree_page {
 	struct rtree_page_branch data[];
 };
 
-struct rtree_neighbor_page {
-	struct rtree_neighbor_page* next;
-	struct rtree_neighbor buf[];
-};
-
 struct rtree_reinsert_list {
 	struct rtree_page *chain;
 	int level;
 };
 
-static int
-neighbor_cmp(struct rtree_neighbor *a, struct rtree_neighbor *b)
-{
-	return a->distance < b->distance ? -1 :
-	       a->distance > b->distance ? 1 :
-	       a->level < b->level ? -1 :
-	       a->level > b->level ? 1 :
-	       a < b ? -1 : a > b ? 1 : 0;
-	return 0;
-}
-
-rb_gen(, rtnt_, rtnt_t, struct rtree_neighbor, link, neighbor_cmp);
-
 /*------------------------------------------------------------------------- */
 /* R-tree rectangle methods */
 /*------------------------------------------------------------------------- */
@@ -133,7 +119,7 @@ rtree_set2dp(struct rtree_rect *rect, coord_t x, coord_t y)
 }
 
 /* Manhattan distance */
-static sq_coord_t
+static inline sq_coord_t
 rtree_rect_neigh_distance(const struct rtree_rect *rect,
 			   const struct rtree_rect *neigh_rect,
 			   unsigned dimension)
@@ -154,7 +140,7 @@ rtree_rect_neigh_distance(const struct rtree_rect *rect,
 }
 
 /* Euclid distance, squared */
-static sq_coord_t
+static inline sq_coord_t
 rtree_rect_neigh_distance2(const struct rtree_rect *rect,
 			   const struct rtree_rect *neigh_rect,
 			   unsigned dimension)
@@ -256,7 +242,7 @@ rtree_rect_intersection(const struct rtree_rect *item1,
 	}
 }
 
-static bool
+static inline bool
 rtree_rect_intersects_rect(const struct rtree_rect *rt1,
 			   const struct rtree_rect *rt2,
 			   unsigned dimension)
@@ -270,7 +256,7 @@ rtree_rect_intersects_rect(const struct rtree_rect *rt1,
 	return true;
 }
 
-static bool
+static inline bool
 rtree_rect_in_rect(const struct rtree_rect *rt1,
 		   const struct rtree_rect *rt2,
 		   unsigned dimension)
@@ -284,7 +270,7 @@ rtree_rect_in_rect(const struct rtree_rect *rt1,
 	return true;
 }
 
-static bool
+static inline bool
 rtree_rect_strict_in_rect(const struct rtree_rect *rt1,
 			  const struct rtree_rect *rt2,
 			  unsigned dimension)
@@ -298,7 +284,7 @@ rtree_rect_strict_in_rect(const struct rtree_rect *rt1,
 	return true;
 }
 
-static bool
+static inline bool
 rtree_rect_holds_rect(const struct rtree_rect *rt1,
 		      const struct rtree_rect *rt2,
 		      unsigned dimension)
@@ -306,7 +292,7 @@ rtree_rect_holds_rect(const struct rtree_rect *rt1,
 	return rtree_rect_in_rect(rt2, rt1, dimension);
 }
 
-static bool
+static inline bool
 rtree_rect_strict_holds_rect(const struct rtree_rect *rt1,
 			     const struct rtree_rect *rt2,
 			     unsigned dimension)
@@ -314,7 +300,7 @@ rtree_rect_strict_holds_rect(const struct rtree_rect *rt1,
 	return rtree_rect_strict_in_rect(rt2, rt1, dimension);
 }
 
-static bool
+static inline bool
 rtree_rect_equal_to_rect(const struct rtree_rect *rt1,
 			 const struct rtree_rect *rt2,
 			 unsigned dimension)
@@ -336,6 +322,181 @@ rtree_always_true(const struct rtree_rect *rt1,
 	return true;
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree rectangle methods specialized for common dimensions */
+/*------------------------------------------------------------------------- */
+
+typedef sq_coord_t (*rtree_distance_t)(const struct rtree_rect *rect,
+				       const struct rtree_rect *neigh_rect,
+				       unsigned dimension);
+
+struct rtree_rect_ops {
+	rtree_comparator_t intersects_rect;
+	rtree_comparator_t in_rect;
+	rtree_comparator_t strict_in_rect;
+	rtree_comparator_t holds_rect;
+	rtree_comparator_t strict_holds_rect;
+	rtree_comparator_t equal_to_rect;
+	rtree_distance_t neigh_distance;
+	rtree_distance_t neigh_distance2;
+};
+
+static const struct rtree_rect_ops rtree_rect_ops_any = {
+	rtree_rect_intersects_rect,
+	rtree_rect_in_rect,
+	rtree_rect_strict_in_rect,
+	rtree_rect_holds_rect,
+	rtree_rect_strict_holds_rect,
+	rtree_rect_equal_to_rect,
+	rtree_rect_neigh_distance,
+	rtree_rect_neigh_distance2,
+};
+
+/*
+ * With the dimension known at compile time the loops over axes
+ * are unrolled. The comparators also check all the axes instead
+ * of returning at the first mismatch: the result of a single
+ * coordinate comparison is hard to predict during tree traversal,
+ * so a branchless check is cheaper. For 2 dimensions on x86_64
+ * both bounds of a rectangle are compared at once with SSE2.
+ *
+ * @a mismatch is the condition on coords1 and coords2 of an axis
+ * which makes the generic comparator return false.
+ */
+#define RTREE_RECT_SPECIALIZE_CMP(name, d, mismatch)			\
+static bool								\
+name##_##d(const struct rtree_rect *rt1, const struct rtree_rect *rt2,	\
+	   unsigned dimension)						\
+{									\
+	assert(dimension == d);						\
+	(void) dimension;						\
+	bool res = false;						\
+	for (int i = 0; i < d; i++) {					\
+		const coord_t *coords1 = &rt1->coords[2 * i];		\
+		const coord_t *coords2 = &rt2->coords[2 * i];		\
+		res |= mismatch;					\
+	}								\
+	return !res;							\
+}
+
+#define RTREE_RECT_CMPS(d)						\
+RTREE_RECT_SPECIALIZE_CMP(rtree_rect_intersects_rect, d,		\
+	(coords1[0] > coords2[1]) | (coords1[1] < coords2[0]))		\
+RTREE_RECT_SPECIALIZE_CMP(rtree_rect_in_rect, d,			\
+	(coords1[0] < coords2[0]) | (coords1[1] > coords2[1]))		\
+RTREE_RECT_SPECIALIZE_CMP(rtree_rect_strict_in_rect, d,			\
+	(coords1[0] <= coords2[0]) | (coords1[1] >= coords2[1]))	\
+RTREE_RECT_SPECIALIZE_CMP(rtree_rect_holds_rect, d,			\
+	(coords2[0] < coords1[0]) | (coords2[1] > coords1[1]))		\
+RTREE_RECT_SPECIALIZE_CMP(rtree_rect_strict_holds_rect, d,		\
+	(coords2[0] <= coords1[0]) | (coords2[1] >= coords1[1]))	\
+RTREE_RECT_SPECIALIZE_CMP(rtree_rect_equal_to_rect, d,			\
+	(coords1[0] != coords2[0]) | (coords1[1] != coords2[1]))
+
+#if defined(__x86_64__)
+
+/**
+ * Load the lower bounds of a 2D rectangle into @a lo and
+ * the upper ones into @a hi.
+ */
+static inline void
+rtree_rect_load_sse2(const struct rtree_rect *rect, __m128d *lo, __m128d *hi)
+{
+	__m128d x = _mm_loadu_pd(&rect->coords[0]);
+	__m128d y = _mm_loadu_pd(&rect->coords[2]);
+	*lo = _mm_unpacklo_pd(x, y);
+	*hi = _mm_unpackhi_pd(x, y);
+}
+
+/*
+ * Ordered comparisons are false for NaN and cmpneq is true,
+ * just like the scalar operators in the generic comparators.
+ */
+#define RTREE_RECT_SPECIALIZE_CMP_SSE2(name, mismatch)			\
+static bool								\
+name##_2(const struct rtree_rect *rt1, const struct rtree_rect *rt2,	\
+	 unsigned dimension)						\
+{									\
+	assert(dimension == 2);						\
+	(void) dimension;						\
+	__m128d lo1, hi1, lo2, hi2;					\
+	rtree_rect_load_sse2(rt1, &lo1, &hi1);				\
+	rtree_rect_load_sse2(rt2, &lo2, &hi2);				\
+	return _mm_movemask_pd(mismatch) == 0;				\
+}
+
+RTREE_RECT_SPECIALIZE_CMP_SSE2(rtree_rect_intersects_rect,
+	_mm_or_pd(_mm_cmpgt_pd(lo1, hi2), _mm_cmplt_pd(hi1, lo2)))
+RTREE_RECT_SPECIALIZE_CMP_SSE2(rtree_rect_in_rect,
+	_mm_or_pd(_mm_cmplt_pd(lo1, lo2), _mm_cmpgt_pd(hi1, hi2)))
+RTREE_RECT_SPECIALIZE_CMP_SSE2(rtree_rect_strict_in_rect,
+	_mm_or_pd(_mm_cmple_pd(lo1, lo2), _mm_cmpge_pd(hi1, hi2)))
+RTREE_RECT_SPECIALIZE_CMP_SSE2(rtree_rect_holds_rect,
+	_mm_or_pd(_mm_cmplt_pd(lo2, lo1), _mm_cmpgt_pd(hi2, hi1)))
+RTREE_RECT_SPECIALIZE_CMP_SSE2(rtree_rect_strict_holds_rect,
+	_mm_or_pd(_mm_cmple_pd(lo2, lo1), _mm_cmpge_pd(hi2, hi1)))
+RTREE_RECT_SPECIALIZE_CMP_SSE2(rtree_rect_equal_to_rect,
+	_mm_or_pd(_mm_cmpneq_pd(lo1, lo2), _mm_cmpneq_pd(hi1, hi2)))
+
+#undef RTREE_RECT_SPECIALIZE_CMP_SSE2
+
+#else /* !defined(__x86_64__) */
+
+RTREE_RECT_CMPS(2)
+
+#endif /* !defined(__x86_64__) */
+
+RTREE_RECT_CMPS(3)
+RTREE_RECT_CMPS(4)
+
+#define RTREE_RECT_SPECIALIZE_DISTANCE(name, d)				\
+static sq_coord_t							\
+name##_##d(const struct rtree_rect *rt1, const struct rtree_rect *rt2,	\
+	   unsigned dimension)						\
+{									\
+	assert(dimension == d);						\
+	(void) dimension;						\
+	return name(rt1, rt2, d);					\
+}
+
+#define RTREE_RECT_OPS(d)						\
+RTREE_RECT_SPECIALIZE_DISTANCE(rtree_rect_neigh_distance, d)		\
+RTREE_RECT_SPECIALIZE_DISTANCE(rtree_rect_neigh_distance2, d)		\
+static const struct rtree_rect_ops rtree_rect_ops_##d = {		\
+	rtree_rect_intersects_rect_##d,					\
+	rtree_rect_in_rect_##d,						\
+	rtree_rect_strict_in_rect_##d,					\
+	rtree_rect_holds_rect_##d,					\
+	rtree_rect_strict_holds_rect_##d,				\
+	rtree_rect_equal_to_rect_##d,					\
+	rtree_rect_neigh_distance_##d,					\
+	rtree_rect_neigh_distance2_##d,					\
+};
+
+RTREE_RECT_OPS(2)
+RTREE_RECT_OPS(3)
+RTREE_RECT_OPS(4)
+
+#undef RTREE_RECT_OPS
+#undef RTREE_RECT_SPECIALIZE_DISTANCE
+#undef RTREE_RECT_CMPS
+#undef RTREE_RECT_SPECIALIZE_CMP
+
+static const struct rtree_rect_ops *
+rtree_rect_ops_get(unsigned dimension)
+{
+	switch (dimension) {
+	case 2:
+		return &rtree_rect_ops_2;
+	case 3:
+		return &rtree_rect_ops_3;
+	case 4:
+		return &rtree_rect_ops_4;
+	default:
+		return &rtree_rect_ops_any;
+	}
+}
+
 /*------------------------------------------------------------------------- */
 /* R-tree page methods */
 /*------------------------------------------------------------------------- */
@@ -672,7 +833,7 @@ rtree_page_remove(struct rtree *tree, struct rtree_page *page,
 		for (unsigned i = 0; i < page->n; i++) {
 			struct rtree_page_branch *b;
 			b = rtree_branch_get(tree, page, i);
-			if (!rtree_rect_intersects_rect(&b->rect, rect, d))
+			if (!tree->rect_ops->intersects_rect(&b->rect, rect, d))
 				continue;
 			struct rtree_page *next_page = b->data.page;
 			if (!rtree_page_remove(tree, next_page, rect,
@@ -787,104 +948,155 @@ rtree_iterator_goto_next(struct rtree_iterator *itr, unsigned sp)
 void
 rtree_iterator_destroy(struct rtree_iterator *itr)
 {
-	struct rtree_neighbor_page *curr, *next;
-	for (curr = itr->page_list; curr != NULL; curr = next) {
-		next = curr->next;
-		rtree_page_free((struct rtree *) itr->tree,
-				(struct rtree_page *) curr);
-	}
-	itr->page_list = NULL;
-	itr->page_pos = INT_MAX;
+	free(itr->neigh_heap);
+	itr->neigh_heap = NULL;
+	itr->neigh_count = 0;
+	itr->neigh_capacity = 0;
 }
 
-struct rtree_neighbor *
-rtree_iterator_reset_cb(rtnt_t *t, struct rtree_neighbor *n, void *d)
+static void
+rtree_iterator_reset(struct rtree_iterator *itr)
 {
-	(void) t;
-	struct rtree_iterator *itr = (struct rtree_iterator *)d;
-	n->next = itr->neigh_free_list;
-	itr->neigh_free_list = n;
-	return 0;
+	itr->neigh_count = 0;
+	itr->neigh_seq = 0;
+	itr->is_oom = false;
 }
 
-static void
-rtree_iterator_reset(struct rtree_iterator *itr)
+void
+rtree_iterator_init(struct rtree_iterator *itr)
 {
-	rtnt_iter(&itr->neigh_tree, 0, rtree_iterator_reset_cb, (void *)itr);
-	rtnt_new(&itr->neigh_tree);
+	itr->tree = 0;
+	itr->neigh_heap = NULL;
+	itr->neigh_count = 0;
+	itr->neigh_capacity = 0;
+	itr->neigh_seq = 0;
+	itr->is_oom = false;
 }
 
-static struct rtree_neighbor *
-rtree_iterator_allocate_neighbour(struct rtree_iterator *itr)
+/*
+ * Order of neighbors in the heap: by distance, records before
+ * pages at the same distance, then in order of discovery.
+ */
+static inline bool
+rtree_neighbor_less(const struct rtree_neighbor *a,
+		    const struct rtree_neighbor *b)
 {
-	if (itr->page_pos >= itr->tree->neighbours_in_page) {
-		struct rtree_neighbor_page *new_page =
-			(struct rtree_neighbor_page *)
-			rtree_page_alloc((struct rtree*)itr->tree);
-		new_page->next = itr->page_list;
-		itr->page_list = new_page;
-		itr->page_pos = 0;
-	}
-	return itr->page_list->buf + itr->page_pos++;
+	if (a->distance != b->distance)
+		return a->distance < b->distance;
+	if (a->level != b->level)
+		return a->level < b->level;
+	return a->seq < b->seq;
 }
 
-static struct rtree_neighbor *
-rtree_iterator_new_neighbor(struct rtree_iterator *itr,
-			    void *child, sq_coord_t distance, int level)
+static void
+rtree_iterator_sift_up(struct rtree_iterator *itr, unsigned pos)
 {
-	struct rtree_neighbor *n = itr->neigh_free_list;
-	if (n == NULL)
-		n = rtree_iterator_allocate_neighbour(itr);
-	else
-		itr->neigh_free_list = n->next;
-	n->child = child;
-	n->distance = distance;
-	n->level = level;
-	return n;
+	struct rtree_neighbor *heap = itr->neigh_heap;
+	struct rtree_neighbor n = heap[pos];
+	while (pos > 0) {
+		unsigned parent = (pos - 1) / 2;
+		if (!rtree_neighbor_less(&n, &heap[parent]))
+			break;
+		heap[pos] = heap[parent];
+		pos = parent;
+	}
+	heap[pos] = n;
 }
 
 static void
-rtree_iterator_free_neighbor(struct rtree_iterator *itr,
-			     struct rtree_neighbor *n)
+rtree_iterator_sift_down(struct rtree_iterator *itr, unsigned pos)
 {
-	n->next = itr->neigh_free_list;
-	itr->neigh_free_list = n;
+	struct rtree_neighbor *heap = itr->neigh_heap;
+	unsigned count = itr->neigh_count;
+	struct rtree_neighbor n = heap[pos];
+	while (true) {
+		unsigned child = 2 * pos + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count &&
+		    rtree_neighbor_less(&heap[child + 1], &heap[child]))
+			child++;
+		if (!rtree_neighbor_less(&heap[child], &n))
+			break;
+		heap[pos] = heap[child];
+		pos = child;
+	}
+	heap[pos] = n;
 }
 
-void
-rtree_iterator_init(struct rtree_iterator *itr)
+/* Make room for count more neighbors in the heap */
+static int
+rtree_iterator_reserve(struct rtree_iterator *itr, unsigned count)
 {
-	itr->tree = 0;
-	rtnt_new(&itr->neigh_tree);
-	itr->neigh_free_list = NULL;
-	itr->page_list = NULL;
-	itr->page_pos = INT_MAX;
+	if (itr->neigh_count + count <= itr->neigh_capacity)
+		return 0;
+	unsigned capacity = itr->neigh_capacity == 0 ?
+		RTREE_MAXIMUM_BRANCHES_IN_PAGE * 4 : itr->neigh_capacity;
+	while (capacity < itr->neigh_count + count)
+		capacity *= 2;
+	struct rtree_neighbor *heap = (struct rtree_neighbor *)
+		realloc(itr->neigh_heap, capacity * sizeof(*heap));
+	if (heap == NULL)
+		return -1;
+	itr->neigh_heap = heap;
+	itr->neigh_capacity = capacity;
+	return 0;
 }
 
 static void
-rtree_iterator_process_neigh(struct rtree_iterator *itr,
-			     struct rtree_neighbor *neighbor)
+rtree_neighbor_init(struct rtree_iterator *itr, struct rtree_neighbor *n,
+		    void *child, sq_coord_t distance, int level)
+{
+	n->child = child;
+	n->distance = distance;
+	n->level = level;
+	n->seq = itr->neigh_seq++;
+}
+
+/*
+ * Replace the page at the top of the heap with its branches.
+ * The first branch takes the place of the page, so expanding
+ * a page costs one sift down instead of a removal and an
+ * insertion.
+ */
+static int
+rtree_iterator_process_neigh(struct rtree_iterator *itr)
 {
 	unsigned d = itr->tree->dimension;
-	void *child = neighbor->child;
-	struct rtree_page *pg = (struct rtree_page *)child;
-	int level = neighbor->level;
-	rtree_iterator_free_neighbor(itr, neighbor);
-	for (int i = 0, n = pg->n; i < n; i++) {
+	const struct rtree_rect_ops *ops = itr->tree->rect_ops;
+	struct rtree_page *pg = (struct rtree_page *)itr->neigh_heap[0].child;
+	int level = itr->neigh_heap[0].level;
+	unsigned n = pg->n;
+	if (n == 0) {
+		itr->neigh_heap[0] = itr->neigh_heap[--itr->neigh_count];
+		if (itr->neigh_count > 0)
+			rtree_iterator_sift_down(itr, 0);
+		return 0;
+	}
+	if (rtree_iterator_reserve(itr, n - 1) != 0)
+		return -1;
+	for (unsigned i = 0; i < n; i++) {
 		struct rtree_page_branch *b;
 		b = rtree_branch_get(itr->tree, pg, i);
 		coord_t distance;
 		if (itr->tree->distance_type == RTREE_EUCLID)
-			distance = rtree_rect_neigh_distance2(&b->rect,
-							      &itr->rect, d);
+			distance = ops->neigh_distance2(&b->rect,
+							&itr->rect, d);
 		else
-			distance = rtree_rect_neigh_distance(&b->rect,
-							     &itr->rect, d);
-		struct rtree_neighbor *neigh =
-			rtree_iterator_new_neighbor(itr, b->data.page,
-						    distance, level - 1);
-		rtnt_insert(&itr->neigh_tree, neigh);
+			distance = ops->neigh_distance(&b->rect,
+						       &itr->rect, d);
+		if (i == 0) {
+			rtree_neighbor_init(itr, &itr->neigh_heap[0],
+					    b->data.page, distance, level - 1);
+			rtree_iterator_sift_down(itr, 0);
+		} else {
+			unsigned pos = itr->neigh_count++;
+			rtree_neighbor_init(itr, &itr->neigh_heap[pos],
+					    b->data.page, distance, level - 1);
+			rtree_iterator_sift_up(itr, pos);
+		}
 	}
+	return 0;
 }
 
 
@@ -910,20 +1122,22 @@ rtree_iterator_next(struct rtree_iterator *itr)
 		 *      otherwise (R-Tree page)  get siblings of this R-Tree
 		 *      page and insert them in sorted list
 		*/
-		while (true) {
-			struct rtree_neighbor *neighbor =
-				rtnt_first(&itr->neigh_tree);
-			if (neighbor == NULL)
+		itr->is_oom = false;
+		while (itr->neigh_count > 0) {
+			struct rtree_neighbor *top = &itr->neigh_heap[0];
+			if (top->level == 0) {
+				record_t record = (record_t)top->child;
+				*top = itr->neigh_heap[--itr->neigh_count];
+				if (itr->neigh_count > 0)
+					rtree_iterator_sift_down(itr, 0);
+				return record;
+			}
+			if (rtree_iterator_process_neigh(itr) != 0) {
+				itr->is_oom = true;
 				return NULL;
-			rtnt_remove(&itr->neigh_tree, neighbor);
-			if (neighbor->level == 0) {
-				void *child = neighbor->child;
-				rtree_iterator_free_neighbor(itr, neighbor);
-				return (record_t)child;
-			} else {
-				rtree_iterator_process_neigh(itr, neighbor);
 			}
 		}
+		return NULL;
 	}
 	int sp = itr->tree->height - 1;
 	if (!itr->eof && rtree_iterator_goto_next(itr, sp)) {
@@ -951,8 +1165,12 @@ rtree_init(struct rtree *tree, unsigned dimension, uint32_t extent_size,
 	tree->version = 0;
 	tree->n_pages = 0;
 	tree->free_pages = 0;
+	tree->bulk_buf = NULL;
+	tree->bulk_size = 0;
+	tree->bulk_alloc = 0;
 
 	tree->dimension = dimension;
+	tree->rect_ops = rtree_rect_ops_get(dimension);
 	tree->distance_type = distance_type;
 	tree->page_branch_size =
 		(RTREE_BRANCH_DATA_SIZE + dimension * 2 * sizeof(coord_t));
@@ -966,8 +1184,6 @@ rtree_init(struct rtree *tree, unsigned dimension, uint32_t extent_size,
 	tree->page_max_fill = (tree->page_size - sizeof(int)) /
 		tree->page_branch_size;
 	tree->page_min_fill = tree->page_max_fill * 2 / 5;
-	tree->neighbours_in_page = (tree->page_size - sizeof(void *))
-		/ sizeof(struct rtree_neighbor);
 
 	matras_create(&tree->mtab, extent_size, tree->page_size,
 		      extent_alloc, extent_free, alloc_ctx);
@@ -979,6 +1195,7 @@ rtree_destroy(struct rtree *tree)
 {
 	rtree_purge(tree);
 	matras_destroy(&tree->mtab);
+	free(tree->bulk_buf);
 }
 
 void
@@ -1006,6 +1223,225 @@ rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj)
 	tree->n_records++;
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree bulk loading (Sort-Tile-Recursive) */
+/*------------------------------------------------------------------------- */
+
+int
+rtree_bulk_add(struct rtree *tree, const struct rtree_rect *rect,
+	       record_t obj)
+{
+	if (tree->bulk_size == tree->bulk_alloc) {
+		unsigned alloc = tree->bulk_alloc == 0 ?
+			RTREE_MAXIMUM_BRANCHES_IN_PAGE : tree->bulk_alloc * 2;
+		char *buf = (char *)realloc(tree->bulk_buf,
+					    (size_t)alloc *
+					    tree->page_branch_size);
+		if (buf == NULL)
+			return -1;
+		tree->bulk_buf = buf;
+		tree->bulk_alloc = alloc;
+	}
+	struct rtree_page_branch *b = (struct rtree_page_branch *)
+		(tree->bulk_buf + (size_t)tree->bulk_size *
+		 tree->page_branch_size);
+	rtree_rect_copy(&b->rect, rect, tree->dimension);
+	b->data.record = obj;
+	tree->bulk_size++;
+	return 0;
+}
+
+static struct rtree_page_branch *
+rtree_bulk_branch(const struct rtree *tree, char *items, unsigned i)
+{
+	return (struct rtree_page_branch *)
+		(items + (size_t)i * tree->page_branch_size);
+}
+
+/* Doubled center of the branch rectangle along the axis */
+static coord_t
+rtree_bulk_center(const struct rtree *tree, char *items, unsigned i,
+		  unsigned axis)
+{
+	const coord_t *coords =
+		&rtree_bulk_branch(tree, items, i)->rect.coords[2 * axis];
+	return coords[0] + coords[1];
+}
+
+static void
+rtree_bulk_swap(const struct rtree *tree, char *items, unsigned i, unsigned j)
+{
+	struct rtree_page_branch tmp;
+	struct rtree_page_branch *a = rtree_bulk_branch(tree, items, i);
+	struct rtree_page_branch *b = rtree_bulk_branch(tree, items, j);
+	rtree_branch_copy(&tmp, a, tree->dimension);
+	rtree_branch_copy(a, b, tree->dimension);
+	rtree_branch_copy(b, &tmp, tree->dimension);
+}
+
+/* Sort branches by centers of their rectangles along the axis */
+static void
+rtree_bulk_sort(const struct rtree *tree, char *items, unsigned n,
+		unsigned axis)
+{
+	while (n > 16) {
+		/* Hoare partition around the middle element */
+		coord_t pivot = rtree_bulk_center(tree, items, n / 2, axis);
+		long i = -1, j = n;
+		while (true) {
+			do {
+				i++;
+			} while (rtree_bulk_center(tree, items, i, axis) < pivot);
+			do {
+				j--;
+			} while (rtree_bulk_center(tree, items, j, axis) > pivot);
+			if (i >= j)
+				break;
+			rtree_bulk_swap(tree, items, i, j);
+		}
+		/* Recurse into the smaller part, iterate the bigger one */
+		unsigned n1 = j + 1;
+		char *items2 = (char *)rtree_bulk_branch(tree, items, n1);
+		if (n1 < n - n1) {
+			rtree_bulk_sort(tree, items, n1, axis);
+			items = items2;
+			n -= n1;
+		} else {
+			rtree_bulk_sort(tree, items2, n - n1, axis);
+			n = n1;
+		}
+	}
+	for (unsigned i = 1; i < n; i++) {
+		for (unsigned j = i; j > 0; j--) {
+			if (rtree_bulk_center(tree, items, j - 1, axis) <=
+			    rtree_bulk_center(tree, items, j, axis))
+				break;
+			rtree_bulk_swap(tree, items, j - 1, j);
+		}
+	}
+}
+
+/* Minimal number of slabs s such that s ^ dims >= pages */
+static unsigned
+rtree_bulk_slab_count(unsigned pages, unsigned dims)
+{
+	unsigned s = 1;
+	while (true) {
+		uint64_t p = 1;
+		for (unsigned i = 0; i < dims && p < pages; i++)
+			p *= s;
+		if (p >= pages)
+			return s;
+		s++;
+	}
+}
+
+/*
+ * Order branches so that consecutive runs of page_max_fill
+ * branches are spatially close: sort by the axis, cut into
+ * slabs and tile every slab along the rest of the axes.
+ */
+static void
+rtree_bulk_tile(const struct rtree *tree, char *items, unsigned n,
+		unsigned axis)
+{
+	unsigned max_fill = tree->page_max_fill;
+	unsigned pages = (n + max_fill - 1) / max_fill;
+	if (pages <= 1)
+		return;
+	rtree_bulk_sort(tree, items, n, axis);
+	unsigned dims = tree->dimension - axis;
+	if (dims == 1)
+		return;
+	unsigned slabs = rtree_bulk_slab_count(pages, dims);
+	/* Slabs consist of whole pages */
+	unsigned slab_size = (pages + slabs - 1) / slabs * max_fill;
+	for (unsigned i = 0; i < n; i += slab_size) {
+		unsigned count = n - i < slab_size ? n - i : slab_size;
+		rtree_bulk_tile(tree, (char *)rtree_bulk_branch(tree, items, i),
+				count, axis + 1);
+	}
+}
+
+/*
+ * Pack tiled branches into pages and replace them with
+ * the branches of the new pages. Returns the number of pages.
+ */
+static unsigned
+rtree_bulk_pack(struct rtree *tree, char *items, unsigned n)
+{
+	unsigned count = 0;
+	for (unsigned i = 0; i < n; ) {
+		unsigned fill = n - i;
+		if (fill > tree->page_max_fill) {
+			fill = tree->page_max_fill;
+			/* Don't leave an underfilled page at the end */
+			if (n - i - fill < tree->page_min_fill)
+				fill = (n - i) / 2;
+		}
+		struct rtree_page *page = rtree_page_alloc(tree);
+		tree->n_pages++;
+		page->n = fill;
+		for (unsigned j = 0; j < fill; j++) {
+			rtree_branch_copy(rtree_branch_get(tree, page, j),
+					  rtree_bulk_branch(tree, items, i + j),
+					  tree->dimension);
+		}
+		/* Branches [i, i + fill) are copied, can be overwritten */
+		struct rtree_page_branch *b =
+			rtree_bulk_branch(tree, items, count++);
+		rtree_page_cover(tree, page, &b->rect);
+		b->data.page = page;
+		i += fill;
+	}
+	return count;
+}
+
+unsigned
+rtree_bulk_page_count(const struct rtree *tree)
+{
+	if (tree->root != NULL || tree->bulk_size == 0)
+		return 0;
+	/* rtree_bulk_pack() fills all pages but the last two */
+	unsigned pages = 0;
+	unsigned n = tree->bulk_size;
+	do {
+		n = (n + tree->page_max_fill - 1) / tree->page_max_fill;
+		pages += n;
+	} while (n > 1);
+	return pages;
+}
+
+void
+rtree_bulk_load(struct rtree *tree)
+{
+	char *items = tree->bulk_buf;
+	unsigned n = tree->bulk_size;
+	if (tree->root != NULL) {
+		/* Can't pack a non-empty tree, insert one by one */
+		for (unsigned i = 0; i < n; i++) {
+			struct rtree_page_branch *b =
+				rtree_bulk_branch(tree, items, i);
+			rtree_insert(tree, &b->rect, b->data.record);
+		}
+	} else if (n > 0) {
+		unsigned height = 0;
+		do {
+			rtree_bulk_tile(tree, items, n, 0);
+			n = rtree_bulk_pack(tree, items, n);
+			height++;
+		} while (n > 1);
+		tree->root = rtree_bulk_branch(tree, items, 0)->data.page;
+		tree->height = height;
+		tree->n_records = tree->bulk_size;
+		tree->version++;
+	}
+	free(tree->bulk_buf);
+	tree->bulk_buf = NULL;
+	tree->bulk_size = 0;
+	tree->bulk_alloc = 0;
+}
+
 bool
 rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj)
 {
@@ -1066,31 +1502,32 @@ rtree_search(const struct rtree *tree, const struct rtree_rect *rect,
 	itr->version = tree->version;
 	rtree_rect_copy(&itr->rect, rect, tree->dimension);
 	itr->op = op;
+	const struct rtree_rect_ops *ops = tree->rect_ops;
 	assert(tree->height <= RTREE_MAX_HEIGHT);
 	switch (op) {
 	case SOP_ALL:
 		itr->intr_cmp = itr->leaf_cmp = rtree_always_true;
 		break;
 	case SOP_EQUALS:
-		itr->intr_cmp = rtree_rect_in_rect;
-		itr->leaf_cmp = rtree_rect_equal_to_rect;
+		itr->intr_cmp = ops->in_rect;
+		itr->leaf_cmp = ops->equal_to_rect;
 		break;
 	case SOP_CONTAINS:
-		itr->intr_cmp = itr->leaf_cmp = rtree_rect_in_rect;
+		itr->intr_cmp = itr->leaf_cmp = ops->in_rect;
 		break;
 	case SOP_STRICT_CONTAINS:
-		itr->intr_cmp = itr->leaf_cmp = rtree_rect_strict_in_rect;
+		itr->intr_cmp = itr->leaf_cmp = ops->strict_in_rect;
 		break;
 	case SOP_OVERLAPS:
-		itr->intr_cmp = itr->leaf_cmp = rtree_rect_intersects_rect;
+		itr->intr_cmp = itr->leaf_cmp = ops->intersects_rect;
 		break;
 	case SOP_BELONGS:
-		itr->intr_cmp = rtree_rect_intersects_rect;
-		itr->leaf_cmp = rtree_rect_holds_rect;
+		itr->intr_cmp = ops->intersects_rect;
+		itr->leaf_cmp = ops->holds_rect;
 		break;
 	case SOP_STRICT_BELONGS:
-		itr->intr_cmp = rtree_rect_intersects_rect;
-		itr->leaf_cmp = rtree_rect_strict_holds_rect;
+		itr->intr_cmp = ops->intersects_rect;
+		itr->leaf_cmp = ops->strict_holds_rect;
 		break;
 	case SOP_NEIGHBOR:
 		if (tree->root) {
@@ -1099,17 +1536,20 @@ rtree_search(const struct rtree *tree, const struct rtree_rect *rect,
 			sq_coord_t distance;
 			if (tree->distance_type == RTREE_EUCLID)
 				distance =
-				rtree_rect_neigh_distance2(&cover, rect,
-							   tree->dimension);
+				ops->neigh_distance2(&cover, rect,
+						     tree->dimension);
 			else
 				distance =
-				rtree_rect_neigh_distance(&cover, rect,
-							  tree->dimension);
-			struct rtree_neighbor *n =
-				rtree_iterator_new_neighbor(itr, tree->root,
-							    distance,
-							    tree->height);
-			rtnt_insert(&itr->neigh_tree, n);
+				ops->neigh_distance(&cover, rect,
+						    tree->dimension);
+			if (rtree_iterator_reserve(itr, 1) != 0) {
+				itr->is_oom = true;
+				return false;
+			}
+			rtree_neighbor_init(itr, &itr->neigh_heap[0],
+					    tree->root, distance,
+					    tree->height);
+			itr->neigh_count = 1;
 			return true;
 		} else {
 			return false;
@@ -34,9 +34,6 @@
 #include <stdbool.h>
 #include "small/matras.h"
 
-#define RB_COMPACT 1
-#include "small/rb.h"
-
 /**
  * In-memory Guttman's R-tree
  */
@@ -54,16 +51,16 @@ typedef double area_t;
 extern "C" {
 #endif /* defined(__cplusplus) */
 
+/* A candidate of neighbor iteration: a tree page or a record */
 struct rtree_neighbor {
-	rb_node(struct rtree_neighbor) link;
-	struct rtree_neighbor *next;
 	void *child;
+	/* 0 for records, height of the page in the tree for pages */
 	int level;
+	/* Order of discovery, to return equidistant records stably */
+	unsigned seq;
 	sq_coord_t distance;
 };
 
-typedef rb_tree(struct rtree_neighbor) rtnt_t;
-
 enum {
 	/** Maximal possible R-tree height */
 	RTREE_MAX_HEIGHT = 16,
@@ -120,6 +117,8 @@ enum rtree_distance_type {
 	RTREE_MANHATTAN = 1 /* Manhattan distance, fabs(dx) + fabs(dy) */
 };
 
+struct rtree_rect_ops;
+
 /* Main rtree struct */
 struct rtree
 {
@@ -127,6 +126,8 @@ struct rtree
 	struct rtree_page *root;
 	/* R-tree dimension */
 	unsigned dimension;
+	/* Rectangle methods, specialized for the dimension if possible */
+	const struct rtree_rect_ops *rect_ops;
 	/* Minimal number of branches in tree page */
 	unsigned page_min_fill;
 	/* Maximal number of branches in tree page */
@@ -135,9 +136,6 @@ struct rtree
 	unsigned page_size;
 	/* Page branch size in bytes */
 	unsigned page_branch_size;
-	/* For iterator usage, pages are splitted into structs neighbours
-	 * Here is number of neighbours fit into one page */
-	unsigned neighbours_in_page;
 	/* Number of records in entire tree */
 	unsigned n_records;
 	/* Height of a tree */
@@ -152,6 +150,12 @@ struct rtree
 	void *free_pages;
 	/* Distance type */
 	enum rtree_distance_type distance_type;
+	/* Records collected for bulk loading, see rtree_bulk_add() */
+	char *bulk_buf;
+	/* Number of records in bulk_buf */
+	unsigned bulk_size;
+	/* Number of records bulk_buf can hold */
+	unsigned bulk_alloc;
 };
 
 /* Struct for iteration and retrieving rtree values */
@@ -165,22 +169,24 @@ struct rtree_iterator
 	enum spatial_search_op op;
 	/* Flag that means that no more values left */
 	bool eof;
+	/* Flag that means that the iteration was stopped because
+	 * memory for neighbor candidates couldn't be allocated
+	 */
+	bool is_oom;
 	/* A verion of a tree when the iterator was created */
 	unsigned version;
 
-	/* Special rb tree of closest neqighbors
-	 * Used only for iteration with op = SOP_NEIGHBOR
-	 * For allocating list entries, page allocator of tree is used.
-	 * Allocated page is much bigger than list entry and thus
-	 * provides several list entries.
+	/* Binary min-heap of closest neighbors (tree pages and records)
+	 * ordered by distance to the point. Used only for iteration with
+	 * op = SOP_NEIGHBOR. The array is reused by subsequent searches.
 	 */
-	rtnt_t neigh_tree;
-	/* List of unused (deleted) list entries */
-	struct rtree_neighbor *neigh_free_list;
-	/* List of tree pages, allocated for list entries */
-	struct rtree_neighbor_page *page_list;
-	/* Position of ready-to-use list entry in allocated page */
-	unsigned page_pos;
+	struct rtree_neighbor *neigh_heap;
+	/* Number of neighbors in the heap */
+	unsigned neigh_count;
+	/* Number of neighbors the heap array can hold */
+	unsigned neigh_capacity;
+	/* Counter for rtree_neighbor::seq */
+	unsigned neigh_seq;
 
 	/* Comparators for comparison rectagnle of the iterator with
 	 * rectangles of tree nodes. If the comparator returns true,
@@ -256,6 +262,8 @@ rtree_purge(struct rtree *tree);
 /**
  * @brief Find a record in a tree
  * @return true if at least one record found (false otherwise)
+ *  false is also returned if SOP_NEIGHBOR search fails to allocate
+ *  memory, itr->is_oom is set in this case
  * @param tree - pointer to a tree
  * @param rect - rectangle to find (the meaning depends on op argument)
  * @param op - type of search, see enum spatial_search_op for details
@@ -275,6 +283,36 @@ rtree_search(const struct rtree *tree, const struct rtree_rect *rect,
 void
 rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj);
 
+/**
+ * @brief Add a record to the set of records to be loaded into
+ * the tree at once by rtree_bulk_load()
+ * @return 0 on success, -1 on memory allocation error
+ * @param tree - pointer to a tree
+ * @param rect - rectangle of the record
+ * @param obj - record to add
+ */
+int
+rtree_bulk_add(struct rtree *tree, const struct rtree_rect *rect,
+	       record_t obj);
+
+/**
+ * @brief The number of pages rtree_bulk_load() allocates to pack
+ * the records added by rtree_bulk_add() into an empty tree.
+ * @param tree - pointer to a tree
+ */
+unsigned
+rtree_bulk_page_count(const struct rtree *tree);
+
+/**
+ * @brief Insert all records added by rtree_bulk_add() to the tree.
+ * An empty tree is built bottom-up with Sort-Tile-Recursive
+ * packing, which is much faster than inserting the records one
+ * by one and produces tightly packed, less overlapping pages.
+ * @param tree - pointer to a tree
+ */
+void
+rtree_bulk_load(struct rtree *tree);
+
 /**
  * @brief Remove the record from a tree
  * @return true if the record deleted (false otherwise)
@@ -328,6 +366,8 @@ rtree_iterator_destroy(struct rtree_iterator *itr);
 /**
  * @brief Retrieve a record from the iterator and iterate it to the next record
  * @return a record or NULL if no more records
+ *  NULL is also returned if SOP_NEIGHBOR iteration fails to allocate
+ *  memory, itr->is_oom is set in this case
  * @param itr - pointer to a iterator
  **/
 record_t
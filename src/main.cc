@@ -52,6 +52,7 @@
 #include <fiber.h>
 #include <coeio.h>
 #include <crc32.h>
+#include "mp_scan.h"
 #include "memory.h"
 #include <say.h>
 #include <rmean.h>
@@ -599,6 +600,7 @@ main(int argc, char **argv)
 	say_init(argv[0]);
 
 	crc32_init();
+	mp_scan_init();
 	memory_init();
 
 	main_argc = argc;
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "mp_scan.h"
+
+#include <stdbool.h>
+#include <msgpuck.h>
+
+#include "trivia/config.h"
+#include "trivia/util.h"
+#include "cpu_feature.h"
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/** True if \a c is a complete single-byte MsgPack value. */
+static inline bool
+mp_is_single_byte(char c)
+{
+	uint8_t b = (uint8_t) c;
+	/* fixint, negative fixint, nil, false, true */
+	return b <= 0x7f || b >= 0xe0 || b == 0xc0 || b == 0xc2 || b == 0xc3;
+}
+
+/*
+ * The end of the data is unknown to the scanner, so a vector
+ * load may read past it. This is harmless as long as the load
+ * doesn't cross a page boundary, since the bytes past the end
+ * of data are never used. Otherwise the scanner falls back to
+ * mp_next().
+ */
+enum { MP_SCAN_PAGE_SIZE = 4096 };
+
+static inline bool
+mp_scan_can_load(const char *data, size_t size)
+{
+	return ((uintptr_t) data & (MP_SCAN_PAGE_SIZE - 1)) <=
+		MP_SCAN_PAGE_SIZE - size;
+}
+
+/**
+ * Return a mask with bit i set if data[i] is not a single-byte
+ * value, for 16 bytes starting at \a data.
+ */
+static inline uint32_t
+mp_multibyte_mask_sse2(const char *data)
+{
+	__m128i v = _mm_loadu_si128((const __m128i *) data);
+	/* signed -32..127: 0xe0..0xff and 0x00..0x7f */
+	__m128i fixint = _mm_cmpgt_epi8(v, _mm_set1_epi8(-33));
+	__m128i nil = _mm_cmpeq_epi8(v, _mm_set1_epi8((char) 0xc0));
+	/* 0xc2 | 1 == 0xc3 | 1 == 0xc3 */
+	__m128i boolean = _mm_cmpeq_epi8(_mm_or_si128(v, _mm_set1_epi8(1)),
+					 _mm_set1_epi8((char) 0xc3));
+	__m128i single = _mm_or_si128(fixint, _mm_or_si128(nil, boolean));
+	return ~(uint32_t) _mm_movemask_epi8(single) & 0xffff;
+}
+
+static const char *
+mp_skip_sse2(const char *data, uint32_t count)
+{
+	while (count > 0) {
+		if (mp_is_single_byte(*data) && mp_scan_can_load(data, 16)) {
+			/* at least one, at most 16 single-byte values */
+			uint32_t mask = mp_multibyte_mask_sse2(data);
+			uint32_t run = __builtin_ctz(mask | (1U << 16));
+			run = MIN(run, count);
+			data += run;
+			count -= run;
+			continue;
+		}
+		mp_next(&data);
+		count--;
+	}
+	return data;
+}
+
+#if defined(HAVE_AVX2_TARGET_ATTRIBUTE)
+
+/** Same as mp_multibyte_mask_sse2(), but for 32 bytes. */
+__attribute__((target("avx2")))
+static inline uint64_t
+mp_multibyte_mask_avx2(const char *data)
+{
+	__m256i v = _mm256_loadu_si256((const __m256i *) data);
+	__m256i fixint = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(-33));
+	__m256i nil = _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char) 0xc0));
+	__m256i boolean =
+		_mm256_cmpeq_epi8(_mm256_or_si256(v, _mm256_set1_epi8(1)),
+				  _mm256_set1_epi8((char) 0xc3));
+	__m256i single = _mm256_or_si256(fixint,
+					 _mm256_or_si256(nil, boolean));
+	return ~(uint64_t)(uint32_t) _mm256_movemask_epi8(single) &
+		0xffffffffULL;
+}
+
+__attribute__((target("avx2")))
+static const char *
+mp_skip_avx2(const char *data, uint32_t count)
+{
+	while (count > 0) {
+		if (mp_is_single_byte(*data) && mp_scan_can_load(data, 32)) {
+			/* at least one, at most 32 single-byte values */
+			uint64_t mask = mp_multibyte_mask_avx2(data);
+			uint32_t run = __builtin_ctzll(mask | (1ULL << 32));
+			run = MIN(run, count);
+			data += run;
+			count -= run;
+			continue;
+		}
+		mp_next(&data);
+		count--;
+	}
+	return data;
+}
+
+#endif /* defined(HAVE_AVX2_TARGET_ATTRIBUTE) */
+
+mp_skip_func mp_skip_calc = mp_skip_sse2;
+
+#else /* !defined(__x86_64__) */
+
+static const char *
+mp_skip_generic(const char *data, uint32_t count)
+{
+	for (; count > 0; count--)
+		mp_next(&data);
+	return data;
+}
+
+mp_skip_func mp_skip_calc = mp_skip_generic;
+
+#endif /* defined(__x86_64__) */
+
+void
+mp_scan_init(void)
+{
+#if defined(__x86_64__) && defined(HAVE_AVX2_TARGET_ATTRIBUTE)
+	if (avx2_enabled_cpu()) {
+		mp_skip_calc = mp_skip_avx2;
+		return;
+	}
+#endif
+#if defined(__x86_64__)
+	mp_skip_calc = mp_skip_sse2;
+#else
+	mp_skip_calc = mp_skip_generic;
+#endif
+}
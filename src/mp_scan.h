@@ -0,0 +1,88 @@
+#ifndef TARANTOOL_MP_SCAN_H_INCLUDED
+#define TARANTOOL_MP_SCAN_H_INCLUDED
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+#include <msgpuck.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Below this many values, an inline mp_next() loop beats the
+ * indirect call to the vectorized scanner.
+ */
+enum { MP_SKIP_SIMD_THRESHOLD = 4 };
+
+typedef const char *(*mp_skip_func)(const char *data, uint32_t count);
+
+/*
+ * Pointer to an architecture-specific implementation of
+ * skipping a sequence of MsgPack values.
+ */
+extern mp_skip_func mp_skip_calc;
+
+/**
+ * Skip \a count consecutive MsgPack values, like \a count
+ * calls of mp_next() would do. Runs of single-byte values
+ * (fixints, nil, booleans), which are common in tuples, are
+ * skipped 16 or 32 at a time using SIMD where available.
+ * A few values are skipped inline.
+ *
+ * @param data  the first value
+ * @param count the number of values to skip
+ * @return the end of the last skipped value
+ */
+static inline const char *
+mp_skip(const char *data, uint32_t count)
+{
+	if (count < MP_SKIP_SIMD_THRESHOLD) {
+		for (; count > 0; count--)
+			mp_next(&data);
+		return data;
+	}
+	return mp_skip_calc(data, count);
+}
+
+/**
+ * Choose the fastest mp_skip() implementation supported by the
+ * CPU. Until called, the SSE2 implementation is used on x86_64
+ * and a portable one elsewhere.
+ */
+void
+mp_scan_init(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_MP_SCAN_H_INCLUDED */
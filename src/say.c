@@ -56,7 +56,7 @@ static bool logger_background = true;
 static const char *binary_filename;
 static int logger_nonblock;
 
-static int log_fd = STDERR_FILENO;
+int log_fd = STDERR_FILENO;
 static char *log_path; /* iff logger_type == SAY_LOGGER_FILE */
 
 static void
@@ -42,6 +42,8 @@ extern "C" {
 #endif /* defined(__cplusplus) */
 
 extern pid_t logger_pid;
+/** The file descriptor the log is written to. */
+extern int log_fd;
 
 /** \cond public */
 
@@ -92,6 +92,11 @@
 #endif
 #endif
 
+/*
+ * Defined if fallocate(2) call is present.
+ */
+#cmakedefine HAVE_FALLOCATE 1
+
 /*
  * Defined if this platform has BSD specific funopen()
  */
@@ -163,6 +168,12 @@
 #cmakedefine HAVE_FFSL 1
 #cmakedefine HAVE_FFSLL 1
 
+/*
+ * Set if compiler supports AVX2 intrinsics in functions with
+ * __attribute__((target("avx2"))), used with runtime dispatch.
+ */
+#cmakedefine HAVE_AVX2_TARGET_ATTRIBUTE 1
+
 /*
  * pthread have problems with -std=c99
  */
@@ -176,6 +187,10 @@
 #cmakedefine HAVE_SCHED_YIELD 1
 #cmakedefine HAVE_POSIX_FADVISE 1
 #cmakedefine HAVE_MREMAP 1
+#cmakedefine HAVE_MAP_HUGETLB 1
+#cmakedefine HAVE_MADV_HUGEPAGE 1
+#cmakedefine HAVE_SYS_MBIND 1
+#cmakedefine HAVE_INOTIFY_INIT1 1
 
 #cmakedefine HAVE_PRCTL_H 1
 
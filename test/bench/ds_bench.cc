@@ -0,0 +1,799 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * Micro-benchmarks for the data structures in src/lib and for
+ * the tuple comparators.
+ *
+ * Every structure is filled with N distinct keys, then N random
+ * lookups, a full scan and N deletions are timed. N grows tenfold
+ * from --min-size to --max-size. Tuple comparators are timed on
+ * N random pairs of tuples, and of a tuple and a key, for a few
+ * key definitions, against tuple_compare_default() and
+ * tuple_compare_with_key_default(). One JSON object per line is
+ * printed for every (structure, operation, size), so the output
+ * can be collected and compared between builds. Where the kernel
+ * allows, cache misses are counted with perf_event_open(2).
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "trivia/util.h"
+
+typedef uint64_t bench_key_t;
+
+static int
+bench_key_cmp(bench_key_t a, bench_key_t b)
+{
+	return a < b ? -1 : a > b;
+}
+
+#define BPS_TREE_NAME bench_tree
+#define BPS_TREE_BLOCK_SIZE 512
+#define BPS_TREE_EXTENT_SIZE 16 * 1024
+#define BPS_TREE_COMPARE(a, b, arg) bench_key_cmp(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) bench_key_cmp(a, b)
+#define bps_tree_elem_t bench_key_t
+#define bps_tree_key_t bench_key_t
+#define bps_tree_arg_t int
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+#define LIGHT_NAME _bench
+#define LIGHT_DATA_TYPE bench_key_t
+#define LIGHT_KEY_TYPE bench_key_t
+#define LIGHT_CMP_ARG_TYPE int
+#define LIGHT_EQUAL(a, b, arg) ((a) == (b))
+#define LIGHT_EQUAL_KEY(a, b, arg) ((a) == (b))
+#include "salad/light.h"
+#undef LIGHT_NAME
+#undef LIGHT_DATA_TYPE
+#undef LIGHT_KEY_TYPE
+#undef LIGHT_CMP_ARG_TYPE
+#undef LIGHT_EQUAL
+#undef LIGHT_EQUAL_KEY
+
+#define MH_SOURCE 1
+#define mh_name _bench
+struct mh_bench_node_t {
+	bench_key_t key;
+	uint64_t val;
+};
+#define mh_node_t struct mh_bench_node_t
+#define mh_arg_t void *
+#define mh_hash(a, arg) ((uint32_t) ((a)->key ^ ((a)->key >> 32)))
+#define mh_cmp(a, b, arg) ((a)->key != (b)->key)
+#include "salad/mhash.h"
+#undef MH_SOURCE
+
+#include "salad/rtree.h"
+#include "salad/rope.h"
+#include "bitset/index.h"
+#include "msgpuck/msgpuck.h"
+#include "box/key_def.h"
+#include "box/tuple.h"
+#include "box/tuple_format.h"
+#include "box/tuple_compare.h"
+
+static const size_t BENCH_EXTENT_SIZE = 16 * 1024;
+
+static void *
+bench_extent_alloc(void *ctx)
+{
+	(void) ctx;
+	return malloc(BENCH_EXTENT_SIZE);
+}
+
+static void
+bench_extent_free(void *ctx, void *extent)
+{
+	(void) ctx;
+	free(extent);
+}
+
+/**
+ * A bijective 64-bit mixer (splitmix64 finalizer): distinct
+ * indexes give distinct, evenly spread keys, so nothing has to
+ * be stored to generate or look up the i-th key.
+ */
+static inline bench_key_t
+bench_key(uint64_t i)
+{
+	uint64_t z = i + 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static uint64_t bench_rand_state = 88172645463325252ULL;
+
+/** A random index in [0, n), xorshift64. */
+static inline uint64_t
+bench_rand(uint64_t n)
+{
+	uint64_t x = bench_rand_state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	bench_rand_state = x;
+	return x % n;
+}
+
+static inline uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/** Hardware cache miss counter, -1 if not available. */
+static int perf_fd = -1;
+
+static void
+perf_open(void)
+{
+#if defined(__linux__)
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	perf_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if (perf_fd >= 0)
+		ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+static int64_t
+perf_read(void)
+{
+	uint64_t count;
+	if (perf_fd < 0 || read(perf_fd, &count, sizeof(count)) !=
+	    (ssize_t) sizeof(count))
+		return -1;
+	return count;
+}
+
+/** Measurement of a single benchmark phase. */
+struct bench_timer {
+	const char *structure;
+	size_t size;
+	uint64_t start_ns;
+	int64_t start_misses;
+};
+
+static void
+bench_start(struct bench_timer *t)
+{
+	t->start_misses = perf_read();
+	t->start_ns = bench_now_ns();
+}
+
+static void
+bench_stop(struct bench_timer *t, const char *op, size_t ops)
+{
+	uint64_t ns = bench_now_ns() - t->start_ns;
+	int64_t misses = perf_read();
+	if (ops == 0)
+		ops = 1;
+	printf("{\"structure\": \"%s\", \"op\": \"%s\", \"size\": %zu, "
+	       "\"ops\": %zu, \"ns_per_op\": %.2f, \"mops\": %.3f, "
+	       "\"cache_misses_per_op\": ", t->structure, op, t->size, ops,
+	       (double) ns / ops, ns > 0 ? (double) ops * 1e3 / ns : 0);
+	if (misses >= 0 && t->start_misses >= 0)
+		printf("%.3f}\n", (double) (misses - t->start_misses) / ops);
+	else
+		printf("null}\n");
+	fflush(stdout);
+}
+
+/**
+ * Lookups are done for keys known to be present. A miss means
+ * the structure is broken, and the timings are meaningless.
+ */
+static void
+bench_check_found(struct bench_timer *t, uint64_t found, size_t n)
+{
+	if (found == n)
+		return;
+	fprintf(stderr, "%s: found %llu of %zu keys\n", t->structure,
+		(unsigned long long) found, n);
+	exit(1);
+}
+
+/**
+ * Scan results are summed into this variable so that the
+ * compiler can't throw the loops away.
+ */
+static volatile uint64_t bench_sink;
+
+static void
+bench_bps_tree(size_t n)
+{
+	struct bench_timer t = { "bps_tree", n, 0, 0 };
+	struct bench_tree tree;
+	bench_tree_create(&tree, 0, bench_extent_alloc, bench_extent_free,
+			  NULL);
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++)
+		bench_tree_insert(&tree, bench_key(i), NULL);
+	bench_stop(&t, "insert", n);
+
+	bench_start(&t);
+	uint64_t found = 0;
+	for (size_t i = 0; i < n; i++)
+		found += bench_tree_find(&tree, bench_key(bench_rand(n))) != NULL;
+	bench_stop(&t, "lookup", n);
+	bench_check_found(&t, found, n);
+
+	bench_start(&t);
+	uint64_t sum = 0;
+	struct bench_tree_iterator it = bench_tree_iterator_first(&tree);
+	bench_key_t *elem;
+	while ((elem = bench_tree_iterator_get_elem(&tree, &it)) != NULL) {
+		sum += *elem;
+		bench_tree_iterator_next(&tree, &it);
+	}
+	bench_stop(&t, "scan", n);
+	bench_sink += sum;
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++)
+		bench_tree_delete(&tree, bench_key(i));
+	bench_stop(&t, "delete", n);
+	bench_tree_destroy(&tree);
+}
+
+static void
+bench_light(size_t n)
+{
+	struct bench_timer t = { "light", n, 0, 0 };
+	struct light_bench_core ht;
+	light_bench_create(&ht, BENCH_EXTENT_SIZE, bench_extent_alloc,
+			   bench_extent_free, NULL, 0);
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		bench_key_t key = bench_key(i);
+		light_bench_insert(&ht, (uint32_t) key, key);
+	}
+	bench_stop(&t, "insert", n);
+
+	bench_start(&t);
+	uint64_t found = 0;
+	for (size_t i = 0; i < n; i++) {
+		bench_key_t key = bench_key(bench_rand(n));
+		found += light_bench_find(&ht, (uint32_t) key, key) !=
+			 light_bench_end;
+	}
+	bench_stop(&t, "lookup", n);
+	bench_check_found(&t, found, n);
+
+	bench_start(&t);
+	uint64_t sum = 0;
+	struct light_bench_iterator it;
+	light_bench_iterator_begin(&ht, &it);
+	bench_key_t *elem;
+	while ((elem = light_bench_iterator_get_and_next(&ht, &it)) != NULL)
+		sum += *elem;
+	bench_stop(&t, "scan", n);
+	bench_sink += sum;
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		bench_key_t key = bench_key(i);
+		light_bench_delete_value(&ht, (uint32_t) key, key);
+	}
+	bench_stop(&t, "delete", n);
+	light_bench_destroy(&ht);
+}
+
+static void
+bench_mhash(size_t n)
+{
+	struct bench_timer t = { "mhash", n, 0, 0 };
+	struct mh_bench_t *h = mh_bench_new();
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		struct mh_bench_node_t node = { bench_key(i), i };
+		mh_bench_put(h, &node, NULL, NULL);
+	}
+	bench_stop(&t, "insert", n);
+
+	bench_start(&t);
+	uint64_t found = 0;
+	for (size_t i = 0; i < n; i++) {
+		struct mh_bench_node_t node = { bench_key(bench_rand(n)), 0 };
+		found += mh_bench_get(h, &node, NULL) != mh_end(h);
+	}
+	bench_stop(&t, "lookup", n);
+	bench_check_found(&t, found, n);
+
+	bench_start(&t);
+	uint64_t sum = 0;
+	mh_int_t k;
+	mh_foreach(h, k)
+		sum += mh_bench_node(h, k)->val;
+	bench_stop(&t, "scan", n);
+	bench_sink += sum;
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		struct mh_bench_node_t node = { bench_key(i), 0 };
+		mh_bench_remove(h, &node, NULL);
+	}
+	bench_stop(&t, "delete", n);
+	mh_bench_delete(h);
+}
+
+/** Map a key to a point on a 2D grid. */
+static inline void
+bench_rtree_rect(struct rtree_rect *rect, size_t i)
+{
+	bench_key_t key = bench_key(i);
+	rtree_set2dp(rect, (coord_t) (key & 0xffffffff),
+		     (coord_t) (key >> 32));
+}
+
+static void
+bench_rtree(size_t n)
+{
+	struct bench_timer t = { "rtree", n, 0, 0 };
+	struct rtree tree;
+	struct rtree_rect rect;
+	struct rtree_iterator it;
+	rtree_init(&tree, 2, BENCH_EXTENT_SIZE, bench_extent_alloc,
+		   bench_extent_free, NULL, RTREE_EUCLID);
+	rtree_iterator_init(&it);
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		bench_rtree_rect(&rect, i);
+		rtree_insert(&tree, &rect, (record_t) (i + 1));
+	}
+	bench_stop(&t, "insert", n);
+
+	bench_start(&t);
+	uint64_t found = 0;
+	for (size_t i = 0; i < n; i++) {
+		bench_rtree_rect(&rect, bench_rand(n));
+		if (rtree_search(&tree, &rect, SOP_EQUALS, &it))
+			found += rtree_iterator_next(&it) != NULL;
+	}
+	bench_stop(&t, "lookup", n);
+	bench_check_found(&t, found, n);
+
+	bench_start(&t);
+	uint64_t sum = 0;
+	rtree_search(&tree, &rect, SOP_ALL, &it);
+	record_t rec;
+	while ((rec = rtree_iterator_next(&it)) != NULL)
+		sum += (uintptr_t) rec;
+	bench_stop(&t, "scan", n);
+	bench_sink += sum;
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		bench_rtree_rect(&rect, i);
+		rtree_remove(&tree, &rect, (record_t) (i + 1));
+	}
+	bench_stop(&t, "delete", n);
+	rtree_iterator_destroy(&it);
+	rtree_destroy(&tree);
+}
+
+static void
+bench_bitset(size_t n)
+{
+	struct bench_timer t = { "bitset", n, 0, 0 };
+	struct bitset_index index;
+	struct bitset_expr expr;
+	struct bitset_iterator it;
+	bitset_index_create(&index, realloc);
+	bitset_expr_create(&expr, realloc);
+	bitset_iterator_create(&it, realloc);
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		uint32_t key = (uint32_t) bench_key(i);
+		bitset_index_insert(&index, &key, sizeof(key), i);
+	}
+	bench_stop(&t, "insert", n);
+
+	bench_start(&t);
+	uint64_t found = 0;
+	for (size_t i = 0; i < n; i++)
+		found += bitset_index_contains_value(&index, bench_rand(n));
+	bench_stop(&t, "lookup", n);
+	bench_check_found(&t, found, n);
+
+	bench_start(&t);
+	uint64_t sum = 0;
+	bitset_index_expr_all(&expr);
+	bitset_index_init_iterator(&index, &it, &expr);
+	size_t value;
+	while ((value = bitset_iterator_next(&it)) != SIZE_MAX)
+		sum += value;
+	bench_stop(&t, "scan", n);
+	bench_sink += sum;
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++)
+		bitset_index_remove_value(&index, i);
+	bench_stop(&t, "delete", n);
+	bitset_iterator_destroy(&it);
+	bitset_expr_destroy(&expr);
+	bitset_index_destroy(&index);
+}
+
+static void *
+bench_rope_split(void *ctx, void *data, size_t size, size_t offset)
+{
+	(void) ctx;
+	(void) size;
+	return (char *) data + offset;
+}
+
+static void *
+bench_rope_alloc(void *ctx, size_t size)
+{
+	(void) ctx;
+	return malloc(size);
+}
+
+static void
+bench_rope_free(void *ctx, void *ptr)
+{
+	(void) ctx;
+	free(ptr);
+}
+
+static void
+bench_rope(size_t n)
+{
+	struct bench_timer t = { "rope", n, 0, 0 };
+	static char data[1];
+	struct rope *rope = rope_new(bench_rope_split, NULL,
+				     bench_rope_alloc, bench_rope_free, NULL);
+
+	/* Every insert adds a one-element node at a random offset. */
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++)
+		rope_insert(rope, bench_rand(i + 1), data, 1);
+	bench_stop(&t, "insert", n);
+
+	bench_start(&t);
+	uint64_t found = 0;
+	for (size_t i = 0; i < n; i++)
+		found += rope_extract(rope, bench_rand(n)) != NULL;
+	bench_stop(&t, "lookup", n);
+	bench_check_found(&t, found, n);
+
+	bench_start(&t);
+	uint64_t sum = 0;
+	struct rope_iter it;
+	rope_iter_create(&it, rope);
+	for (struct rope_node *node = rope_iter_start(&it); node != NULL;
+	     node = rope_iter_next(&it))
+		sum += rope_leaf_size(node);
+	bench_stop(&t, "scan", n);
+	bench_sink += sum;
+
+	bench_start(&t);
+	for (size_t i = n; i > 0; i--)
+		rope_erase(rope, bench_rand(i));
+	bench_stop(&t, "delete", n);
+	rope_delete(rope);
+}
+
+/*
+ * Tuple comparators. ds_bench pulls only tuple_compare.o out of
+ * libbox: all tuples share a single format without indexed
+ * fields, which is registered here.
+ */
+struct tuple_format **tuple_formats;
+static struct tuple_format *bench_format;
+
+enum { BENCH_TUPLE_FIELD_COUNT = 3 };
+
+/** Keys tuples are compared by. */
+static const struct {
+	const char *name;
+	uint32_t part_count;
+	struct key_part parts[BENCH_TUPLE_FIELD_COUNT];
+} bench_tuple_keys[] = {
+	{ "unsigned", 1, {{0, FIELD_TYPE_UNSIGNED}} },
+	{ "string", 1, {{0, FIELD_TYPE_STRING}} },
+	{ "scalar", 1, {{0, FIELD_TYPE_SCALAR}} },
+	{ "unsigned_string", 2,
+	  {{0, FIELD_TYPE_UNSIGNED}, {1, FIELD_TYPE_STRING}} },
+	{ "integer_unsigned_string", 3,
+	  {{0, FIELD_TYPE_INTEGER}, {1, FIELD_TYPE_UNSIGNED},
+	   {2, FIELD_TYPE_STRING}} },
+	/* A secondary key merged with the primary one. */
+	{ "string_unsigned_merged", 2,
+	  {{1, FIELD_TYPE_STRING}, {0, FIELD_TYPE_UNSIGNED}} },
+};
+
+/**
+ * Encode a field of the i-th tuple. The first field takes few
+ * distinct values, so that multipart keys often have to look
+ * at the following parts.
+ */
+static char *
+bench_tuple_field(char *pos, enum field_type type, uint32_t fieldno,
+		  size_t i)
+{
+	bench_key_t key = bench_key(i);
+	uint64_t value = fieldno == 0 ? key % 64 : key >> (fieldno * 16);
+	char str[32];
+	switch (type) {
+	case FIELD_TYPE_STRING:
+		snprintf(str, sizeof(str), "%016llx",
+			 (unsigned long long) value);
+		return mp_encode_str(pos, str, strlen(str));
+	case FIELD_TYPE_INTEGER:
+		return mp_encode_int(pos, (int64_t) (value % 1024) - 512);
+	default:
+		return mp_encode_uint(pos, value);
+	}
+}
+
+static struct tuple *
+bench_tuple_new(const enum field_type *types, size_t i)
+{
+	char data[128];
+	char *pos = mp_encode_array(data, BENCH_TUPLE_FIELD_COUNT);
+	for (uint32_t f = 0; f < BENCH_TUPLE_FIELD_COUNT; f++)
+		pos = bench_tuple_field(pos, types[f], f, i);
+	size_t size = pos - data;
+	struct tuple *tuple =
+		(struct tuple *) calloc(1, sizeof(*tuple) + size);
+	if (tuple == NULL) {
+		fprintf(stderr, "tuple_compare: out of memory\n");
+		exit(1);
+	}
+	tuple->format_id = bench_format->id;
+	tuple->size = size;
+	memcpy(tuple->raw, data, size);
+	return tuple;
+}
+
+/**
+ * Compare random pairs of tuples with the comparator picked
+ * for the key definition and with the default one.
+ */
+static void
+bench_tuple_compare_key(size_t n, size_t k)
+{
+	uint32_t part_count = bench_tuple_keys[k].part_count;
+	struct key_def *def = (struct key_def *)
+		calloc(1, sizeof(*def) + part_count * sizeof(def->parts[0]));
+	if (def == NULL) {
+		fprintf(stderr, "tuple_compare: out of memory\n");
+		exit(1);
+	}
+	def->type = TREE;
+	def->part_count = part_count;
+	enum field_type types[BENCH_TUPLE_FIELD_COUNT] = {
+		FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED, FIELD_TYPE_UNSIGNED
+	};
+	for (uint32_t i = 0; i < part_count; i++) {
+		def->parts[i] = bench_tuple_keys[k].parts[i];
+		types[def->parts[i].fieldno] = def->parts[i].type;
+	}
+	tuple_compare_t cmp = tuple_compare_create(def);
+	tuple_compare_with_key_t cmp_wk = tuple_compare_with_key_create(def);
+
+	struct tuple **tuples = (struct tuple **) calloc(n, sizeof(*tuples));
+	const char **keys = (const char **) calloc(n, sizeof(*keys));
+	if (tuples == NULL || keys == NULL) {
+		fprintf(stderr, "tuple_compare: out of memory\n");
+		exit(1);
+	}
+	for (size_t i = 0; i < n; i++) {
+		tuples[i] = bench_tuple_new(types, i);
+		/* The key follows the tuple in key part order. */
+		char *key = (char *) malloc(tuples[i]->size);
+		if (key == NULL) {
+			fprintf(stderr, "tuple_compare: out of memory\n");
+			exit(1);
+		}
+		char *pos = key;
+		for (uint32_t p = 0; p < part_count; p++) {
+			const char *field = tuple_field_raw(bench_format,
+					tuple_key_data(tuples[i]),
+					tuple_field_map(tuples[i]),
+					def->parts[p].fieldno);
+			const char *end = field;
+			mp_next(&end);
+			memcpy(pos, field, end - field);
+			pos += end - field;
+		}
+		keys[i] = key;
+	}
+
+	char structure[64];
+	snprintf(structure, sizeof(structure), "tuple_compare/%s",
+		 bench_tuple_keys[k].name);
+	struct bench_timer t = { structure, n, 0, 0 };
+	uint64_t sum = 0;
+	uint64_t state = bench_rand_state;
+
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++)
+		sum += cmp(tuples[bench_rand(n)], tuples[bench_rand(n)], def);
+	bench_stop(&t, "compare", n);
+
+	/* Same pairs for the default comparator. */
+	bench_rand_state = state;
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		sum += tuple_compare_default(tuples[bench_rand(n)],
+					     tuples[bench_rand(n)], def);
+	}
+	bench_stop(&t, "compare_default", n);
+
+	state = bench_rand_state;
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		sum += cmp_wk(tuples[bench_rand(n)], keys[bench_rand(n)],
+			      part_count, def);
+	}
+	bench_stop(&t, "compare_with_key", n);
+
+	bench_rand_state = state;
+	bench_start(&t);
+	for (size_t i = 0; i < n; i++) {
+		sum += tuple_compare_with_key_default(tuples[bench_rand(n)],
+						      keys[bench_rand(n)],
+						      part_count, def);
+	}
+	bench_stop(&t, "compare_with_key_default", n);
+	bench_sink += sum;
+
+	for (size_t i = 0; i < n; i++) {
+		free(tuples[i]);
+		free((char *) keys[i]);
+	}
+	free(tuples);
+	free(keys);
+	free(def);
+}
+
+static void
+bench_tuple_compare(size_t n)
+{
+	if (bench_format == NULL) {
+		bench_format = (struct tuple_format *)
+			calloc(1, sizeof(*bench_format));
+		if (bench_format == NULL) {
+			fprintf(stderr, "tuple_compare: out of memory\n");
+			exit(1);
+		}
+		tuple_formats = &bench_format;
+	}
+	for (size_t k = 0; k < lengthof(bench_tuple_keys); k++)
+		bench_tuple_compare_key(n, k);
+}
+
+static const struct {
+	const char *name;
+	void (*run)(size_t n);
+} benchmarks[] = {
+	{ "bps_tree", bench_bps_tree },
+	{ "light", bench_light },
+	{ "mhash", bench_mhash },
+	{ "rtree", bench_rtree },
+	{ "bitset", bench_bitset },
+	{ "rope", bench_rope },
+	{ "tuple_compare", bench_tuple_compare },
+};
+
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [options] [structure...]\n"
+	       "  -m, --min-size N   smallest number of elements (1000)\n"
+	       "  -M, --max-size N   largest number of elements (1000000)\n"
+	       "Structures:", prog);
+	for (size_t i = 0; i < lengthof(benchmarks); i++)
+		printf(" %s", benchmarks[i].name);
+	printf("\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option longopts[] = {
+		{"min-size", required_argument, 0, 'm'},
+		{"max-size", required_argument, 0, 'M'},
+		{"help", no_argument, 0, 'h'},
+		{NULL, 0, 0, 0}
+	};
+	size_t min_size = 1000;
+	size_t max_size = 1000000;
+	int ch;
+	while ((ch = getopt_long(argc, argv, "m:M:h", longopts,
+				 NULL)) != -1) {
+		switch (ch) {
+		case 'm': min_size = strtoull(optarg, NULL, 10); break;
+		case 'M': max_size = strtoull(optarg, NULL, 10); break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (min_size == 0 || min_size > max_size) {
+		usage(argv[0]);
+		return 1;
+	}
+	perf_open();
+	for (size_t i = 0; i < lengthof(benchmarks); i++) {
+		if (optind < argc) {
+			bool selected = false;
+			for (int j = optind; j < argc; j++)
+				selected |= strcmp(argv[j], benchmarks[i].name) == 0;
+			if (!selected)
+				continue;
+		}
+		for (size_t n = min_size; n <= max_size; n *= 10)
+			benchmarks[i].run(n);
+	}
+	return 0;
+}
@@ -0,0 +1,679 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * tarantool-bench: a load generator speaking the binary protocol.
+ *
+ * Opens a number of connections to a running instance and keeps
+ * up to --pipeline requests in flight on each of them. Requests
+ * are a weighted mix of SELECT, REPLACE, UPDATE and CALL on keys
+ * drawn from a uniform or a zipfian distribution. Every request
+ * carries its send time in IPROTO_SYNC, so the latency is measured
+ * from the sync of the response, without any per-request state.
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory.h"
+#include "fiber.h"
+#include "coio.h"
+#include "coeio.h"
+#include "iobuf.h"
+#include "uri.h"
+#include "clock.h"
+#include "histogram.h"
+#include "msgpuck/msgpuck.h"
+#include "box/error.h"
+#include "box/xrow.h"
+#include "box/xrow_io.h"
+#include "box/iproto_constants.h"
+
+enum bench_op {
+	BENCH_SELECT,
+	BENCH_REPLACE,
+	BENCH_UPDATE,
+	BENCH_CALL,
+	BENCH_OP_MAX
+};
+
+static const char *bench_op_strs[BENCH_OP_MAX] = {
+	"select", "replace", "update", "call"
+};
+
+static struct bench_opts {
+	const char *uri;
+	int connections;
+	int pipeline;
+	double duration;
+	uint64_t keys;
+	double zipf_theta;
+	uint32_t space_id;
+	const char *function;
+	int value_size;
+	bool prefill;
+	/** Relative weights of operations, see enum bench_op. */
+	int mix[BENCH_OP_MAX];
+} opts = {
+	"localhost:3301", 16, 32, 10, 100000, 0, 512, "bench", 32, false,
+	{ 80, 10, 10, 0 }
+};
+
+/**
+ * Zipfian key generator, see J. Gray et al. "Quickly Generating
+ * Billion-Record Synthetic Databases", SIGMOD 1994.
+ */
+struct zipf {
+	uint64_t n;
+	double theta;
+	double alpha;
+	double zetan;
+	double eta;
+	double half_pow_theta;
+};
+
+static double
+zipf_zeta(uint64_t n, double theta)
+{
+	double sum = 0;
+	for (uint64_t i = 1; i <= n; i++)
+		sum += 1 / pow((double) i, theta);
+	return sum;
+}
+
+static void
+zipf_create(struct zipf *z, uint64_t n, double theta)
+{
+	z->n = n;
+	z->theta = theta;
+	if (theta == 0)
+		return;
+	z->alpha = 1 / (1 - theta);
+	z->zetan = zipf_zeta(n, theta);
+	z->eta = (1 - pow(2.0 / n, 1 - theta)) /
+		 (1 - zipf_zeta(2, theta) / z->zetan);
+	z->half_pow_theta = pow(0.5, theta);
+}
+
+static uint64_t bench_rand_state = 88172645463325252ULL;
+
+/** xorshift64, good enough to pick keys and operations. */
+static inline uint64_t
+bench_rand(void)
+{
+	uint64_t x = bench_rand_state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return bench_rand_state = x;
+}
+
+/** A uniformly distributed double in [0, 1). */
+static inline double
+bench_rand_double(void)
+{
+	return (bench_rand() >> 11) * (1.0 / (1ULL << 53));
+}
+
+static uint64_t
+zipf_next(struct zipf *z)
+{
+	if (z->theta == 0)
+		return bench_rand() % z->n;
+	double u = bench_rand_double();
+	double uz = u * z->zetan;
+	if (uz < 1)
+		return 0;
+	if (uz < 1 + z->half_pow_theta)
+		return 1;
+	uint64_t k = z->n * pow(z->eta * u - z->eta + 1, z->alpha);
+	return k < z->n ? k : z->n - 1;
+}
+
+/** Encoded request header: { TYPE: type, SYNC: sync }. */
+struct PACKED bench_header_bin {
+	uint8_t m_len;                          /* MP_UINT32 */
+	uint32_t v_len;                         /* length */
+	uint8_t m_header;                       /* MP_MAP */
+	uint8_t k_code;                         /* IPROTO_REQUEST_TYPE */
+	uint8_t m_code;                         /* MP_UINT32 */
+	uint32_t v_code;                        /* request type */
+	uint8_t k_sync;                         /* IPROTO_SYNC */
+	uint8_t m_sync;                         /* MP_UINT64 */
+	uint64_t v_sync;                        /* sync */
+};
+
+static const struct bench_header_bin bench_header_bin = {
+	0xce, 0, 0x82,
+	IPROTO_REQUEST_TYPE, 0xce, 0,
+	IPROTO_SYNC, 0xcf, 0
+};
+
+struct bench_conn {
+	/** Connection number, used to split keys on prefill. */
+	int id;
+	/** Watchers for the reader and the writer fibers. */
+	struct ev_io io;
+	struct ev_io wio;
+	struct iobuf *iobuf;
+	struct fiber *writer;
+	/** Writer waits for responses to free pipeline slots. */
+	bool writer_is_waiting;
+	int in_flight;
+};
+
+static struct bench_state {
+	struct zipf zipf;
+	int mix_total;
+	/** Set to stop the writers. */
+	bool stop;
+	/** Prefill mode: replace every key once. */
+	bool is_prefill;
+	int writers;
+	uint64_t requests;
+	uint64_t errors;
+	uint64_t op_count[BENCH_OP_MAX];
+	/** Latency in microseconds. */
+	struct histogram *latency;
+	char *value;
+} bench;
+
+static enum bench_op
+bench_next_op(void)
+{
+	int r = bench_rand() % bench.mix_total;
+	for (int op = 0; op < BENCH_OP_MAX; op++) {
+		if (r < opts.mix[op])
+			return (enum bench_op) op;
+		r -= opts.mix[op];
+	}
+	unreachable();
+	return BENCH_SELECT;
+}
+
+/**
+ * Encode one request into the output buffer. The bodies are
+ * encoded here rather than with request_encode(), which only
+ * writes the keys of DML requests stored in the WAL.
+ */
+static void
+bench_encode(struct obuf *out, enum bench_op op, uint64_t key)
+{
+	size_t size = 64 + opts.value_size + strlen(opts.function);
+	char *body = (char *) region_alloc_xc(&fiber()->gc, size);
+	char *pos = body;
+	uint32_t type;
+
+	switch (op) {
+	case BENCH_SELECT:
+		type = IPROTO_SELECT;
+		/* Offset 0 and iterator EQ are the defaults. */
+		pos = mp_encode_map(pos, 3);
+		pos = mp_encode_uint(pos, IPROTO_SPACE_ID);
+		pos = mp_encode_uint(pos, opts.space_id);
+		pos = mp_encode_uint(pos, IPROTO_LIMIT);
+		pos = mp_encode_uint(pos, 1);
+		pos = mp_encode_uint(pos, IPROTO_KEY);
+		pos = mp_encode_array(pos, 1);
+		pos = mp_encode_uint(pos, key);
+		break;
+	case BENCH_REPLACE:
+		type = IPROTO_REPLACE;
+		pos = mp_encode_map(pos, 2);
+		pos = mp_encode_uint(pos, IPROTO_SPACE_ID);
+		pos = mp_encode_uint(pos, opts.space_id);
+		pos = mp_encode_uint(pos, IPROTO_TUPLE);
+		pos = mp_encode_array(pos, 2);
+		pos = mp_encode_uint(pos, key);
+		pos = mp_encode_str(pos, bench.value, opts.value_size);
+		break;
+	case BENCH_UPDATE:
+		type = IPROTO_UPDATE;
+		pos = mp_encode_map(pos, 4);
+		pos = mp_encode_uint(pos, IPROTO_SPACE_ID);
+		pos = mp_encode_uint(pos, opts.space_id);
+		pos = mp_encode_uint(pos, IPROTO_INDEX_BASE);
+		pos = mp_encode_uint(pos, 1);
+		pos = mp_encode_uint(pos, IPROTO_KEY);
+		pos = mp_encode_array(pos, 1);
+		pos = mp_encode_uint(pos, key);
+		/* [['=', 2, value]] */
+		pos = mp_encode_uint(pos, IPROTO_TUPLE);
+		pos = mp_encode_array(pos, 1);
+		pos = mp_encode_array(pos, 3);
+		pos = mp_encode_str(pos, "=", 1);
+		pos = mp_encode_uint(pos, 2);
+		pos = mp_encode_str(pos, bench.value, opts.value_size);
+		break;
+	case BENCH_CALL:
+		type = IPROTO_CALL;
+		pos = mp_encode_map(pos, 2);
+		pos = mp_encode_uint(pos, IPROTO_FUNCTION_NAME);
+		pos = mp_encode_str(pos, opts.function,
+				    strlen(opts.function));
+		/* Pass the key as the only argument. */
+		pos = mp_encode_uint(pos, IPROTO_TUPLE);
+		pos = mp_encode_array(pos, 1);
+		pos = mp_encode_uint(pos, key);
+		break;
+	default:
+		unreachable();
+		return;
+	}
+	assert(pos <= body + size);
+
+	struct bench_header_bin header = bench_header_bin;
+	header.v_len = mp_bswap_u32(sizeof(header) - 5 + (pos - body));
+	header.v_code = mp_bswap_u32(type);
+	header.v_sync = mp_bswap_u64(clock_monotonic64());
+	obuf_dup_xc(out, &header, sizeof(header));
+	obuf_dup_xc(out, body, pos - body);
+	bench.op_count[op]++;
+}
+
+static int
+bench_writer_f(va_list ap)
+{
+	struct bench_conn *conn = va_arg(ap, struct bench_conn *);
+	struct obuf *out = &conn->iobuf->out;
+	uint64_t next_key = conn->id;
+	while (!bench.stop) {
+		while (conn->in_flight >= opts.pipeline && !bench.stop) {
+			conn->writer_is_waiting = true;
+			fiber_yield();
+			conn->writer_is_waiting = false;
+		}
+		if (bench.stop)
+			break;
+		/* Fill all free pipeline slots with a single write. */
+		int batch = 0;
+		while (conn->in_flight + batch < opts.pipeline) {
+			if (bench.is_prefill) {
+				if (next_key >= opts.keys)
+					break;
+				bench_encode(out, BENCH_REPLACE, next_key);
+				next_key += opts.connections;
+			} else {
+				bench_encode(out, bench_next_op(),
+					     zipf_next(&bench.zipf));
+			}
+			batch++;
+		}
+		if (batch == 0)
+			break;
+		conn->in_flight += batch;
+		try {
+			coio_writev(&conn->wio, out->iov, obuf_iovcnt(out),
+				    obuf_size(out));
+		} catch (Exception *e) {
+			fprintf(stderr, "write failed: %s\n", e->errmsg);
+			break;
+		}
+		obuf_reset(out);
+		fiber_gc();
+	}
+	bench.writers--;
+	return 0;
+}
+
+static int
+bench_reader_f(va_list ap)
+{
+	struct bench_conn *conn = va_arg(ap, struct bench_conn *);
+	struct ibuf *in = &conn->iobuf->in;
+	struct xrow_header row;
+	while (true) {
+		try {
+			coio_read_xrow(&conn->io, in, &row);
+		} catch (Exception *e) {
+			fprintf(stderr, "read failed: %s\n", e->errmsg);
+			/* Don't wait for the lost responses. */
+			conn->in_flight = 0;
+			bench.stop = true;
+			if (conn->writer_is_waiting)
+				fiber_wakeup(conn->writer);
+			return -1;
+		}
+		uint64_t now = clock_monotonic64();
+		histogram_collect(bench.latency, (now - row.sync) / 1000);
+		bench.requests++;
+		if (row.type != IPROTO_OK)
+			bench.errors++;
+		if (ibuf_used(in) == 0)
+			ibuf_reset(in);
+		conn->in_flight--;
+		if (conn->writer_is_waiting)
+			fiber_wakeup(conn->writer);
+	}
+	return 0;
+}
+
+static void
+bench_connect(struct bench_conn *conn, struct uri *uri)
+{
+	char greetingbuf[IPROTO_GREETING_SIZE];
+	struct sockaddr_storage addrstorage;
+	socklen_t addr_len = sizeof(addrstorage);
+	coio_connect(&conn->io, uri, (struct sockaddr *) &addrstorage,
+		     &addr_len);
+	coio_readn(&conn->io, greetingbuf, IPROTO_GREETING_SIZE);
+
+	struct greeting greeting;
+	if (greeting_decode(greetingbuf, &greeting) != 0 ||
+	    strcmp(greeting.protocol, "Binary") != 0)
+		tnt_raise(ClientError, ER_PROTOCOL, "Invalid greeting");
+
+	if (uri->login != NULL) {
+		struct xrow_header row;
+		xrow_encode_auth(&row, greeting.salt, greeting.salt_len,
+				 uri->login, uri->login_len,
+				 uri->password, uri->password_len);
+		coio_write_xrow(&conn->io, &row);
+		coio_read_xrow(&conn->io, &conn->iobuf->in, &row);
+		if (row.type != IPROTO_OK)
+			xrow_decode_error(&row); /* auth failed */
+		ibuf_reset(&conn->iobuf->in);
+	}
+	coio_init(&conn->wio, conn->io.fd);
+}
+
+static void
+bench_start_writers(struct bench_conn *conns)
+{
+	bench.stop = false;
+	bench.writers = opts.connections;
+	for (int i = 0; i < opts.connections; i++) {
+		conns[i].writer = fiber_new_xc("writer", bench_writer_f);
+		fiber_start(conns[i].writer, &conns[i]);
+	}
+}
+
+/** Wait until all the sent requests get their responses. */
+static void
+bench_drain(struct bench_conn *conns)
+{
+	for (int i = 0; i < opts.connections; i++) {
+		while (conns[i].in_flight > 0)
+			fiber_sleep(0.001);
+	}
+}
+
+static void
+bench_reset_stat(void)
+{
+	bench.requests = 0;
+	bench.errors = 0;
+	memset(bench.op_count, 0, sizeof(bench.op_count));
+	for (size_t i = 0; i < bench.latency->n_buckets; i++)
+		bench.latency->buckets[i].count = 0;
+	bench.latency->total = 0;
+	bench.latency->max = 0;
+}
+
+/**
+ * Unlike histogram_percentile() accepts fractional percentiles,
+ * such as 99.99.
+ */
+static int64_t
+bench_percentile(struct histogram *hist, double pct)
+{
+	size_t count = 0;
+	for (size_t i = 0; i < hist->n_buckets; i++) {
+		count += hist->buckets[i].count;
+		if (count * 100.0 >= hist->total * pct)
+			return hist->buckets[i].max;
+	}
+	return hist->max;
+}
+
+static void
+bench_report(double elapsed)
+{
+	struct histogram *h = bench.latency;
+	printf("requests: %llu, errors: %llu, elapsed: %.2f s, "
+	       "rps: %.0f\n", (unsigned long long) bench.requests,
+	       (unsigned long long) bench.errors, elapsed,
+	       bench.requests / elapsed);
+	for (int op = 0; op < BENCH_OP_MAX; op++) {
+		if (opts.mix[op] == 0)
+			continue;
+		printf("  %-8s %llu\n", bench_op_strs[op],
+		       (unsigned long long) bench.op_count[op]);
+	}
+	static const double pcts[] = { 50, 90, 99, 99.9, 99.99 };
+	printf("latency, us:");
+	for (size_t i = 0; i < lengthof(pcts); i++) {
+		printf(" p%g: %lld", pcts[i],
+		       (long long) bench_percentile(h, pcts[i]));
+	}
+	printf(" max: %lld\n", (long long) h->max);
+}
+
+static int
+bench_main_f(va_list ap)
+{
+	struct uri uri;
+	if (uri_parse(&uri, opts.uri) != 0 || uri.service == NULL) {
+		fprintf(stderr, "invalid uri: %s\n", opts.uri);
+		ev_break(loop(), EVBREAK_ALL);
+		return -1;
+	}
+	struct bench_conn *conns = (struct bench_conn *)
+		calloc(opts.connections, sizeof(*conns));
+	if (conns == NULL)
+		panic("failed to allocate connections");
+	for (int i = 0; i < opts.connections; i++) {
+		struct bench_conn *conn = &conns[i];
+		conn->id = i;
+		conn->iobuf = iobuf_new();
+		coio_init(&conn->io, -1);
+		try {
+			bench_connect(conn, &uri);
+		} catch (Exception *e) {
+			fprintf(stderr, "failed to connect to %s: %s\n",
+				opts.uri, e->errmsg);
+			ev_break(loop(), EVBREAK_ALL);
+			return -1;
+		}
+		struct fiber *reader = fiber_new_xc("reader", bench_reader_f);
+		fiber_start(reader, conn);
+	}
+
+	if (opts.prefill) {
+		bench.is_prefill = true;
+		double start = clock_monotonic();
+		bench_start_writers(conns);
+		while (bench.writers > 0)
+			fiber_sleep(0.01);
+		bench_drain(conns);
+		printf("prefill: %llu keys in %.2f s\n",
+		       (unsigned long long) opts.keys,
+		       clock_monotonic() - start);
+		bench.is_prefill = false;
+		bench_reset_stat();
+	}
+
+	double start = clock_monotonic();
+	bench_start_writers(conns);
+	uint64_t last_requests = 0;
+	for (int sec = 1; sec <= ceil(opts.duration) && !bench.stop; sec++) {
+		fiber_sleep(MIN(1.0, opts.duration - (sec - 1)));
+		printf("%d s: %llu rps\n", sec,
+		       (unsigned long long) (bench.requests - last_requests));
+		fflush(stdout);
+		last_requests = bench.requests;
+	}
+	bench.stop = true;
+	for (int i = 0; i < opts.connections; i++) {
+		if (conns[i].writer_is_waiting)
+			fiber_wakeup(conns[i].writer);
+	}
+	bench_drain(conns);
+	bench_report(clock_monotonic() - start);
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+static int
+bench_parse_mix(const char *str)
+{
+	int mix[BENCH_OP_MAX] = { 0 };
+	char *copy = strdup(str);
+	char *save = NULL;
+	for (char *tok = strtok_r(copy, ",", &save); tok != NULL;
+	     tok = strtok_r(NULL, ",", &save)) {
+		char *eq = strchr(tok, '=');
+		if (eq == NULL)
+			goto error;
+		*eq = '\0';
+		int op;
+		for (op = 0; op < BENCH_OP_MAX; op++) {
+			if (strcmp(tok, bench_op_strs[op]) == 0)
+				break;
+		}
+		if (op == BENCH_OP_MAX || (mix[op] = atoi(eq + 1)) < 0)
+			goto error;
+	}
+	free(copy);
+	memcpy(opts.mix, mix, sizeof(mix));
+	return 0;
+error:
+	free(copy);
+	return -1;
+}
+
+static void
+bench_usage(const char *prog)
+{
+	printf("Usage: %s [options] [uri]\n"
+	       "  -c, --connections N   number of connections (%d)\n"
+	       "  -p, --pipeline N      requests in flight per connection (%d)\n"
+	       "  -d, --duration SEC    test duration (%g)\n"
+	       "  -k, --keys N          number of distinct keys (%llu)\n"
+	       "  -z, --zipf THETA      zipfian skew in [0, 1), 0 is uniform\n"
+	       "  -s, --space ID        space id (%u)\n"
+	       "  -m, --mix MIX         operation weights, e.g.\n"
+	       "                        select=80,replace=10,update=10,call=0\n"
+	       "  -f, --function NAME   function for CALL (%s)\n"
+	       "  -v, --value-size N    size of the string field (%d)\n"
+	       "  -P, --prefill         replace all keys before the test\n"
+	       "The uri defaults to %s. The space is expected to have\n"
+	       "an unsigned primary key in the first field.\n",
+	       prog, opts.connections, opts.pipeline, opts.duration,
+	       (unsigned long long) opts.keys, opts.space_id,
+	       opts.function, opts.value_size, opts.uri);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option longopts[] = {
+		{"connections", required_argument, 0, 'c'},
+		{"pipeline", required_argument, 0, 'p'},
+		{"duration", required_argument, 0, 'd'},
+		{"keys", required_argument, 0, 'k'},
+		{"zipf", required_argument, 0, 'z'},
+		{"space", required_argument, 0, 's'},
+		{"mix", required_argument, 0, 'm'},
+		{"function", required_argument, 0, 'f'},
+		{"value-size", required_argument, 0, 'v'},
+		{"prefill", no_argument, 0, 'P'},
+		{"help", no_argument, 0, 'h'},
+		{NULL, 0, 0, 0}
+	};
+	int ch;
+	while ((ch = getopt_long(argc, argv, "c:p:d:k:z:s:m:f:v:Ph",
+				 longopts, NULL)) != -1) {
+		switch (ch) {
+		case 'c': opts.connections = atoi(optarg); break;
+		case 'p': opts.pipeline = atoi(optarg); break;
+		case 'd': opts.duration = atof(optarg); break;
+		case 'k': opts.keys = strtoull(optarg, NULL, 10); break;
+		case 'z': opts.zipf_theta = atof(optarg); break;
+		case 's': opts.space_id = atoi(optarg); break;
+		case 'f': opts.function = optarg; break;
+		case 'v': opts.value_size = atoi(optarg); break;
+		case 'P': opts.prefill = true; break;
+		case 'm':
+			if (bench_parse_mix(optarg) != 0) {
+				fprintf(stderr, "invalid mix: %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'h':
+			bench_usage(argv[0]);
+			return 0;
+		default:
+			bench_usage(argv[0]);
+			return 1;
+		}
+	}
+	if (optind < argc)
+		opts.uri = argv[optind];
+
+	for (int op = 0; op < BENCH_OP_MAX; op++)
+		bench.mix_total += opts.mix[op];
+	if (opts.connections <= 0 || opts.pipeline <= 0 ||
+	    opts.duration <= 0 || opts.keys == 0 || opts.value_size < 0 ||
+	    opts.zipf_theta < 0 || opts.zipf_theta >= 1 ||
+	    bench.mix_total == 0) {
+		bench_usage(argv[0]);
+		return 1;
+	}
+	zipf_create(&bench.zipf, opts.keys, opts.zipf_theta);
+	bench.value = (char *) malloc(opts.value_size + 1);
+	memset(bench.value, 'x', opts.value_size);
+
+	/* Geometric buckets from 1 us to 100 s. */
+	int64_t buckets[512];
+	size_t n_buckets = 0;
+	for (int64_t v = 1; v < 100 * 1000000LL && n_buckets < 511;
+	     v = MAX(v + 1, v * 21 / 20))
+		buckets[n_buckets++] = v;
+	buckets[n_buckets++] = 100 * 1000000LL;
+	bench.latency = histogram_new(buckets, n_buckets);
+
+	memory_init();
+	fiber_init(fiber_cxx_invoke);
+	coeio_init();
+	iobuf_init();
+	struct fiber *f = fiber_new_xc("bench", bench_main_f);
+	fiber_wakeup(f);
+	ev_run(loop(), 0);
+	fiber_free();
+	memory_free();
+	histogram_delete(bench.latency);
+	free(bench.value);
+	return 0;
+}
@@ -4,7 +4,7 @@ local tap = require('tap')
 local test = tap.test('cfg')
 local socket = require('socket')
 local fio = require('fio')
-test:plan(43)
+test:plan(44)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -28,6 +28,7 @@ invalid('rows_per_wal', -1)
 invalid('listen', '//!')
 invalid('logger', ':')
 invalid('logger', 'syslog:xxx=')
+invalid('vinyl', {read_ahead = -1})
 
 test:is(type(box.cfg), 'function', 'box is not started')
 
@@ -0,0 +1,41 @@
+remote = require 'net.box'
+
+LISTEN = require('uri').parse(box.cfg.listen)
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+box.schema.user.grant('guest', 'read,write', 'space', 'test')
+
+cn = remote.connect(LISTEN.host, LISTEN.service)
+rs = cn.space.test
+
+-- all tuples are inserted in one request
+rs:insert_batch({{1, 'a'}, {2, 'b'}, {3, 'c'}})
+s:select{}
+
+-- the batch is a transaction: a duplicate rolls back all tuples
+rs:insert_batch({{4, 'd'}, {1, 'x'}})
+s:select{}
+
+rs:replace_batch({{1, 'aa'}, {4, 'd'}})
+s:select{}
+
+rs:insert_batch({})
+rs:insert_batch({{5}, 6})
+s:select{}
+
+-- async requests work as well
+f = rs:replace_batch({{5}, {6}}, {is_async = true})
+f:wait_result()
+s:count()
+
+-- box.stat() counts a batch once and each of its tuples
+stat = box.stat()
+stat.INSERT_BATCH ~= nil and stat.REPLACE_BATCH ~= nil
+rs:insert_batch({{7}, {8}, {9}})
+box.stat.INSERT_BATCH.total - stat.INSERT_BATCH.total
+box.stat.INSERT.total - stat.INSERT.total
+box.stat.REPLACE_BATCH.total - stat.REPLACE_BATCH.total
+
+cn:close()
+box.schema.user.revoke('guest', 'read,write', 'space', 'test')
+s:drop()
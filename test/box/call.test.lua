@@ -239,4 +239,18 @@ conn:call_16("return_sparse4")
 
 require('msgpack').cfg { encode_sparse_safe = sparse_safe }
 
+--
+-- A function from _func must see the current value of a
+-- global on every call.
+--
+_ = box.schema.func.create('cached.func')
+cached = { func = function() return 1 end }
+conn:call('cached.func')
+cached.func = function() return 2 end
+conn:call('cached.func')
+cached = { func = function() return 3 end }
+conn:call('cached.func')
+box.schema.func.drop('cached.func')
+cached = nil
+
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
@@ -14,6 +14,7 @@ box.cfg{sherlock = 'holmes'}
 box.cfg{listen = {}}
 box.cfg{wal_dir = 0}
 box.cfg{coredump = 'true'}
+box.cfg{slab_alloc_numa_nodes = 0}
 
 
 --------------------------------------------------------------------------------
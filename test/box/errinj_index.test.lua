@@ -123,4 +123,17 @@ for i = 5001,5010 do table.insert(res, (s:get{i})) end
 res
 s:drop()
 
+-- a failed RTREE build leaves no half built index behind
+s = box.schema.space.create('spatial')
+_ = s:create_index('primary')
+for i = 1, 1000 do s:insert{i, {i, i}} end
+errinj.set("ERRINJ_INDEX_ALLOC", true)
+s:create_index('spatial', { type = 'rtree', unique = false, parts = {2, 'array'}})
+errinj.set("ERRINJ_INDEX_ALLOC", false)
+s.index.spatial
+_ = s:create_index('spatial', { type = 'rtree', unique = false, parts = {2, 'array'}})
+s.index.spatial:count()
+#s.index.spatial:select({0, 0, 100, 100}, {iterator = 'le'})
+s:drop()
+
 errinj = nil
@@ -94,6 +94,11 @@ box.runtime.info().maxalloc > 0;
 --
 type(require('yaml').encode(box.slab.info()));
 
+-- huge pages and NUMA policy of the arena
+box.slab.pages().huge_pages;
+box.slab.pages().numa_nodes;
+box.slab.pages().resident <= box.slab.info().quota_size;
+
 ----------------
 -- # box.error
 ----------------
@@ -420,6 +420,60 @@ f = fiber.create(function() c:call("") end)
 fiber.sleep(0.1)
 f:cancel(); c:close()
 
+-- is_async: pipeline requests from a single fiber
+_ = box.schema.space.create('test')
+_ = box.space.test:create_index('primary')
+c = net.connect(box.cfg.listen)
+futures = {}
+for i = 1, 10 do futures[i] = c.space.test:insert({i}, {is_async = true}) end
+futures[10]:wait_result()
+futures[1]:is_ready()
+futures[1]:wait_result()
+c.space.test:select({}, {limit = 3, is_async = true}):wait_result()
+c.space.test.index.primary:get(5, {is_async = true}):wait_result()
+c.space.test:insert({1}, {is_async = true}):wait_result()
+c:call_async('scalar42'):wait_result()
+c:eval_async('return ...', 1, 2):wait_result()
+c:close()
+-- is_async: wait for the connection like synchronous requests do
+c = net.connect(box.cfg.listen, {wait_connected = false})
+c:eval_async('return 1'):wait_result()
+-- is_async: respect the deadline set by remote:timeout()
+c:timeout(0.01):eval_async('require("fiber").sleep(10)'):wait_result()
+c:close()
+box.space.test:drop()
+
+-- tuples of select-like responses are decoded straight from
+-- the receive buffer, other responses into Lua tables
+_ = box.schema.space.create('test')
+_ = box.space.test:create_index('primary')
+test_run:cmd("setopt delimiter ';'")
+for i = 1, 200 do
+    box.space.test:insert{i, {a = {i, {b = 'c'}}},
+                          {{}, {i}, {x = {y = {}}}}, {{{}}}}
+end;
+function same(res)
+    local ok = #res == box.space.test:count()
+    for i, t in ipairs(res) do
+        ok = ok and msgpack.encode(t) == msgpack.encode(box.space.test:get{i})
+    end
+    return ok
+end;
+test_run:cmd("setopt delimiter ''");
+c = net.connect(box.cfg.listen)
+res = c.space.test:select()
+box.tuple.is(res[1])
+same(res)
+res = c:call_16('box.space.test:select')
+box.tuple.is(res[1])
+same(res)
+res = c:eval('return box.space.test:select()')
+box.tuple.is(res[1])
+same(res)
+res = nil
+c:close()
+box.space.test:drop()
+
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
 
 -- Tarantool < 1.7.1 compatibility (gh-1533)
@@ -0,0 +1,39 @@
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+h = box.schema.space.create('test_hash')
+_ = h:create_index('pk', {type = 'hash'})
+for i = 1, 5 do s:insert{i} h:insert{i} end
+
+-- a read view is not affected by further changes
+rv = box.read_view({s, 'test_hash'})
+s:delete{1}
+s:replace{2, 'new'}
+s:insert{6}
+s:select{}
+rv:pairs(s):totable()
+t = rv:pairs('test_hash'):totable()
+table.sort(t, function(a, b) return a[1] < b[1] end)
+t
+-- a frozen iterator can't be rewound
+rv:pairs(s)
+-- truncate detaches the space from the view
+rv3 = box.read_view({h})
+h:truncate()
+ok, err = pcall(function() return rv3:pairs(h):totable() end)
+ok, err.code == box.error.READ_VIEW_SPACE_CHANGED
+rv3:close()
+-- a read view and a checkpoint may coexist
+rv2 = box.read_view({s})
+box.snapshot()
+s:delete{2}
+rv2:pairs(s):totable()
+rv2:close()
+rv:close()
+rv:pairs(s)
+rv:close()
+
+box.read_view({'no_such_space'})
+box.read_view(s.id)
+
+s:drop()
+h:drop()
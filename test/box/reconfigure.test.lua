@@ -24,6 +24,16 @@ box.snapshot()
 space:insert{3, 'tuple3'}
 box.snapshot()
 
+-- fork-based snapshot mode
+box.cfg{snapshot_mode='fork'}
+box.cfg.snapshot_mode
+space:insert{4, 'tuple4'}
+box.snapshot()
+box.cfg{snapshot_mode='nonsense'}
+box.cfg.snapshot_mode
+box.cfg{snapshot_mode='thread'}
+box.snapshot()
+
 -- A test case for https://github.com/tarantool/tarantool/issues/112:
 -- Tarantool crashes with SIGSEGV during reload configuration
 --
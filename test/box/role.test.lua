@@ -372,3 +372,64 @@ box.schema.user.create('test_1266')
 box.schema.user.drop('test_1266')
 box.schema.user.drop('test_1266')
 box.schema.user.drop('test_1266', { if_exists = true})
+
+--
+-- grant and revoke on one object don't change effective
+-- access to other objects
+--
+box.schema.role.create('r1')
+box.schema.role.create('r2')
+box.schema.role.grant('r2', 'r1')
+box.schema.user.create('u1')
+box.schema.user.grant('u1', 'r2')
+s1 = box.schema.space.create('s1')
+_ = s1:create_index('pk')
+s2 = box.schema.space.create('s2')
+_ = s2:create_index('pk')
+s3 = box.schema.space.create('s3')
+_ = s3:create_index('pk')
+env = require('test_run')
+test_run = env.new()
+test_run:cmd("setopt delimiter ';'")
+function check(space)
+    local r = pcall(space.get, space, {1})
+    local w = pcall(space.replace, space, {1})
+    local access = (r and 'r' or '') .. (w and 'w' or '')
+    return access == '' and 'none' or access
+end;
+function access()
+    return box.session.su('u1', function()
+        return {check(s1), check(s2), check(s3)}
+    end)
+end;
+test_run:cmd("setopt delimiter ''");
+box.schema.role.grant('r1', 'read', 'space', 's1')
+box.schema.role.grant('r2', 'write', 'space', 's2')
+box.schema.user.grant('u1', 'read', 'space', 's3')
+access()
+box.schema.role.grant('r1', 'write', 'space', 's1')
+access()
+box.schema.role.grant('r1', 'read', 'space', 's2')
+access()
+box.schema.role.revoke('r1', 'read', 'space', 's2')
+access()
+box.schema.role.revoke('r2', 'write', 'space', 's2')
+access()
+box.schema.user.grant('u1', 'write', 'space', 's3')
+access()
+box.schema.user.revoke('u1', 'read,write', 'space', 's3')
+access()
+-- the same object is still readable through the outer role
+box.schema.role.grant('r2', 'read', 'space', 's1')
+box.schema.role.revoke('r1', 'read', 'space', 's1')
+access()
+box.schema.role.revoke('r1', 'write', 'space', 's1')
+access()
+box.schema.role.revoke('r2', 'read', 'space', 's1')
+access()
+s1:drop()
+s2:drop()
+s3:drop()
+box.schema.user.drop('u1')
+box.schema.role.drop('r2')
+box.schema.role.drop('r1')
@@ -0,0 +1,23 @@
+test_run = require('test_run').new()
+
+--
+-- A snapshot written by a forked process is recovered
+-- after restart.
+--
+box.cfg{snapshot_mode = 'fork'}
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'str'}, unique = false})
+for i = 1, 1000 do s:insert{i, tostring(i % 100)} end
+for i = 1, 1000, 3 do s:delete{i} end
+for i = 2, 1000, 3 do s:update({i}, {{'=', 2, 'updated'}}) end
+box.snapshot()
+-- no rows after the snapshot: the data is loaded from it alone
+test_run:cmd('restart server default')
+s = box.space.test
+s:count()
+s.index.sk:count('updated')
+mismatch = 0
+for i = 1, 1000 do local t = s:get{i} local v = tostring(i % 100) if i % 3 == 1 then v = nil elseif i % 3 == 2 then v = 'updated' end if (t and t[2]) ~= v then mismatch = mismatch + 1 end end
+mismatch
+s:drop()
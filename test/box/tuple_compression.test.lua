@@ -0,0 +1,139 @@
+msgpack = require('msgpack')
+
+-- large tuples are stored compressed
+s = box.schema.space.create('test', {compress_threshold = 100})
+_ = s:create_index('pk')
+big = string.rep('tarantool', 100)
+t = s:insert{1, big, 'tail'}
+t[2] == big
+t[3]
+#t
+t:bsize() == #msgpack.encode({1, big, 'tail'})
+s:get{1}[2] == big
+s:update({1}, {{'=', 3, 'new'}})[3]
+s:insert{2, 'small'}
+s:count()
+box.snapshot()
+s:get{1}:totable()[3]
+
+-- only the indexed fields are stored as is
+_ = s:create_index('sk', {parts = {3, 'string'}})
+_ = s:create_index('sk', {parts = {1, 'unsigned'}})
+_ = box.space._space:update(s.id, {{'=', 6, {compress_threshold = 10}}})
+s:drop()
+
+s = box.schema.space.create('test', {engine = 'vinyl', compress_threshold = 100})
+
+-- compression, dictionary training, the decompressed data cache
+env = require('test_run')
+test_run = env.new()
+fiber = require('fiber')
+fio = require('fio')
+test_run:cmd("setopt delimiter ';'")
+words = {'tarantool', 'space', 'index', 'tuple', 'memtx', 'vinyl',
+         'snapshot', 'replica', 'fiber', 'lua', 'select', 'insert',
+         'update', 'delete', 'upsert', 'primary', 'secondary', 'tree',
+         'hash', 'bitset'};
+function gen(i)
+    local t = {}
+    local x = i
+    for j = 1, 1000 do
+        x = (x * 75 + 74) % 65537
+        t[j] = words[x % #words + 1]
+    end
+    return table.concat(t, ' ')
+end;
+function check(tuples)
+    local bad = 0
+    for _, t in ipairs(tuples) do
+        if t[2] ~= gen(t[1]) or t[3] ~= 'tail' then
+            bad = bad + 1
+        end
+    end
+    return bad
+end;
+function last_file(ext)
+    local files = fio.glob(fio.pathjoin(box.cfg.snap_dir, '*.' .. ext))
+    return fio.basename(files[#files] or '', '.' .. ext)
+end;
+test_run:cmd("setopt delimiter ''");
+s = box.schema.space.create('test', {compress_threshold = 1024})
+_ = s:create_index('pk')
+used = box.slab.info().items_used
+-- enough samples to train a dictionary
+for i = 1, 600 do s:insert{i, gen(i), 'tail'} end
+while test_run:grep_log('default', 'trained a tuple compression dictionary') == nil do fiber.sleep(0.01) end
+-- these are compressed with the dictionary
+for i = 601, 700 do s:insert{i, gen(i), 'tail'} end
+-- tuples are stored compressed
+size = 0
+for i = 1, 700 do size = size + #gen(i) end
+box.slab.info().items_used - used < size / 2
+-- decompressed data of all tuples doesn't fit in the cache
+all = s:select()
+#all
+check(all)
+check(all)
+-- a tuple iterator follows the data decompressed again
+fields = {}
+for _, field in all[1]:pairs() do table.insert(fields, field) check(all) end
+#fields
+fields[2] == gen(1)
+fields[3]
+all = nil
+--
+-- recovery of compressed tuples from a snapshot, from a delta
+-- snapshot and from WAL
+--
+box.cfg{snapshot_delta_count = 2}
+box.snapshot()
+snap = last_file('snap')
+_ = s:delete{1}
+_ = s:replace{2, gen(2), 'new'}
+_ = s:update({3}, {{'=', 3, 'new'}})
+box.begin() s:delete{4} box.rollback()
+_ = s:insert{701, gen(701), 'tail'}
+box.snapshot()
+last_file('snap') == snap
+last_file('delta') > snap
+_ = s:delete{5}
+_ = s:insert{702, gen(702), 'tail'}
+test_run:cmd("restart server default")
+test_run:cmd("setopt delimiter ';'")
+words = {'tarantool', 'space', 'index', 'tuple', 'memtx', 'vinyl',
+         'snapshot', 'replica', 'fiber', 'lua', 'select', 'insert',
+         'update', 'delete', 'upsert', 'primary', 'secondary', 'tree',
+         'hash', 'bitset'};
+function gen(i)
+    local t = {}
+    local x = i
+    for j = 1, 1000 do
+        x = (x * 75 + 74) % 65537
+        t[j] = words[x % #words + 1]
+    end
+    return table.concat(t, ' ')
+end;
+function check(tuples)
+    local bad = 0
+    for _, t in ipairs(tuples) do
+        if t[2] ~= gen(t[1]) or t[3] ~= 'tail' then
+            bad = bad + 1
+        end
+    end
+    return bad
+end;
+test_run:cmd("setopt delimiter ''");
+s = box.space.test
+s:count()
+s:get{1}
+s:get{5}
+s:get{2}[3]
+s:get{3}[3]
+check(s:select({5}, {iterator = 'GT'}))
+s:get{2}[2] == gen(2) and s:get{3}[2] == gen(3)
+check({s:get{4}})
+-- the tuples are compressed again on recovery
+size = 0
+for _, t in s:pairs() do size = size + t:bsize() end
+box.slab.info().items_used < size / 2
+s:drop()
@@ -0,0 +1,14 @@
+#!/usr/bin/env tarantool
+
+require('console').listen(os.getenv('ADMIN'))
+box.cfg({
+    listen              = os.getenv("MASTER"),
+    slab_alloc_arena    = 0.1,
+    custom_proc_title   = "hot_standby",
+    wal_dir             = "master",
+    snap_dir            = "master",
+    vinyl_dir           = "master",
+    hot_standby         = true,
+    -- a wakeup must come from fs events, not from a rescan
+    wal_dir_rescan_delay = 100,
+})
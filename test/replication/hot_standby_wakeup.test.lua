@@ -0,0 +1,50 @@
+--
+-- A hot standby is woken up by fs events when the master
+-- appends to the WAL or starts a new one, it doesn't wait
+-- for the next WAL dir rescan.
+--
+env = require('test_run')
+test_run = env.new()
+test_run:cmd("create server hot_standby with script='replication/hot_standby_wakeup.lua', rpl_master=default")
+test_run:cmd("start server hot_standby")
+test_run:cmd("switch hot_standby")
+fiber = require('fiber')
+test_run:cmd("setopt delimiter ';'")
+function wait_row(key)
+    local deadline = fiber.time() + 10
+    while box.space.test == nil or box.space.test:get{key} == nil do
+        if fiber.time() > deadline then
+            return false
+        end
+        fiber.sleep(0.01)
+    end
+    return true
+end;
+test_run:cmd("setopt delimiter ''");
+box.info.status
+test_run:cmd("switch default")
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+-- append to the current WAL
+_ = s:insert{1}
+test_run:cmd("switch hot_standby")
+wait_row(1)
+test_run:cmd("switch default")
+_ = s:insert{2}
+test_run:cmd("switch hot_standby")
+wait_row(2)
+-- start a new WAL
+test_run:cmd("switch default")
+box.snapshot()
+_ = s:insert{3}
+test_run:cmd("switch hot_standby")
+wait_row(3)
+test_run:cmd("switch default")
+_ = s:insert{4}
+test_run:cmd("switch hot_standby")
+wait_row(4)
+box.info.status
+test_run:cmd("switch default")
+s:drop()
+test_run:cmd("stop server hot_standby")
+test_run:cmd("cleanup server hot_standby")
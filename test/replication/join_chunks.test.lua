@@ -0,0 +1,47 @@
+env = require('test_run')
+test_run = env.new()
+net_box = require('net.box')
+fiber = require('fiber')
+
+box.schema.user.grant('guest', 'read,write,execute', 'universe')
+box.schema.user.grant('guest', 'replication')
+
+--
+-- The initial join sends the snapshot txs as they are stored in
+-- the .snap file, packed into IPROTO_XLOG_TX chunks of about
+-- 1 MB. Put ~3 MB into the snapshot, so that the replica gets
+-- several chunks.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+pad = string.rep('x', 1000)
+for i = 1, 3000 do s:insert{i, pad .. i} end
+box.snapshot()
+-- rows written after the snapshot are sent one by one
+for i = 3001, 3100 do s:insert{i, pad .. i} end
+
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:cmd("switch replica")
+fiber = require('fiber')
+while box.space.test:count() < 3100 do fiber.sleep(0.01) end
+box.info.replication[1].status
+test_run:cmd("switch default")
+
+-- the replica has exactly the master data
+test_run:cmd("set variable r_uri to 'replica.listen'")
+c = net_box.connect(r_uri)
+remote = c.space.test:select{}
+#remote
+mismatch = 0
+for i, t in s:pairs() do if remote[i] == nil or remote[i][1] ~= t[1] or remote[i][2] ~= t[2] then mismatch = mismatch + 1 end end
+mismatch
+c:close()
+remote = nil
+
+-- cleanup
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s:drop()
+box.schema.user.revoke('guest', 'replication')
+box.schema.user.revoke('guest', 'read,write,execute', 'universe')
@@ -1,8 +1,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <limits.h>
 
 #include <bitset/bitset.h>
+#include <bitset/page.h>
 
 #include "unit.h"
 
@@ -198,12 +200,61 @@ void test_get_set()
 	footer();
 }
 
+static
+void test_sparse_pages()
+{
+	header();
+
+	struct bitset bm;
+	bitset_create(&bm, realloc);
+
+	struct bitset_info info;
+	const size_t bits_per_page = BITSET_PAGE_DATA_SIZE * CHAR_BIT;
+	const size_t first = 3 * bits_per_page;
+
+	/* A few bits stay in a sparse page */
+	for (size_t i = 0; i < BITSET_PAGE_ARRAY_SIZE; i++)
+		fail_if(bitset_set(&bm, first + i * 7) < 0);
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 1);
+	fail_unless(info.array_pages == 1);
+
+	/* One more bit turns the page into a bitmap */
+	fail_if(bitset_set(&bm, first + bits_per_page - 1) < 0);
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 1);
+	fail_unless(info.array_pages == 0);
+	fail_unless(bitset_cardinality(&bm) == BITSET_PAGE_ARRAY_SIZE + 1);
+
+	for (size_t i = 0; i < BITSET_PAGE_ARRAY_SIZE; i++)
+		fail_unless(bitset_test(&bm, first + i * 7));
+	fail_unless(bitset_test(&bm, first + bits_per_page - 1));
+	fail_if(bitset_test(&bm, first + 1));
+
+	/* Clearing most of the bits makes the page sparse again */
+	for (size_t i = 0; i < BITSET_PAGE_ARRAY_SIZE; i += 2)
+		fail_if(bitset_clear(&bm, first + i * 7) < 0);
+	fail_if(bitset_clear(&bm, first + bits_per_page - 1) < 0);
+	bitset_info(&bm, &info);
+	fail_unless(info.pages == 1);
+	fail_unless(info.array_pages == 1);
+	fail_unless(bitset_cardinality(&bm) == BITSET_PAGE_ARRAY_SIZE / 2);
+
+	for (size_t i = 0; i < BITSET_PAGE_ARRAY_SIZE; i++)
+		fail_unless(bitset_test(&bm, first + i * 7) == (i % 2 != 0));
+
+	bitset_destroy(&bm);
+
+	footer();
+}
+
 int main(int argc, char *argv[])
 {
 	setbuf(stdout, NULL);
 	srand(time(NULL));
 	test_cardinality();
 	test_get_set();
+	test_sparse_pages();
 
 	return 0;
 }
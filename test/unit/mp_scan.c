@@ -0,0 +1,126 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <msgpuck.h>
+
+#include "mp_scan.h"
+#include "unit.h"
+
+enum { PAGE_SIZE = 4096, VALUE_MAX = 256 };
+
+static char *page;
+
+/** Encode a random value, mostly single-byte ones. */
+static char *
+encode_random(char *data, bool single_byte_only)
+{
+	switch (rand() % (single_byte_only ? 4 : 8)) {
+	case 0:
+		return mp_encode_uint(data, rand() % 128);
+	case 1:
+		return mp_encode_int(data, -1 - rand() % 32);
+	case 2:
+		return mp_encode_nil(data);
+	case 3:
+		return mp_encode_bool(data, rand() % 2);
+	case 4:
+		return mp_encode_uint(data, rand());
+	case 5:
+		return mp_encode_str(data, "abcdefgh", rand() % 8);
+	case 6:
+		return mp_encode_double(data, 1.5);
+	default:
+		data = mp_encode_array(data, 2);
+		data = mp_encode_uint(data, 1);
+		return mp_encode_str(data, "\xc0\xc2\xc3", 3);
+	}
+}
+
+/**
+ * Encode count random values so that they end right before an
+ * unmapped page, and compare mp_skip() with mp_next() for
+ * every prefix.
+ */
+static bool
+check_random(uint32_t count, bool single_byte_only)
+{
+	char buf[PAGE_SIZE];
+	char *end = buf;
+	for (uint32_t i = 0; i < count; i++)
+		end = encode_random(end, single_byte_only);
+	size_t size = end - buf;
+	char *data = page + PAGE_SIZE - size;
+	memcpy(data, buf, size);
+	const char *expected = data;
+	for (uint32_t i = 0; i <= count; i++) {
+		if (mp_skip(data, i) != expected)
+			return false;
+		if (i < count)
+			mp_next(&expected);
+	}
+	return expected == page + PAGE_SIZE;
+}
+
+static void
+check_skip(void)
+{
+	bool single = true, mixed = true, sizes = true;
+	for (int i = 0; i < 1000; i++) {
+		single = single && check_random(rand() % VALUE_MAX, true);
+		mixed = mixed && check_random(rand() % VALUE_MAX, false);
+		sizes = sizes && check_random(i % 70, i % 2);
+	}
+	ok(single, "single-byte values");
+	ok(mixed, "mixed values");
+	ok(sizes, "short sequences");
+}
+
+int
+main()
+{
+	plan(6);
+	/* The page after the data is inaccessible. */
+	page = mmap(NULL, 2 * PAGE_SIZE, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	fail_if(page == MAP_FAILED);
+	fail_if(mprotect(page + PAGE_SIZE, PAGE_SIZE, PROT_NONE) != 0);
+
+	note("default");
+	check_skip();
+	mp_scan_init();
+	note("best available");
+	check_skip();
+
+	munmap(page, 2 * PAGE_SIZE);
+	return check_plan();
+}
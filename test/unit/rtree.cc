@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <string.h>
 
 #include "unit.h"
 #include "salad/rtree.h"
@@ -260,12 +261,190 @@ neighbor_test()
 	footer();
 }
 
+static int
+neighbor_distance_cmp(const void *a, const void *b)
+{
+	sq_coord_t da = *(const sq_coord_t *)a;
+	sq_coord_t db = *(const sq_coord_t *)b;
+	return da < db ? -1 : da > db;
+}
+
+/*
+ * Squared euclid or manhattan distance from the point (x, y)
+ * to the rectangle, the same as the tree computes it.
+ */
+static sq_coord_t
+neighbor_distance(const struct rtree_rect *rect, coord_t x, coord_t y,
+		  enum rtree_distance_type type)
+{
+	coord_t p[2] = {x, y};
+	sq_coord_t result = 0;
+	for (int i = 0; i < 2; i++) {
+		coord_t d = 0;
+		if (p[i] < rect->coords[2 * i])
+			d = rect->coords[2 * i] - p[i];
+		else if (p[i] > rect->coords[2 * i + 1])
+			d = p[i] - rect->coords[2 * i + 1];
+		result += type == RTREE_EUCLID ? d * d : d;
+	}
+	return result;
+}
+
+/*
+ * Check that full neighbor iteration returns every record
+ * once, in order of distance, by comparing it with distances
+ * sorted by brute force. Coordinates are taken from a small
+ * grid, so that many records are equidistant from the point.
+ */
+static void
+neighbor_order_test()
+{
+	header();
+
+	const unsigned count = 2000;
+	const unsigned rounds = 50;
+	struct rtree_rect *arr = (struct rtree_rect *)
+		calloc(count, sizeof(*arr));
+	sq_coord_t *expected = (sq_coord_t *)
+		calloc(count, sizeof(*expected));
+	bool *found = (bool *)calloc(count, sizeof(*found));
+	const enum rtree_distance_type types[] = {
+		RTREE_EUCLID, RTREE_MANHATTAN
+	};
+	srand(0);
+	for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+		struct rtree tree;
+		rtree_init(&tree, 2, extent_size,
+			   extent_alloc, extent_free, &page_count, types[t]);
+		for (size_t i = 0; i < count; i++) {
+			coord_t x = rand() % 50, y = rand() % 50;
+			if (rand() % 4 == 0)
+				rtree_set2d(&arr[i], x, y, x + rand() % 5,
+					    y + rand() % 5);
+			else
+				rtree_set2dp(&arr[i], x, y);
+			rtree_insert(&tree, &arr[i], (record_t)(i + 1));
+		}
+		/* Make the tree less regular */
+		for (size_t i = 0; i < count; i += 3) {
+			if (!rtree_remove(&tree, &arr[i], (record_t)(i + 1)))
+				fail("delete element in tree", "false");
+			rtree_insert(&tree, &arr[i], (record_t)(i + 1));
+		}
+
+		struct rtree_iterator iterator;
+		rtree_iterator_init(&iterator);
+		for (size_t r = 0; r < rounds; r++) {
+			coord_t x = rand() % 60 - 5, y = rand() % 60 - 5;
+			for (size_t i = 0; i < count; i++)
+				expected[i] = neighbor_distance(&arr[i], x, y,
+								types[t]);
+			qsort(expected, count, sizeof(*expected),
+			      neighbor_distance_cmp);
+			memset(found, 0, count * sizeof(*found));
+
+			struct rtree_rect point;
+			rtree_set2dp(&point, x, y);
+			if (!rtree_search(&tree, &point, SOP_NEIGHBOR,
+					  &iterator))
+				fail("search is successful", "false");
+			size_t n = 0;
+			record_t rec;
+			while ((rec = rtree_iterator_next(&iterator)) != NULL) {
+				size_t i = (uintptr_t)rec - 1;
+				if (n >= count || found[i])
+					fail("record is returned once", "false");
+				found[i] = true;
+				sq_coord_t d = neighbor_distance(&arr[i], x, y,
+								 types[t]);
+				if (d != expected[n])
+					fail("records are ordered by distance",
+					     "false");
+				n++;
+			}
+			if (iterator.is_oom)
+				fail("no memory error", "false");
+			if (n != count)
+				fail("all records are returned", "false");
+		}
+		rtree_iterator_destroy(&iterator);
+		rtree_destroy(&tree);
+	}
+	free(found);
+	free(expected);
+	free(arr);
+
+	footer();
+}
+
+static void
+bulk_load_test()
+{
+	header();
+
+	const unsigned counts[] = {0, 1, 17, 18, 19, 100, 1000, 12345};
+	for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+		const unsigned count = counts[k];
+		struct rtree tree;
+		rtree_init(&tree, 2, extent_size,
+			   extent_alloc, extent_free, &page_count,
+			   RTREE_EUCLID);
+
+		struct rtree_rect rect;
+		for (size_t i = 1; i <= count; i++) {
+			/* A pseudo-random grid of points */
+			size_t x = i * 7919 % 317;
+			size_t y = i * 104729 % 331;
+			rtree_set2dp(&rect, x, y + i * 1000);
+			if (rtree_bulk_add(&tree, &rect, (record_t)i) != 0)
+				fail("bulk add", "true");
+		}
+		rtree_bulk_load(&tree);
+		if (rtree_number_of_records(&tree) != count)
+			fail("Tree count mismatch", "true");
+
+		struct rtree_iterator iterator;
+		rtree_iterator_init(&iterator);
+		for (size_t i = 1; i <= count; i++) {
+			size_t x = i * 7919 % 317;
+			size_t y = i * 104729 % 331;
+			rtree_set2dp(&rect, x, y + i * 1000);
+			if (!rtree_search(&tree, &rect, SOP_EQUALS, &iterator))
+				fail("element in tree", "false");
+			if (rtree_iterator_next(&iterator) != (record_t)i)
+				fail("right search result", "true");
+			if (rtree_iterator_next(&iterator) != NULL)
+				fail("single search result", "true");
+		}
+
+		/* The tree must stay valid for further modifications */
+		rtree_set2dp(&rect, 0.5, 0.5);
+		rtree_insert(&tree, &rect, (record_t)(count + 1));
+		if (!rtree_remove(&tree, &rect, (record_t)(count + 1)))
+			fail("delete inserted element", "false");
+		for (size_t i = 1; i <= count; i++) {
+			size_t x = i * 7919 % 317;
+			size_t y = i * 104729 % 331;
+			rtree_set2dp(&rect, x, y + i * 1000);
+			if (!rtree_remove(&tree, &rect, (record_t)i))
+				fail("delete element in tree", "false");
+		}
+		if (rtree_number_of_records(&tree) != 0)
+			fail("Tree count mismatch", "true");
+		rtree_iterator_destroy(&iterator);
+		rtree_destroy(&tree);
+	}
+
+	footer();
+}
 
 int
 main(void)
 {
 	simple_check();
 	neighbor_test();
+	neighbor_order_test();
+	bulk_load_test();
 	if (page_count != 0) {
 		fail("memory leak!", "true");
 	}
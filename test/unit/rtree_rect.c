@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "unit.h"
+/*
+ * The rectangle methods are static, so the test is compiled
+ * with the R-tree implementation itself.
+ */
+#include "salad/rtree.c"
+
+enum { ROUNDS = 100000 };
+
+/*
+ * Coordinates are picked from a small domain, so that bounds
+ * are often equal and some rectangles are points. NaN checks
+ * that the specialized comparators treat it like the generic
+ * ones do.
+ */
+static coord_t
+rand_coord(void)
+{
+	if (rand() % 100 == 0)
+		return NAN;
+	return rand() % 4;
+}
+
+static void
+rand_rect(struct rtree_rect *rect, unsigned dimension)
+{
+	for (unsigned i = 0; i < dimension; i++) {
+		coord_t a = rand_coord(), b = rand_coord();
+		rect->coords[2 * i] = a < b ? a : b;
+		rect->coords[2 * i + 1] = a < b ? b : a;
+	}
+}
+
+static bool
+distance_equal(sq_coord_t a, sq_coord_t b)
+{
+	return a == b || (isnan(a) && isnan(b));
+}
+
+/**
+ * Compare the methods specialized for the dimension with the
+ * generic ones on random pairs of rectangles.
+ * @retval the number of mismatches
+ */
+static int
+check_rect_ops(unsigned dimension)
+{
+	const struct rtree_rect_ops *ops = rtree_rect_ops_get(dimension);
+	const struct rtree_rect_ops *any = &rtree_rect_ops_any;
+	int errors = 0;
+	for (int i = 0; i < ROUNDS; i++) {
+		struct rtree_rect r1, r2;
+		rand_rect(&r1, dimension);
+		rand_rect(&r2, dimension);
+		if (rand() % 4 == 0)
+			r2 = r1;
+		unsigned d = dimension;
+		errors += ops->intersects_rect(&r1, &r2, d) !=
+			  any->intersects_rect(&r1, &r2, d);
+		errors += ops->in_rect(&r1, &r2, d) !=
+			  any->in_rect(&r1, &r2, d);
+		errors += ops->strict_in_rect(&r1, &r2, d) !=
+			  any->strict_in_rect(&r1, &r2, d);
+		errors += ops->holds_rect(&r1, &r2, d) !=
+			  any->holds_rect(&r1, &r2, d);
+		errors += ops->strict_holds_rect(&r1, &r2, d) !=
+			  any->strict_holds_rect(&r1, &r2, d);
+		errors += ops->equal_to_rect(&r1, &r2, d) !=
+			  any->equal_to_rect(&r1, &r2, d);
+		errors += !distance_equal(ops->neigh_distance(&r1, &r2, d),
+					  any->neigh_distance(&r1, &r2, d));
+		errors += !distance_equal(ops->neigh_distance2(&r1, &r2, d),
+					  any->neigh_distance2(&r1, &r2, d));
+	}
+	return errors;
+}
+
+int
+main(void)
+{
+	srand(1);
+	plan(6);
+	for (unsigned d = 2; d <= 4; d++) {
+		ok(rtree_rect_ops_get(d) != &rtree_rect_ops_any,
+		   "%u dimensions are specialized", d);
+		is(check_rect_ops(d), 0,
+		   "%u dimensional methods match the generic ones", d);
+	}
+	return check_plan();
+}
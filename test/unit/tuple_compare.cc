@@ -0,0 +1,291 @@
+/*
+ * Copyright 2010-2016, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+extern "C" {
+#include "unit.h"
+} /* extern "C" */
+#include <stdlib.h>
+#include <string.h>
+#include <msgpuck.h>
+
+#include "trivia/util.h"
+#include "box/key_def.h"
+#include "box/tuple.h"
+#include "box/tuple_format.h"
+#include "box/tuple_compare.h"
+
+/*
+ * Check the specialized comparators against tuple_compare_default()
+ * and tuple_compare_with_key_default() on every key definition
+ * they may be picked for.
+ *
+ * The test is linked without tuple_format.cc: all tuples share a
+ * single format without indexed fields, so both the specialized
+ * and the default comparators find fields by skipping MessagePack.
+ */
+struct tuple_format **tuple_formats;
+
+enum {
+	TUPLE_COUNT = 48,
+	TUPLE_FIELD_COUNT = 4,
+	TUPLE_SIZE_MAX = 256,
+};
+
+static const enum field_type test_types[] = {
+	FIELD_TYPE_UNSIGNED,
+	FIELD_TYPE_STRING,
+	FIELD_TYPE_INTEGER,
+	FIELD_TYPE_NUMBER,
+	FIELD_TYPE_SCALAR,
+};
+
+static const uint32_t test_type_count =
+	sizeof(test_types) / sizeof(test_types[0]);
+
+static struct tuple_format *format;
+
+/*
+ * Values are picked from a small domain, so that the keys often
+ * have equal prefixes and the comparators have to look at the
+ * following parts.
+ */
+static char *
+encode_field(char *data, enum field_type type)
+{
+	static const char *strs[] = { "", "a", "ab", "b" };
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+		return mp_encode_uint(data, rand() % 3);
+	case FIELD_TYPE_STRING: {
+		const char *str = strs[rand() % 4];
+		return mp_encode_str(data, str, strlen(str));
+	}
+	case FIELD_TYPE_INTEGER:
+		if (rand() % 2)
+			return mp_encode_int(data, -1 - rand() % 2);
+		return mp_encode_uint(data, rand() % 2);
+	case FIELD_TYPE_NUMBER:
+		switch (rand() % 3) {
+		case 0:
+			return mp_encode_int(data, -1);
+		case 1:
+			return mp_encode_uint(data, rand() % 2);
+		default:
+			return mp_encode_double(data, (rand() % 5 - 2) / 2.0);
+		}
+	case FIELD_TYPE_SCALAR:
+		switch (rand() % 5) {
+		case 0:
+			return mp_encode_bool(data, rand() % 2);
+		case 1:
+			return mp_encode_uint(data, rand() % 2);
+		case 2:
+			return mp_encode_double(data, 0.5);
+		case 3: {
+			const char *str = strs[rand() % 4];
+			return mp_encode_str(data, str, strlen(str));
+		}
+		default:
+			return mp_encode_bin(data, "a", rand() % 2);
+		}
+	default:
+		unreachable();
+	}
+	return data;
+}
+
+static struct tuple *
+test_tuple_new(const enum field_type *types)
+{
+	char data[TUPLE_SIZE_MAX];
+	char *end = mp_encode_array(data, TUPLE_FIELD_COUNT);
+	for (uint32_t i = 0; i < TUPLE_FIELD_COUNT; i++)
+		end = encode_field(end, types[i]);
+	size_t size = end - data;
+	struct tuple *tuple = (struct tuple *)
+		calloc(1, sizeof(struct tuple) + size);
+	fail_if(tuple == NULL);
+	tuple->format_id = format->id;
+	tuple->size = size;
+	memcpy(tuple->raw, data, size);
+	return tuple;
+}
+
+static struct key_def *
+test_key_def_new(uint32_t part_count)
+{
+	struct key_def *def = (struct key_def *)
+		calloc(1, sizeof(*def) + part_count * sizeof(def->parts[0]));
+	fail_if(def == NULL);
+	def->type = TREE;
+	def->part_count = part_count;
+	return def;
+}
+
+static inline int
+sign(int r)
+{
+	return r < 0 ? -1 : r > 0;
+}
+
+/** Number of key definitions which got a specialized comparator. */
+static int specialized_count;
+static int specialized_with_key_count;
+
+/**
+ * Compare all pairs of tuples and all tuple/key prefix pairs
+ * with the comparators picked for the key definition and with
+ * the default ones.
+ * @retval the number of mismatches
+ */
+static int
+check_key_def(struct key_def *def)
+{
+	enum field_type types[TUPLE_FIELD_COUNT];
+	for (uint32_t i = 0; i < TUPLE_FIELD_COUNT; i++)
+		types[i] = FIELD_TYPE_UNSIGNED;
+	for (uint32_t i = 0; i < def->part_count; i++)
+		types[def->parts[i].fieldno] = def->parts[i].type;
+
+	struct tuple *tuples[TUPLE_COUNT];
+	for (int i = 0; i < TUPLE_COUNT; i++)
+		tuples[i] = test_tuple_new(types);
+
+	tuple_compare_t cmp = tuple_compare_create(def);
+	tuple_compare_with_key_t cmp_wk = tuple_compare_with_key_create(def);
+	if (cmp != tuple_compare_default)
+		specialized_count++;
+	if (cmp_wk != tuple_compare_with_key_default)
+		specialized_with_key_count++;
+
+	int errors = 0;
+	char key[TUPLE_SIZE_MAX];
+	for (int i = 0; i < TUPLE_COUNT; i++) {
+		/* The key is the parts of tuple i, in key order. */
+		char *key_end = key;
+		for (uint32_t k = 0; k < def->part_count; k++) {
+			const char *field =
+				tuple_field_raw(format,
+						tuple_key_data(tuples[i]),
+						tuple_field_map(tuples[i]),
+						def->parts[k].fieldno);
+			const char *field_end = field;
+			mp_next(&field_end);
+			memcpy(key_end, field, field_end - field);
+			key_end += field_end - field;
+		}
+		for (int j = 0; j < TUPLE_COUNT; j++) {
+			if (sign(cmp(tuples[i], tuples[j], def)) !=
+			    sign(tuple_compare_default(tuples[i], tuples[j],
+						       def)))
+				errors++;
+			for (uint32_t k = 0; k <= def->part_count; k++) {
+				if (sign(cmp_wk(tuples[j], key, k, def)) !=
+				    sign(tuple_compare_with_key_default(
+						tuples[j], key, k, def)))
+					errors++;
+			}
+		}
+	}
+	for (int i = 0; i < TUPLE_COUNT; i++)
+		free(tuples[i]);
+	return errors;
+}
+
+/**
+ * Check all keys with part_count parts on consecutive fields
+ * starting from the first one, for all combinations of types.
+ */
+static int
+check_sequential_keys(uint32_t part_count)
+{
+	struct key_def *def = test_key_def_new(part_count);
+	uint32_t combination_count = 1;
+	for (uint32_t i = 0; i < part_count; i++)
+		combination_count *= test_type_count;
+	int errors = 0;
+	for (uint32_t c = 0; c < combination_count; c++) {
+		uint32_t n = c;
+		for (uint32_t i = 0; i < part_count; i++) {
+			def->parts[i].fieldno = i;
+			def->parts[i].type = test_types[n % test_type_count];
+			n /= test_type_count;
+		}
+		errors += check_key_def(def);
+	}
+	free(def);
+	return errors;
+}
+
+/**
+ * Check keys on the second field followed by the first one,
+ * as built by key_def_merge() for secondary indexes.
+ */
+static int
+check_merged_keys()
+{
+	struct key_def *def = test_key_def_new(2);
+	int errors = 0;
+	for (uint32_t i = 0; i < test_type_count; i++) {
+		for (uint32_t j = 0; j < test_type_count; j++) {
+			def->parts[0].fieldno = 1;
+			def->parts[0].type = test_types[i];
+			def->parts[1].fieldno = 0;
+			def->parts[1].type = test_types[j];
+			errors += check_key_def(def);
+		}
+	}
+	free(def);
+	return errors;
+}
+
+int
+main(void)
+{
+	srand(1);
+	format = (struct tuple_format *) calloc(1, sizeof(*format));
+	fail_if(format == NULL);
+	tuple_formats = &format;
+
+	plan(7);
+	for (uint32_t part_count = 1; part_count <= TUPLE_FIELD_COUNT;
+	     part_count++) {
+		is(check_sequential_keys(part_count), 0,
+		   "%u part keys match the default comparators", part_count);
+	}
+	is(check_merged_keys(), 0,
+	   "merged keys match the default comparators");
+	ok(specialized_count > 0, "specialized comparators are used");
+	ok(specialized_with_key_count > 0,
+	   "specialized comparators with key are used");
+
+	free(format);
+	return check_plan();
+}
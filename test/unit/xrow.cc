@@ -32,6 +32,8 @@ extern "C" {
 #include "unit.h"
 } /* extern "C" */
 #include "trivia/util.h"
+#include "memory.h"
+#include "fiber.h"
 #include "box/xrow.h"
 #include "box/iproto_constants.h"
 #include "tt_uuid.h"
@@ -180,16 +182,48 @@ test_greeting()
 	return check_plan();
 }
 
+int
+test_join()
+{
+	plan(6);
+
+	struct tt_uuid uuid, decoded;
+	tt_uuid_create(&uuid);
+	struct xrow_header row;
+	bool xlog_tx_chunks;
+
+	xrow_encode_join(&row, &uuid, true);
+	is(row.type, IPROTO_JOIN, "join.type");
+	xrow_decode_join(&row, &decoded, &xlog_tx_chunks);
+	ok(tt_uuid_is_equal(&decoded, &uuid), "join.uuid");
+	ok(xlog_tx_chunks, "join.xlog_tx_chunks");
+
+	/* A request from an older replica */
+	xrow_encode_join(&row, &uuid, false);
+	is(row.type, IPROTO_JOIN, "legacy join.type");
+	xrow_decode_join(&row, &decoded, &xlog_tx_chunks);
+	ok(tt_uuid_is_equal(&decoded, &uuid), "legacy join.uuid");
+	ok(!xlog_tx_chunks, "legacy join.xlog_tx_chunks");
+
+	fiber_gc();
+	return check_plan();
+}
+
 int
 main(void)
 {
-	plan(1);
+	memory_init();
+	fiber_init(fiber_cxx_invoke);
+	plan(2);
 
 	random_init();
 
 	test_greeting();
+	test_join();
 
 	random_free();
+	fiber_free();
+	memory_free();
 
 	return check_plan();
 }
@@ -94,3 +94,59 @@ errinj.set("ERRINJ_VY_READ_PAGE", false);
 s:select()
 s:drop()
 
+
+--
+-- The run is compacted or dropped while the pages following
+-- the current one are being read ahead.
+--
+s = box.schema.space.create('test', {engine='vinyl'})
+_ = s:create_index('pk', {page_size = 256, compact_wm = 2})
+pad = string.rep('x', 64)
+for i = 1, 200 do s:replace{i, pad} end
+box.snapshot()
+function vyinfo() return box.info.vinyl().db[s.id..'/0'] end
+vyinfo().page_count > 20
+
+test_run:cmd("setopt delimiter ';'")
+function scan()
+    local status, res = pcall(s.select, s)
+    if not status then
+        scan_result = res
+        return
+    end
+    scan_result = #res
+    for i, t in ipairs(res) do
+        if t[1] ~= i then
+            scan_result = false
+        end
+    end
+end;
+test_run:cmd("setopt delimiter ''");
+
+errinj.set("ERRINJ_VY_READ_PAGE_TIMEOUT", true)
+scan_result = nil
+f1 = fiber.create(scan)
+-- the scan is sequential, the following pages are read ahead
+fiber.sleep(0.2)
+errinj.set("ERRINJ_VY_READ_PAGE_TIMEOUT", false)
+for i = 1, 200, 2 do s:replace{i, pad, i} end
+box.snapshot()
+while vyinfo().run_count > 1 do fiber.sleep(0.1) end
+while f1:status() ~= 'dead' do fiber.sleep(0.01) end
+scan_result
+#s:select()
+
+errinj.set("ERRINJ_VY_READ_PAGE_TIMEOUT", true)
+scan_result = nil
+f1 = fiber.create(scan)
+fiber.sleep(0.2)
+s:drop()
+errinj.set("ERRINJ_VY_READ_PAGE_TIMEOUT", false)
+while f1:status() ~= 'dead' do fiber.sleep(0.01) end
+-- the tasks given up are done
+fiber.sleep(0.2)
+s = box.schema.space.create('test', {engine='vinyl'})
+_ = s:create_index('pk')
+s:replace{1}
+s:select()
+s:drop()
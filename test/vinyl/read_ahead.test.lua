@@ -0,0 +1,58 @@
+test_run = require('test_run').new()
+
+--
+-- Range scans over a run of many pages: once a scan reads two
+-- pages one after another, the following ones are read ahead.
+--
+box.cfg.vinyl.read_ahead
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 256})
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false, page_size = 256})
+pad = string.rep('x', 64)
+for i = 1, 1000 do s:replace{i, i % 10, pad} end
+box.snapshot()
+box.info.vinyl().db[s.id..'/0'].page_count > 100
+
+test_run:cmd("setopt delimiter ';'")
+-- Check that the scan returns first, first + step, ..., last.
+function check(index, key, opts, first, last)
+    local step = first <= last and 1 or -1
+    local expected = first
+    for _, t in index:pairs(key, opts) do
+        if t[1] ~= expected then
+            return false
+        end
+        expected = expected + step
+    end
+    return expected == last + step
+end;
+function check_eq(k)
+    local count = 0
+    local prev = 0
+    for _, t in s.index.sk:pairs({k}) do
+        if t[2] ~= k or t[1] <= prev then
+            return false
+        end
+        prev = t[1]
+        count = count + 1
+    end
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+
+check(s.index.pk, {}, {iterator = 'GE'}, 1, 1000)
+check(s.index.pk, {100}, {iterator = 'GT'}, 101, 1000)
+check(s.index.pk, {}, {iterator = 'LE'}, 1000, 1)
+check(s.index.pk, {900}, {iterator = 'LT'}, 899, 1)
+check_eq(3)
+check_eq(9)
+
+-- The pages read ahead are given up if the scan stops early.
+count = 0
+for _, t in s:pairs() do count = count + 1 if t[1] == 500 then break end end
+count
+collectgarbage('collect')
+check(s.index.pk, {}, {iterator = 'GE'}, 1, 1000)
+
+s:drop()
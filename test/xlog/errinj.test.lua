@@ -41,3 +41,63 @@ errinj.set('ERRINJ_WAL_WRITE', false)
 test:drop()
 errinj = nil
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
+
+-- a partially written row of a failed tx doesn't get to the WAL
+test = box.schema.create_space('test')
+_ = test:create_index('primary')
+pad = string.rep('x', 8192)
+test_run:cmd("setopt delimiter ';'")
+function insert_tx(start)
+    box.begin()
+    for i = start, start + 9 do
+        test:insert{i, pad}
+    end
+    box.commit()
+end;
+test_run:cmd("setopt delimiter ''");
+box.error.injection.set("ERRINJ_WAL_WRITE_PARTIAL", true)
+insert_tx(1)
+box.error.injection.set("ERRINJ_WAL_WRITE_PARTIAL", false)
+test:count()
+insert_tx(11)
+test_run:cmd('restart server default')
+test = box.space.test
+pad = string.rep('x', 8192)
+test:count()
+test:min()[1]
+test:max()[1]
+bad = 0
+for _, t in test:pairs() do if t[2] ~= pad then bad = bad + 1 end end
+bad
+test:drop()
+
+-- an INSERT rolled back after an incremental snapshot has
+-- started is in the snapshot, the next one must delete it
+test_run:cmd('restart server default with cleanup=1')
+fiber = require('fiber')
+fio = require('fio')
+errinj = box.error.injection
+box.cfg{snapshot_delta_count = 2}
+s = box.schema.space.create('delta')
+_ = s:create_index('pk')
+s:insert{1}
+box.snapshot()
+s:insert{2}
+errinj.set('ERRINJ_WAL_DELAY', true)
+errinj.set('ERRINJ_WAL_WRITE', true)
+test_run:cmd("setopt delimiter ';'")
+_ = fiber.create(function()
+    ok = pcall(s.insert, s, {3})
+    errinj.set('ERRINJ_WAL_WRITE', false)
+end);
+test_run:cmd("setopt delimiter ''");
+box.snapshot()
+ok
+s:get{3}
+s:insert{4}
+box.snapshot()
+#fio.glob(fio.pathjoin(box.cfg.snap_dir, '*.delta'))
+test_run:cmd('restart server default')
+s = box.space.delta
+s:select()
+s:drop()
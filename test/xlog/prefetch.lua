@@ -0,0 +1,9 @@
+#!/usr/bin/env tarantool
+
+box.cfg {
+    listen              = os.getenv("LISTEN"),
+    slab_alloc_arena    = 0.1,
+    slab_alloc_maximal  = 4 * 1024 * 1024
+}
+
+require('console').listen(os.getenv('ADMIN'))
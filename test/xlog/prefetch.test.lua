@@ -0,0 +1,51 @@
+--
+-- Local recovery reads and decompresses WAL txs ahead in
+-- chunks of 1 MB. Check txs crossing a chunk boundary, a tx
+-- larger than a chunk and a WAL with a truncated tail.
+--
+env = require('test_run')
+test_run = env.new()
+fio = require('fio')
+test_run:cmd("create server prefetch with script='xlog/prefetch.lua'")
+test_run:cmd("start server prefetch")
+test_run:cmd("switch prefetch")
+digest = require('digest')
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+pad = string.rep('x', 1000)
+-- 3 MB of small txs, some of them cross chunk boundaries
+for i = 1, 3000 do s:replace{i, pad} end
+-- a big box tx, written as several compressed WAL txs
+box.begin() for i = 3001, 3200 do s:replace{i, pad} end box.commit()
+-- a single row doesn't fit in a chunk
+big = digest.urandom(2 * 1024 * 1024)
+_ = s:replace{0, digest.md5_hex(big)}
+_ = s:replace{3201, big}
+_ = s:replace{3202, pad}
+test_run:cmd("restart server prefetch")
+digest = require('digest')
+s = box.space.test
+pad = string.rep('x', 1000)
+s:count()
+digest.md5_hex(s:get{3201}[2]) == s:get{0}[2]
+bad = 0
+for i = 1, 3200 do if s:get{i}[2] ~= pad then bad = bad + 1 end end
+bad
+s:get{3202}[2] == pad
+test_run:cmd("switch default")
+wal = test_run:eval('prefetch', "local files = require('fio').glob(require('fio').abspath(box.cfg.wal_dir) .. '/*.xlog') return files[#files]")[1]
+test_run:cmd("stop server prefetch")
+-- cut the last tx in the middle
+f = fio.open(wal, {'O_WRONLY'})
+f:truncate(fio.stat(wal).size - 100)
+f:close()
+test_run:cmd("start server prefetch")
+test_run:cmd("switch prefetch")
+digest = require('digest')
+s = box.space.test
+s:count()
+s:get{3202}
+digest.md5_hex(s:get{3201}[2]) == s:get{0}[2]
+test_run:cmd("switch default")
+test_run:cmd("stop server prefetch")
+test_run:cmd("cleanup server prefetch")
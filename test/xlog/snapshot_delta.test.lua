@@ -0,0 +1,48 @@
+env = require('test_run')
+test_run = env.new()
+fio = require('fio')
+test_run:cmd("setopt delimiter ';'")
+function last_file(ext)
+    local files = fio.glob(fio.pathjoin(box.cfg.snap_dir, '*.' .. ext))
+    return fio.basename(files[#files] or '', '.' .. ext)
+end;
+test_run:cmd("setopt delimiter ''");
+
+box.cfg{snapshot_delta_count = 2}
+s = box.schema.space.create('delta')
+_ = s:create_index('pk')
+for i = 1, 10 do s:insert{i} end
+-- DDL makes the next snapshot a full one
+box.snapshot()
+snap = last_file('snap')
+s:delete{1}
+s:replace{2, 'two'}
+s:insert{11}
+box.begin() s:delete{3} box.rollback()
+box.snapshot()
+last_file('snap') == snap
+last_file('delta') > snap
+-- no changes, no new snapshot
+delta = last_file('delta')
+box.snapshot()
+last_file('delta') == delta
+s:update({4}, {{'=', 2, 'four'}})
+box.snapshot()
+last_file('delta') > delta
+delta = last_file('delta')
+s:delete{5}
+-- the third snapshot in a row is a full one
+box.snapshot()
+last_file('snap') > delta
+snap = last_file('snap')
+s:delete{6}
+box.snapshot()
+last_file('delta') > snap
+s:delete{7}
+--
+-- recover from the full snapshot, the incremental one and WAL
+--
+test_run:cmd("restart server default")
+s = box.space.delta
+s:select()
+s:drop()
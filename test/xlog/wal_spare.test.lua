@@ -0,0 +1,42 @@
+--
+-- Once the current WAL is half full, the next one is created
+-- in advance with the disk space preallocated for it. Check
+-- that rotation picks it up and that the unused space is given
+-- back when it is closed.
+--
+env = require('test_run')
+test_run = env.new()
+test_run:cmd("create server wal_spare with script='xlog/panic.lua'")
+test_run:cmd("start server wal_spare")
+test_run:cmd("switch wal_spare")
+fio = require('fio')
+fiber = require('fiber')
+name = string.match(arg[0], "([^,]+)%.lua")
+spare = name .. "/spare.xlog.inprogress"
+function xlog_count() return #fio.glob(name .. "/*.xlog") end
+box.cfg.rows_per_wal
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+big = string.rep('x', 20000)
+-- big rows make the spare big
+i = 0
+while fio.stat(spare) == nil do i = i + 1 s:replace{i, big} fiber.sleep(0.05) end
+-- let the WAL thread take the spare
+fiber.sleep(0.1)
+xlog_count()
+-- rotation renames the spare into the next WAL
+while xlog_count() == 1 do i = i + 1 s:replace{i} end
+fio.stat(spare) == nil
+xlogs = fio.glob(name .. "/*.xlog")
+-- fill the next WAL with small rows and rotate it
+while xlog_count() == 2 do i = i + 1 s:replace{i} end
+-- the space preallocated for big rows has been trimmed
+stat = fio.stat(xlogs[2])
+stat ~= nil
+stat.size > 0 and stat.size < 4096
+test_run:cmd("restart server wal_spare")
+box.space.test:count() == box.space.test.index.pk:max()[1]
+box.space.test:count() > 10
+test_run:cmd('switch default')
+test_run:cmd("stop server wal_spare")
+test_run:cmd("cleanup server wal_spare")